@@ -25,7 +25,7 @@ struct submit_task_thread : public thread
     }
 
     void run() override { submit_task(&pool, a); }
-    submit_task_thread(thread_pool &pool, atomic<LONG> &a) : pool(pool), a(a) {}
+    submit_task_thread(thread_pool &pool, atomic<LONG> &a) : thread(TRUE), pool(pool), a(a) {}
     thread_pool &pool;
     atomic<LONG> &a;
 };
@@ -42,6 +42,7 @@ int main()
     for (int i = 0; i < 3; ++i)
     {
         listThreads.push_back(thread_ptr(new submit_task_thread(pool,count)));
+        listThreads.back()->start();
     }
     for (threads::iterator it = listThreads.begin(); it != listThreads.end(); ++it)
     {
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/thread/numa_thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const size_t CHUNK_DOUBLES = 512 * 1024; // 每块4MB，超过L2缓存
+const size_t CHUNKS_PER_NODE = 8;
+const int ROUNDS = 10;
+
+numa_topology g_topology;
+atomic<LONG> g_nRemote = 0;  // 在数据所在节点之外执行的任务数
+volatile double g_dSink = 0; // 保存累加结果，避免循环被优化掉
+
+struct chunk
+{
+    std::vector<double> data;
+    size_t home; // 首次写入数据的线程所在节点
+};
+
+// 由执行线程首次写入，数据分配在该线程所在节点的内存上
+int init_chunk(chunk *c)
+{
+    c->home = g_topology.current_node();
+    c->data.assign(CHUNK_DOUBLES, 1.0);
+    return 0;
+}
+
+// 访存密集的任务：顺序累加整块数据
+double sum_chunk(chunk *c)
+{
+    if (g_topology.current_node() != c->home)
+    {
+        ++g_nRemote;
+    }
+
+    double sum = 0;
+    for (size_t i = 0; i < c->data.size(); ++i)
+    {
+        sum += c->data[i];
+    }
+    return sum;
+}
+
+// 在执行线程上顺序累加一组数据ROUNDS遍，返回读取带宽，单位GB/s
+double scan_chunks(std::vector<chunk> *v_pChunks)
+{
+    calc_walltime ct;
+    double sum = 0;
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        for (size_t c = 0; c < v_pChunks->size(); ++c)
+        {
+            const std::vector<double> &data = (*v_pChunks)[c].data;
+            for (size_t i = 0; i < data.size(); ++i)
+            {
+                sum += data[i];
+            }
+        }
+    }
+    ct.end();
+    g_dSink = sum;
+
+    double bytes = static_cast<double>(ROUNDS) * v_pChunks->size() * CHUNK_DOUBLES * sizeof(double);
+    return bytes / ct.run_time_in_second() / 1e9;
+}
+
+int main()
+{
+    size_t nodes = g_topology.node_count();
+    std::cout << nodes << " NUMA node(s)";
+    for (size_t i = 0; i < nodes; ++i)
+    {
+        std::cout << ", node " << i << ": " << g_topology.node_cpus(i).count() << " cpus";
+    }
+    std::cout << std::endl;
+
+    size_t tasks = nodes * CHUNKS_PER_NODE * ROUNDS;
+    std::cout << nodes * CHUNKS_PER_NODE << " chunks x 4MB, " << ROUNDS << " rounds" << std::endl;
+
+    // 对照组：主线程初始化全部数据，任务由未绑核的线程池执行
+    {
+        std::vector<chunk> chunks(nodes * CHUNKS_PER_NODE);
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            init_chunk(&chunks[i]);
+        }
+
+        thread_pool pool(thread::hardware_concurrency(), 0);
+        g_nRemote = 0;
+        calc_walltime ct;
+        for (int r = 0; r < ROUNDS; ++r)
+        {
+            std::vector<future<double> > results;
+            for (size_t i = 0; i < chunks.size(); ++i)
+            {
+                results.push_back(pool.async(sum_chunk, &chunks[i]));
+            }
+            wait_all(results.begin(), results.end());
+        }
+        ct.end();
+        std::cout << "  unpinned pool:    " << ct.run_time_in_second() << " s, remote tasks " << g_nRemote << "/"
+                  << tasks << std::endl;
+    }
+
+    // 每块数据由所在节点的分组初始化，之后也提交到该分组
+    {
+        numa_thread_pool pool;
+        std::vector<chunk> chunks(nodes * CHUNKS_PER_NODE);
+        std::vector<future<int> > inits;
+        for (size_t i = 0; i < chunks.size(); ++i)
+        {
+            inits.push_back(pool.group(i % nodes).async(init_chunk, &chunks[i]));
+        }
+        wait_all(inits.begin(), inits.end());
+
+        g_nRemote = 0;
+        calc_walltime ct;
+        for (int r = 0; r < ROUNDS; ++r)
+        {
+            std::vector<future<double> > results;
+            for (size_t i = 0; i < chunks.size(); ++i)
+            {
+                results.push_back(pool.group(chunks[i].home).async(sum_chunk, &chunks[i]));
+            }
+            wait_all(results.begin(), results.end());
+        }
+        ct.end();
+        std::cout << "  numa_thread_pool: " << ct.run_time_in_second() << " s, remote tasks " << g_nRemote << "/"
+                  << tasks << std::endl;
+    }
+
+    // 上面只统计了任务是否在数据所在节点执行，这里直接测量访存：每个节点的数据由该节点的分组首次写入，
+    // 再由各节点的一个线程依次读取，同一行中本地列与远端列的差异即跨节点访问的代价
+    {
+        numa_thread_pool pool;
+        std::vector<std::vector<chunk> > homes(nodes, std::vector<chunk>(CHUNKS_PER_NODE));
+        std::vector<future<int> > inits;
+        for (size_t h = 0; h < nodes; ++h)
+        {
+            for (size_t i = 0; i < CHUNKS_PER_NODE; ++i)
+            {
+                inits.push_back(pool.group(h).async(init_chunk, &homes[h][i]));
+            }
+        }
+        wait_all(inits.begin(), inits.end());
+
+        std::cout << "  read bandwidth per thread, GB/s (row: running node, column: first-touch node)" << std::endl;
+        for (size_t e = 0; e < nodes; ++e)
+        {
+            std::cout << "    node " << e << ":";
+            for (size_t h = 0; h < nodes; ++h)
+            {
+                double dBandwidth = pool.group(e).async(scan_chunks, &homes[h]).get();
+                std::cout << " " << dBandwidth << (e == h ? " (local)" : " (remote)");
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
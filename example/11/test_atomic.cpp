@@ -0,0 +1,162 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/atomic.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG ITERATIONS = 20000000;
+const int THREADS = 4;
+
+const char *order_name(memory_order order)
+{
+    switch (order)
+    {
+    case memory_order_relaxed:
+        return "relaxed";
+    case memory_order_acquire:
+        return "acquire";
+    case memory_order_release:
+        return "release";
+    case memory_order_acq_rel:
+        return "acq_rel";
+    default:
+        return "seq_cst";
+    }
+}
+
+void print(const char *op, memory_order order, double seconds, LONG ops)
+{
+    std::cout << "  " << op << " " << order_name(order) << ": " << seconds * 1e9 / ops << " ns/op" << std::endl;
+}
+
+atomic<LONG> g_value = 0;
+volatile LONG g_sink = 0; // 保存读到的值，避免循环被优化掉
+
+// 单线程，每种操作分别使用各个合法的内存序，内存序参数是编译期常量
+template <int ORDER>
+void bench_single()
+{
+    memory_order order = static_cast<memory_order>(ORDER);
+    LONG sum = 0;
+    calc_walltime ct;
+
+    if (order != memory_order_release && order != memory_order_acq_rel)
+    {
+        ct.start();
+        for (LONG i = 0; i < ITERATIONS; ++i)
+        {
+            sum += g_value.load(static_cast<memory_order>(ORDER));
+        }
+        ct.end();
+        print("load     ", order, ct.run_time_in_second(), ITERATIONS);
+    }
+
+    if (order != memory_order_acquire && order != memory_order_acq_rel)
+    {
+        ct.start();
+        for (LONG i = 0; i < ITERATIONS; ++i)
+        {
+            g_value.store(i, static_cast<memory_order>(ORDER));
+        }
+        ct.end();
+        print("store    ", order, ct.run_time_in_second(), ITERATIONS);
+    }
+
+    ct.start();
+    for (LONG i = 0; i < ITERATIONS; ++i)
+    {
+        sum += g_value.exchange(i, static_cast<memory_order>(ORDER));
+    }
+    ct.end();
+    print("exchange ", order, ct.run_time_in_second(), ITERATIONS);
+
+    ct.start();
+    for (LONG i = 0; i < ITERATIONS; ++i)
+    {
+        g_value.fetch_add(1, static_cast<memory_order>(ORDER));
+    }
+    ct.end();
+    print("fetch_add", order, ct.run_time_in_second(), ITERATIONS);
+
+    ct.start();
+    for (LONG i = 0; i < ITERATIONS; ++i)
+    {
+        LONG expected = g_value.load(memory_order_relaxed);
+        g_value.compare_exchange_strong(expected, expected + 1, static_cast<memory_order>(ORDER));
+    }
+    ct.end();
+    print("cas      ", order, ct.run_time_in_second(), ITERATIONS);
+
+    g_sink = sum;
+}
+
+// 多线程争用同一个计数器
+template <int ORDER>
+struct add_thread : public thread
+{
+    add_thread() : thread(TRUE) {}
+    void run()
+    {
+        for (LONG i = 0; i < ITERATIONS / THREADS; ++i)
+        {
+            g_value.fetch_add(1, static_cast<memory_order>(ORDER));
+        }
+    }
+};
+
+template <int ORDER>
+void bench_contended()
+{
+    typedef shared_ptr<thread> thread_ptr;
+    std::list<thread_ptr> threads;
+
+    g_value = 0;
+    calc_walltime ct;
+    for (int i = 0; i < THREADS; ++i)
+    {
+        threads.push_back(thread_ptr(new add_thread<ORDER>()));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    if (g_value != ITERATIONS / THREADS * THREADS)
+    {
+        std::cout << "count error: " << g_value << std::endl;
+    }
+    print("fetch_add", static_cast<memory_order>(ORDER), ct.run_time_in_second(), ITERATIONS);
+}
+
+int main()
+{
+    std::cout << "single thread, " << ITERATIONS << " ops" << std::endl;
+    bench_single<memory_order_relaxed>();
+    bench_single<memory_order_acquire>();
+    bench_single<memory_order_release>();
+    bench_single<memory_order_acq_rel>();
+    bench_single<memory_order_seq_cst>();
+
+    std::cout << THREADS << " threads, one shared counter" << std::endl;
+    bench_contended<memory_order_relaxed>();
+    bench_contended<memory_order_acq_rel>();
+    bench_contended<memory_order_seq_cst>();
+
+    atomic_flag flag;
+    calc_walltime ct;
+    for (LONG i = 0; i < ITERATIONS; ++i)
+    {
+        while (flag.test_and_set(memory_order_acquire))
+        {
+        }
+        flag.clear(memory_order_release);
+    }
+    ct.end();
+    std::cout << "atomic_flag lock/unlock: " << ct.run_time_in_second() * 1e9 / ITERATIONS << " ns/op" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
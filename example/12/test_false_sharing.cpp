@@ -0,0 +1,131 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/cache_padded.hpp"
+#include "../../src/utils/thread/sharded_counter.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG ITERATIONS = 10000000; // 每个线程的累加次数
+const int MAX_THREADS = 8;
+
+atomic<LONG> g_shared;                      // 所有线程共用一个计数器
+atomic<LONG> g_adjacent[MAX_THREADS];       // 每个线程一个计数器，相邻存放，存在伪共享
+aligned_atomic<LONG> g_padded[MAX_THREADS]; // 每个线程一个计数器，各自独占缓存行
+sharded_counter<LONG> g_sharded;            // 分片计数器
+
+struct add_thread : public thread
+{
+    add_thread(int v_nMode, int v_nIndex) : thread(TRUE), m_nMode(v_nMode), m_nIndex(v_nIndex) {}
+    void run()
+    {
+        switch (m_nMode)
+        {
+        case 0:
+            for (LONG i = 0; i < ITERATIONS; ++i)
+            {
+                g_shared.fetch_add(1, memory_order_relaxed);
+            }
+            break;
+        case 1:
+            for (LONG i = 0; i < ITERATIONS; ++i)
+            {
+                g_adjacent[m_nIndex].fetch_add(1, memory_order_relaxed);
+            }
+            break;
+        case 2:
+            for (LONG i = 0; i < ITERATIONS; ++i)
+            {
+                g_padded[m_nIndex].fetch_add(1, memory_order_relaxed);
+            }
+            break;
+        default:
+            for (LONG i = 0; i < ITERATIONS; ++i)
+            {
+                ++g_sharded;
+            }
+            break;
+        }
+    }
+
+    int m_nMode;
+    int m_nIndex;
+};
+
+LONG total(int v_nMode)
+{
+    LONG sum = 0;
+    switch (v_nMode)
+    {
+    case 0:
+        return g_shared;
+    case 1:
+        for (int i = 0; i < MAX_THREADS; ++i)
+        {
+            sum += g_adjacent[i];
+        }
+        return sum;
+    case 2:
+        for (int i = 0; i < MAX_THREADS; ++i)
+        {
+            sum += g_padded[i];
+        }
+        return sum;
+    default:
+        return g_sharded.load();
+    }
+}
+
+void reset()
+{
+    g_shared = 0;
+    for (int i = 0; i < MAX_THREADS; ++i)
+    {
+        g_adjacent[i] = 0;
+        g_padded[i] = 0;
+    }
+    g_sharded.reset();
+}
+
+void bench(int v_nMode, int v_nThreads)
+{
+    static const char *s_names[] = {"shared atomic   ", "adjacent atomics", "aligned_atomic  ", "sharded_counter "};
+    typedef shared_ptr<thread> thread_ptr;
+    std::list<thread_ptr> threads;
+
+    reset();
+    calc_walltime ct;
+    for (int i = 0; i < v_nThreads; ++i)
+    {
+        threads.push_back(thread_ptr(new add_thread(v_nMode, i)));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    if (total(v_nMode) != ITERATIONS * v_nThreads)
+    {
+        std::cout << "count error: " << total(v_nMode) << std::endl;
+    }
+    std::cout << "  " << s_names[v_nMode] << ": " << ITERATIONS * v_nThreads / ct.run_time_in_second() / 1e6
+              << " Mops/s" << std::endl;
+}
+
+int main()
+{
+    std::cout << "sharded_counter shards: " << g_sharded.shards() << std::endl;
+    for (int nThreads = 1; nThreads <= MAX_THREADS; nThreads *= 2)
+    {
+        std::cout << nThreads << " threads" << std::endl;
+        for (int nMode = 0; nMode < 4; ++nMode)
+        {
+            bench(nMode, nThreads);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
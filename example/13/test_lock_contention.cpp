@@ -0,0 +1,90 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/mutex.hpp"
+#include "../../src/utils/thread/adaptive_mutex.hpp"
+#include "../../src/utils/thread/spinlock.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG ITERATIONS = 1000000; // 所有线程合计的加锁次数
+const int MAX_THREADS = 8;
+
+volatile LONG g_nShared = 0; // 临界区内修改的共享数据
+
+// 临界区内的工作量，每单位为一次共享数据的读写
+inline void work(int v_nLength)
+{
+    for (int i = 0; i < v_nLength; ++i)
+    {
+        g_nShared = g_nShared + 1;
+    }
+}
+
+template <typename T>
+struct lock_thread : public thread
+{
+    lock_thread(T &v_lock, LONG v_nCount, int v_nLength)
+        : thread(TRUE), m_lock(v_lock), m_nCount(v_nCount), m_nLength(v_nLength)
+    {
+    }
+    void run()
+    {
+        for (LONG i = 0; i < m_nCount; ++i)
+        {
+            unique_lock<T> lock(m_lock);
+            work(m_nLength);
+        }
+    }
+
+    T &m_lock;
+    LONG m_nCount;
+    int m_nLength;
+};
+
+template <typename T>
+void bench(const char *v_pszName, int v_nThreads, int v_nLength)
+{
+    typedef shared_ptr<thread> thread_ptr;
+    std::list<thread_ptr> threads;
+    T lock;
+
+    g_nShared = 0;
+    calc_walltime ct;
+    for (int i = 0; i < v_nThreads; ++i)
+    {
+        threads.push_back(thread_ptr(new lock_thread<T>(lock, ITERATIONS / v_nThreads, v_nLength)));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    if (g_nShared != ITERATIONS / v_nThreads * v_nThreads * v_nLength)
+    {
+        std::cout << "count error: " << g_nShared << std::endl;
+    }
+    std::cout << "  " << v_pszName << ": " << ct.run_time_in_second() * 1e9 / (ITERATIONS / v_nThreads * v_nThreads)
+              << " ns/lock" << std::endl;
+}
+
+int main()
+{
+    const int lengths[] = {1, 20, 200};
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+    {
+        for (int nThreads = 1; nThreads <= MAX_THREADS; nThreads *= 2)
+        {
+            std::cout << nThreads << " threads, critical section " << lengths[i] << std::endl;
+            bench<mutex>("mutex         ", nThreads, lengths[i]);
+            bench<adaptive_mutex>("adaptive_mutex", nThreads, lengths[i]);
+            bench<spinlock>("spinlock      ", nThreads, lengths[i]);
+            bench<ticket_lock>("ticket_lock   ", nThreads, lengths[i]);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/shared_mutex.hpp"
+#include "../../src/utils/thread/scalable_shared_mutex.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG ITERATIONS = 640000; // 所有线程合计的加锁次数
+const int MAX_THREADS = 64;
+const int DATA_SIZE = 8;
+
+volatile LONG g_data[DATA_SIZE]; // 受保护的数据，写者整体加1，读者检查各项是否相等
+atomic<LONG> g_nErrors;
+
+template <typename T>
+struct rw_thread : public thread
+{
+    rw_thread(T &v_lock, LONG v_nCount, int v_nWritePerMille)
+        : thread(TRUE), m_lock(v_lock), m_nCount(v_nCount), m_nWritePerMille(v_nWritePerMille)
+    {
+    }
+    void run()
+    {
+        for (LONG i = 0; i < m_nCount; ++i)
+        {
+            if (i % 1000 < m_nWritePerMille)
+            {
+                unique_lock<T> lock(m_lock);
+                for (int j = 0; j < DATA_SIZE; ++j)
+                {
+                    g_data[j] = g_data[j] + 1;
+                }
+            }
+            else
+            {
+                shared_lock<T> lock(m_lock);
+                for (int j = 1; j < DATA_SIZE; ++j)
+                {
+                    if (g_data[j] != g_data[0])
+                    {
+                        ++g_nErrors;
+                    }
+                }
+            }
+        }
+    }
+
+    T &m_lock;
+    LONG m_nCount;
+    int m_nWritePerMille;
+};
+
+template <typename T>
+void bench(const char *v_pszName, int v_nThreads, int v_nWritePerMille)
+{
+    typedef shared_ptr<thread> thread_ptr;
+    std::list<thread_ptr> threads;
+    T lock;
+
+    g_nErrors = 0;
+    calc_walltime ct;
+    for (int i = 0; i < v_nThreads; ++i)
+    {
+        threads.push_back(thread_ptr(new rw_thread<T>(lock, ITERATIONS / v_nThreads, v_nWritePerMille)));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    if (g_nErrors != 0)
+    {
+        std::cout << "inconsistent reads: " << g_nErrors << std::endl;
+    }
+    std::cout << "  " << v_pszName << ": " << ITERATIONS / ct.run_time_in_second() / 1e6 << " Mops/s" << std::endl;
+}
+
+int main()
+{
+    const int writes[] = {1, 10, 100}; // 千分之一、百分之一、百分之十的写
+    for (size_t i = 0; i < sizeof(writes) / sizeof(writes[0]); ++i)
+    {
+        for (int nThreads = 1; nThreads <= MAX_THREADS; nThreads *= 2)
+        {
+            std::cout << nThreads << " threads, " << writes[i] / 10.0 << "% writes" << std::endl;
+            bench<shared_mutex>("shared_mutex         ", nThreads, writes[i]);
+            bench<scalable_shared_mutex>("scalable_shared_mutex", nThreads, writes[i]);
+        }
+    }
+
+    return 0;
+}
\ No newline at end of file
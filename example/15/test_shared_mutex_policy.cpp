@@ -0,0 +1,125 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/shared_mutex.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+typedef shared_ptr<thread> thread_ptr;
+
+const int READERS = 4;
+const int WRITES = 20;
+
+// 读者持续持有共享锁，前后两个读者的持有时间相互重叠
+struct reader_thread : public thread
+{
+    reader_thread(shared_mutex &v_sm, atomic<LONG> &v_nStop, atomic<LONG> &v_nReads)
+        : thread(TRUE), m_sm(v_sm), m_nStop(v_nStop), m_nReads(v_nReads)
+    {
+    }
+    void run()
+    {
+        while (m_nStop == 0)
+        {
+            shared_lock<shared_mutex> lock(m_sm);
+            this_thread::sleep_for(2);
+            ++m_nReads;
+        }
+    }
+
+    shared_mutex &m_sm;
+    atomic<LONG> &m_nStop;
+    atomic<LONG> &m_nReads;
+};
+
+// 读者不断时写者的等待时间
+void bench_policy(const char *v_pszName, shared_mutex::policy v_policy)
+{
+    shared_mutex sm(v_policy);
+    atomic<LONG> nStop(0);
+    atomic<LONG> nReads(0);
+    std::list<thread_ptr> threads;
+    for (int i = 0; i < READERS; ++i)
+    {
+        threads.push_back(thread_ptr(new reader_thread(sm, nStop, nReads)));
+        threads.back()->start();
+    }
+    this_thread::sleep_for(10);
+
+    int nTimeouts = 0;
+    calc_walltime ct;
+    for (int i = 0; i < WRITES; ++i)
+    {
+        if (sm.try_lock_for(200))
+        {
+            sm.unlock();
+        }
+        else
+        {
+            ++nTimeouts;
+        }
+        this_thread::sleep_for(1);
+    }
+    ct.end();
+
+    nStop = 1;
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    std::cout << v_pszName << ": " << WRITES << " writes in " << ct.run_time_in_second() << " s, " << nTimeouts
+              << " timeouts, " << nReads << " reads" << std::endl;
+}
+
+// 配置刷新：读到版本过期时升级为独占锁更新，升级期间其他读者可以继续读，不需要重新校验
+shared_mutex g_config;
+volatile LONG g_nVersion = 0;
+volatile LONG g_nRefreshes = 0;
+
+struct refresh_thread : public thread
+{
+    refresh_thread() : thread(TRUE) {}
+    void run()
+    {
+        for (LONG nWanted = 1; nWanted <= 1000; ++nWanted)
+        {
+            upgrade_lock<shared_mutex> lock(g_config);
+            if (g_nVersion < nWanted)
+            {
+                lock.upgrade();
+                g_nVersion = nWanted;
+                g_nRefreshes = g_nRefreshes + 1;
+            }
+        }
+    }
+};
+
+int main()
+{
+    bench_policy("reader_preferring", shared_mutex::reader_preferring);
+    bench_policy("writer_preferring", shared_mutex::writer_preferring);
+    bench_policy("phase_fair       ", shared_mutex::phase_fair);
+
+    std::list<thread_ptr> threads;
+    for (int i = 0; i < 4; ++i)
+    {
+        threads.push_back(thread_ptr(new refresh_thread()));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    std::cout << "upgrade: version " << g_nVersion << ", refreshes " << g_nRefreshes << std::endl;
+
+    g_config.lock();
+    calc_walltime ct;
+    BOOL bShared = g_config.try_lock_shared_for(50);
+    ct.end();
+    std::cout << "try_lock_shared_for(50) while locked: " << bShared << " after " << ct.run_time_in_second() << " s"
+              << std::endl;
+    g_config.unlock();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/seqlock.hpp"
+#include "../../src/utils/thread/shared_mutex.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+typedef shared_ptr<thread> thread_ptr;
+
+const LONG READS = 4000000; // 所有读者合计的读取次数
+const int MAX_READERS = 128;
+
+// 被频繁读取的小结构，写者把各字段设为相同的值，读者检查是否一致
+struct route_entry
+{
+    LONG m_nVersion;
+    LONG m_nNextHop;
+    LONG m_nMetric;
+    LONG m_nTimestamp;
+};
+
+atomic<LONG> g_nStop;
+atomic<LONG> g_nErrors;
+
+inline BOOL consistent(const route_entry &v_entry)
+{
+    return v_entry.m_nNextHop == v_entry.m_nVersion && v_entry.m_nMetric == v_entry.m_nVersion &&
+           v_entry.m_nTimestamp == v_entry.m_nVersion;
+}
+
+// 用shared_mutex保护的版本
+struct locked_entry
+{
+    route_entry load()
+    {
+        shared_lock<shared_mutex> lock(m_sm);
+        return m_entry;
+    }
+    void store(const route_entry &v_entry)
+    {
+        unique_lock<shared_mutex> lock(m_sm);
+        m_entry = v_entry;
+    }
+
+    shared_mutex m_sm;
+    route_entry m_entry;
+};
+
+template <typename T>
+struct reader_thread : public thread
+{
+    reader_thread(T &v_entry, LONG v_nCount) : thread(TRUE), m_entry(v_entry), m_nCount(v_nCount) {}
+    void run()
+    {
+        for (LONG i = 0; i < m_nCount; ++i)
+        {
+            if (!consistent(m_entry.load()))
+            {
+                ++g_nErrors;
+            }
+        }
+    }
+
+    T &m_entry;
+    LONG m_nCount;
+};
+
+// 写者每毫秒更新一次
+template <typename T>
+struct writer_thread : public thread
+{
+    writer_thread(T &v_entry) : thread(TRUE), m_entry(v_entry) {}
+    void run()
+    {
+        for (LONG nVersion = 1; g_nStop == 0; ++nVersion)
+        {
+            route_entry entry = {nVersion, nVersion, nVersion, nVersion};
+            m_entry.store(entry);
+            this_thread::sleep_for(1);
+        }
+    }
+
+    T &m_entry;
+};
+
+template <typename T>
+void bench(const char *v_pszName, int v_nReaders)
+{
+    T entry;
+    std::list<thread_ptr> threads;
+
+    g_nStop = 0;
+    g_nErrors = 0;
+    thread_ptr writer(new writer_thread<T>(entry));
+    writer->start();
+
+    calc_walltime ct;
+    for (int i = 0; i < v_nReaders; ++i)
+    {
+        threads.push_back(thread_ptr(new reader_thread<T>(entry, READS / v_nReaders)));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+    g_nStop = 1;
+    writer->join();
+
+    if (g_nErrors != 0)
+    {
+        std::cout << "inconsistent reads: " << g_nErrors << std::endl;
+    }
+    std::cout << "  " << v_pszName << ": " << READS / ct.run_time_in_second() / 1e6 << " Mreads/s" << std::endl;
+}
+
+int main()
+{
+    for (int nReaders = 1; nReaders <= MAX_READERS; nReaders *= 2)
+    {
+        std::cout << nReaders << " readers, 1 writer" << std::endl;
+        bench<locked_entry>("shared_mutex        ", nReaders);
+        bench<seqlock<route_entry> >("seqlock<route_entry>", nReaders);
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/ebr.hpp"
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const int VALUES = 16;
+const int READ_TASKS = 400;     // 读任务数，由线程池的工作线程执行，工作线程自动登记EBR
+const LONG READS_PER_TASK = 20000;
+const int WRITERS = 2;
+const LONG UPDATES = 200000;    // 每个写线程的更新次数
+
+atomic<LONG> g_nLive;   // 存活的快照数
+atomic<LONG> g_nPeak;   // 存活快照数的峰值
+atomic<LONG> g_nErrors; // 读到不一致或已释放快照的次数
+
+// 配置快照，写者整体替换，读者检查各项是否一致
+struct snapshot
+{
+    snapshot(LONG v_nVersion) : m_nVersion(v_nVersion)
+    {
+        for (int i = 0; i < VALUES; ++i)
+        {
+            m_values[i] = v_nVersion;
+        }
+
+        LONG nLive = ++g_nLive;
+        LONG nPeak = g_nPeak;
+        while (nLive > nPeak && !g_nPeak.compare_exchange_weak(nPeak, nLive))
+        {
+        }
+    }
+    ~snapshot()
+    {
+        m_nVersion = -1; // 释放后仍被读到时能发现
+        --g_nLive;
+    }
+
+    volatile LONG m_nVersion;
+    volatile LONG m_values[VALUES];
+};
+
+atomic<snapshot *> g_pCurrent(NULL);
+
+void read_task(void *)
+{
+    for (LONG i = 0; i < READS_PER_TASK; ++i)
+    {
+        ebr_guard guard;
+        snapshot *p = g_pCurrent.load(memory_order_acquire);
+        LONG nVersion = p->m_nVersion;
+        for (int j = 0; j < VALUES; ++j)
+        {
+            if (p->m_values[j] != nVersion || nVersion < 0)
+            {
+                ++g_nErrors;
+                break;
+            }
+        }
+    }
+}
+
+struct writer_thread : public thread
+{
+    writer_thread() : thread(TRUE) {}
+    void run()
+    {
+        for (LONG i = 0; i < UPDATES; ++i)
+        {
+            snapshot *pOld = g_pCurrent.exchange(new snapshot(i));
+            ebr::retire(pOld);
+        }
+    }
+};
+
+int main()
+{
+    g_pCurrent = new snapshot(0);
+
+    thread_pool pool(4, 0);
+    typedef shared_ptr<thread> thread_ptr;
+    std::list<thread_ptr> writers;
+
+    calc_walltime ct;
+    for (int i = 0; i < WRITERS; ++i)
+    {
+        writers.push_back(thread_ptr(new writer_thread()));
+        writers.back()->start();
+    }
+    for (int i = 0; i < READ_TASKS; ++i)
+    {
+        pool.submit(task_func(read_task, NULL));
+    }
+    for (std::list<thread_ptr>::iterator it = writers.begin(); it != writers.end(); ++it)
+    {
+        (*it)->join();
+    }
+    pool.wait();
+    ct.end();
+    pool.stop(); // 工作线程退出时注销，未释放的节点转入孤儿链表
+
+    std::cout << "reads: " << READ_TASKS * READS_PER_TASK / ct.run_time_in_second() / 1e6 << " M/s, updates: "
+              << WRITERS * UPDATES / ct.run_time_in_second() / 1e6 << " M/s, errors: " << g_nErrors << std::endl;
+    std::cout << "peak live snapshots: " << g_nPeak << ", live after threads exit: " << g_nLive << std::endl;
+
+    // 线程退出时未释放的节点在孤儿链表中，由仍在运行的线程回收
+    for (int i = 0; i < 3; ++i)
+    {
+        ebr::collect();
+    }
+    delete g_pCurrent.exchange(NULL);
+    std::cout << "live after collect: " << g_nLive << std::endl;
+
+    return 0;
+}
\ No newline at end of file
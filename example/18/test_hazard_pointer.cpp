@@ -0,0 +1,207 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/lock_free_stack.hpp"
+#include "../../src/utils/thread/lock_free_queue.hpp"
+#include "../../src/utils/thread/ebr.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+typedef shared_ptr<thread> thread_ptr;
+
+const int THREADS = 4;
+const LONG OPS = 200000;      // 每个线程的入栈/入队次数
+const int WRITERS = 2;
+const LONG UPDATES = 100000;  // 每个写线程替换共享对象的次数
+const DWORD HOLD_MS = 20;     // 长时间读者每次持有对象的时间
+
+void run_threads(std::list<thread_ptr> &v_threads)
+{
+    for (std::list<thread_ptr>::iterator it = v_threads.begin(); it != v_threads.end(); ++it)
+    {
+        (*it)->start();
+    }
+    for (std::list<thread_ptr>::iterator it = v_threads.begin(); it != v_threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+}
+
+// 每个线程交替压入、弹出，检查弹出元素之和
+template <typename C>
+struct container_thread : public thread
+{
+    container_thread(C &v_container, LONG v_nBase, atomic<LONG> &v_nSum)
+        : thread(TRUE), m_container(v_container), m_nBase(v_nBase), m_nSum(v_nSum)
+    {
+    }
+    void run()
+    {
+        LONG nSum = 0;
+        for (LONG i = 0; i < OPS; ++i)
+        {
+            m_container.push(m_nBase + i);
+            LONG nValue = 0;
+            if (m_container.pop(nValue))
+            {
+                nSum += nValue;
+            }
+        }
+        m_nSum += nSum;
+    }
+
+    C &m_container;
+    LONG m_nBase;
+    atomic<LONG> &m_nSum;
+};
+
+template <typename C>
+void bench_container(const char *v_pszName)
+{
+    C container;
+    atomic<LONG> nSum(0);
+    LONG nExpected = 0;
+    std::list<thread_ptr> threads;
+    for (int i = 0; i < THREADS; ++i)
+    {
+        threads.push_back(thread_ptr(new container_thread<C>(container, i * OPS, nSum)));
+        for (LONG j = 0; j < OPS; ++j)
+        {
+            nExpected += i * OPS + j;
+        }
+    }
+
+    calc_walltime ct;
+    run_threads(threads);
+    ct.end();
+
+    LONG nValue = 0;
+    while (container.pop(nValue))
+    {
+        nSum += nValue;
+    }
+    std::cout << v_pszName << ": " << THREADS * OPS * 2 / ct.run_time_in_second() / 1e6 << " Mops/s"
+              << (nSum == nExpected ? "" : ", sum mismatch") << std::endl;
+}
+
+// 被替换和退休的对象，统计存活个数
+atomic<LONG> g_nLive;
+atomic<LONG> g_nPeak;
+
+struct payload
+{
+    payload()
+    {
+        LONG nLive = ++g_nLive;
+        LONG nPeak = g_nPeak;
+        while (nLive > nPeak && !g_nPeak.compare_exchange_weak(nPeak, nLive))
+        {
+        }
+    }
+    ~payload() { --g_nLive; }
+
+    LONG m_data[16];
+};
+
+atomic<payload *> g_pShared(NULL);
+atomic<LONG> g_nStop;
+
+// 长时间读者：反复取得共享对象并持有一段时间
+template <BOOL HAZARD>
+struct holder_thread : public thread
+{
+    holder_thread() : thread(TRUE) {}
+    void run()
+    {
+        while (g_nStop == 0)
+        {
+            if (HAZARD)
+            {
+                hazard_pointer hp;
+                hp.protect(g_pShared);
+                this_thread::sleep_for(HOLD_MS);
+            }
+            else
+            {
+                ebr_guard guard;
+                g_pShared.load(memory_order_acquire);
+                this_thread::sleep_for(HOLD_MS);
+            }
+        }
+    }
+};
+
+// 写者：替换共享对象并退休旧对象，统计退休的耗时
+template <BOOL HAZARD>
+struct retire_thread : public thread
+{
+    retire_thread() : thread(TRUE), m_dTotal(0), m_dMax(0) {}
+    void run()
+    {
+        for (LONG i = 0; i < UPDATES; ++i)
+        {
+            payload *pOld = g_pShared.exchange(new payload());
+            double dStart = calc_walltime::now();
+            if (HAZARD)
+            {
+                hazard_domain::retire(pOld);
+            }
+            else
+            {
+                ebr::retire(pOld);
+            }
+            double dCost = calc_walltime::now() - dStart;
+            m_dTotal += dCost;
+            m_dMax = dCost > m_dMax ? dCost : m_dMax;
+        }
+    }
+
+    double m_dTotal;
+    double m_dMax;
+};
+
+template <BOOL HAZARD>
+void bench_retire(const char *v_pszName)
+{
+    g_nLive = 0;
+    g_nPeak = 0;
+    g_nStop = 0;
+    g_pShared = new payload();
+
+    thread_ptr holder(new holder_thread<HAZARD>());
+    holder->start();
+    std::list<thread_ptr> writers;
+    for (int i = 0; i < WRITERS; ++i)
+    {
+        writers.push_back(thread_ptr(new retire_thread<HAZARD>()));
+    }
+    run_threads(writers);
+    g_nStop = 1;
+    holder->join();
+
+    double dTotal = 0;
+    double dMax = 0;
+    for (std::list<thread_ptr>::iterator it = writers.begin(); it != writers.end(); ++it)
+    {
+        retire_thread<HAZARD> *pWriter = static_cast<retire_thread<HAZARD> *>(it->get());
+        dTotal += pWriter->m_dTotal;
+        dMax = pWriter->m_dMax > dMax ? pWriter->m_dMax : dMax;
+    }
+    std::cout << v_pszName << ": retire avg " << dTotal * 1e9 / (WRITERS * UPDATES) << " ns, max " << dMax * 1e6
+              << " us, peak live objects " << g_nPeak << std::endl;
+
+    delete g_pShared.exchange(NULL);
+}
+
+int main()
+{
+    bench_container<lock_free_stack<LONG> >("lock_free_stack");
+    bench_container<lock_free_queue<LONG> >("lock_free_queue");
+
+    // 有读者长时间持有对象时，ebr的纪元无法推进，所有退休对象都要等读者离开；风险指针只保留被持有的那一个
+    bench_retire<TRUE>("hazard_pointer");
+    bench_retire<FALSE>("ebr           ");
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,266 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/condition_variable.hpp"
+#include "../../src/utils/thread/message_queue.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+typedef shared_ptr<thread> thread_ptr;
+
+const LONG ROUNDS = 20000;    // 乒乓往返次数
+const LONG BROADCASTS = 2000; // 广播次数
+const int MAX_WAITERS = 32;
+const int PRODUCERS = 8;       // 满队列测试中的生产者数，一半push_back，一半push_front
+const int PER_PRODUCER = 5000; // 每个生产者入队的消息数
+
+// 进程累计的上下文切换次数，windows下不统计
+inline long context_switches()
+{
+#if defined(_WIN32)
+    return 0;
+#else
+    rusage usage;
+    ::getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_nvcsw + usage.ru_nivcsw;
+#endif
+}
+
+// 两个线程轮流通知对方，测量一次notify_one到对方醒来的延迟
+struct ping_pong
+{
+    ping_pong() : m_nTurn(0) {}
+
+    void play(LONG v_nSide)
+    {
+        unique_lock<mutex> lock(m_mutex);
+        for (LONG i = 0; i < ROUNDS; ++i)
+        {
+            while (m_nTurn % 2 != v_nSide)
+            {
+                m_cv.wait(lock);
+            }
+            ++m_nTurn;
+            m_cv.notify_one();
+        }
+    }
+
+    mutex m_mutex;
+    condition_variable m_cv;
+    LONG m_nTurn;
+};
+
+struct pong_thread : public thread
+{
+    pong_thread(ping_pong &v_game) : thread(TRUE), m_game(v_game) {}
+    void run() { m_game.play(1); }
+
+    ping_pong &m_game;
+};
+
+void bench_ping_pong()
+{
+    ping_pong game;
+    thread_ptr pong(new pong_thread(game));
+
+    long nSwitches = context_switches();
+    calc_walltime ct;
+    pong->start();
+    game.play(0);
+    pong->join();
+    ct.end();
+    nSwitches = context_switches() - nSwitches;
+
+    LONG nNotifies = ROUNDS * 2;
+    std::cout << "notify_one wake latency: " << ct.run_time_in_second() * 1e6 / nNotifies << " us, "
+              << static_cast<double>(nSwitches) / nNotifies << " context switches per notify" << std::endl;
+}
+
+// 多个线程等待同一代数变化，主线程递增代数后notify_all，等所有线程确认后进入下一轮
+struct broadcast
+{
+    broadcast() : m_nGeneration(0), m_nAcked(0) {}
+
+    mutex m_mutex;
+    condition_variable m_cvGeneration;
+    condition_variable m_cvAcked;
+    LONG m_nGeneration;
+    LONG m_nAcked;
+};
+
+struct waiter_thread : public thread
+{
+    waiter_thread(broadcast &v_bc) : thread(TRUE), m_bc(v_bc) {}
+    void run()
+    {
+        unique_lock<mutex> lock(m_bc.m_mutex);
+        for (LONG nSeen = 0; nSeen < BROADCASTS;)
+        {
+            while (m_bc.m_nGeneration == nSeen)
+            {
+                m_bc.m_cvGeneration.wait(lock);
+            }
+            nSeen = m_bc.m_nGeneration;
+            ++m_bc.m_nAcked;
+            m_bc.m_cvAcked.notify_one();
+        }
+    }
+
+    broadcast &m_bc;
+};
+
+void bench_broadcast(int v_nWaiters)
+{
+    broadcast bc;
+    std::list<thread_ptr> threads;
+    for (int i = 0; i < v_nWaiters; ++i)
+    {
+        threads.push_back(thread_ptr(new waiter_thread(bc)));
+        threads.back()->start();
+    }
+
+    long nSwitches = context_switches();
+    calc_walltime ct;
+    {
+        unique_lock<mutex> lock(bc.m_mutex);
+        for (LONG i = 0; i < BROADCASTS; ++i)
+        {
+            bc.m_nAcked = 0;
+            ++bc.m_nGeneration;
+            bc.m_cvGeneration.notify_all();
+            while (bc.m_nAcked < v_nWaiters)
+            {
+                bc.m_cvAcked.wait(lock);
+            }
+        }
+    }
+    ct.end();
+    nSwitches = context_switches() - nSwitches;
+
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+
+    std::cout << "notify_all with " << v_nWaiters << " waiters: " << ct.run_time_in_second() * 1e6 / BROADCASTS
+              << " us, " << static_cast<double>(nSwitches) / BROADCASTS << " context switches per notify" << std::endl;
+}
+
+struct consumer_thread : public thread
+{
+    consumer_thread(message_queue<int> &v_queue) : thread(TRUE), m_queue(v_queue) {}
+    void run()
+    {
+        int iMsg = 0;
+        m_queue.pop(iMsg);
+    }
+
+    message_queue<int> &m_queue;
+};
+
+// 消费者在空队列上等待1秒，期间的上下文切换次数反映是否定时醒来轮询
+void bench_idle_queue()
+{
+    message_queue<int> queue;
+    thread_ptr consumer(new consumer_thread(queue));
+    consumer->start();
+    this_thread::sleep_for(100);
+
+    long nSwitches = context_switches();
+    this_thread::sleep_for(1000);
+    nSwitches = context_switches() - nSwitches;
+
+    queue.push_back(0);
+    consumer->join();
+
+    std::cout << "idle message_queue consumer: " << nSwitches << " context switches in 1s" << std::endl;
+}
+
+struct producer_thread : public thread
+{
+    producer_thread(message_queue<int> &v_queue, BOOL v_bFront, atomic<LONG> &v_nPushed)
+        : thread(TRUE), m_queue(v_queue), m_bFront(v_bFront), m_nPushed(v_nPushed)
+    {
+    }
+    void run()
+    {
+        for (int i = 0; i < PER_PRODUCER; ++i)
+        {
+            if (m_bFront)
+            {
+                m_queue.push_front(i);
+            }
+            else
+            {
+                m_queue.push_back(i);
+            }
+            ++m_nPushed;
+        }
+    }
+
+    message_queue<int> &m_queue;
+    BOOL m_bFront;
+    atomic<LONG> &m_nPushed;
+};
+
+// 小容量队列上push_front和push_back混合阻塞，两者在同一个条件变量上持有不同的锁等待，
+// 任何一次唤醒丢失都会使生产者永久阻塞，超过5秒没有进展即判定失败
+int stress_full_queue()
+{
+    message_queue<int> queue(2);
+    atomic<LONG> nPushed(0);
+    std::list<thread_ptr> threads;
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        threads.push_back(thread_ptr(new producer_thread(queue, i % 2 == 0, nPushed)));
+        threads.back()->start();
+    }
+
+    const LONG nTotal = PRODUCERS * PER_PRODUCER;
+    calc_walltime ct;
+    DWORD dwLastProgress = tick_count();
+    LONG nPopped = 0;
+    int msgs[16];
+    while (nPopped < nTotal)
+    {
+        size_t nCount = queue.pop_bulk(msgs, 16, 1, 100);
+        nPopped += static_cast<LONG>(nCount);
+        if (nCount > 0)
+        {
+            dwLastProgress = tick_count();
+        }
+        else if (tick_count() - dwLastProgress > 5000)
+        {
+            std::cout << "full message_queue push_front/push_back: stalled after " << nPopped << " of " << nTotal
+                      << " messages, " << nPushed.load() << " pushed" << std::endl;
+            return 1;
+        }
+    }
+    ct.end();
+
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+
+    std::cout << "full message_queue push_front/push_back: " << nTotal << " messages in " << ct.run_time_in_second()
+              << " s" << std::endl;
+    return 0;
+}
+
+int main()
+{
+    bench_ping_pong();
+    for (int nWaiters = 1; nWaiters <= MAX_WAITERS; nWaiters *= 2)
+    {
+        bench_broadcast(nWaiters);
+    }
+    bench_idle_queue();
+
+    return stress_full_queue();
+}
\ No newline at end of file
@@ -0,0 +1,195 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/barrier.hpp"
+#include "../../src/utils/thread/latch.hpp"
+#include "../../src/utils/thread/semaphore.hpp"
+#include "../../src/utils/thread/condition_variable.hpp"
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+typedef shared_ptr<thread> thread_ptr;
+
+const LONG PHASES = 20000;    // 屏障的阶段数
+const LONG TOKENS = 200000;   // 信号量传递的次数
+const LONG FORK_JOINS = 2000; // 分叉汇合的轮数
+const int MAX_THREADS = 16;
+
+atomic<LONG> g_nCompleted;
+
+// 用互斥量和条件变量实现的屏障，作为对比
+class cv_barrier
+{
+public:
+    cv_barrier(LONG v_nExpected) : m_nExpected(v_nExpected), m_nRemaining(v_nExpected), m_nPhase(0) {}
+
+    void arrive_and_wait()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        LONG nPhase = m_nPhase;
+        if (--m_nRemaining == 0)
+        {
+            ++g_nCompleted;
+            m_nRemaining = m_nExpected;
+            ++m_nPhase;
+            m_cv.notify_all();
+            return;
+        }
+        while (m_nPhase == nPhase)
+        {
+            m_cv.wait(lock);
+        }
+    }
+
+private:
+    mutex m_mutex;
+    condition_variable m_cv;
+    LONG m_nExpected;
+    LONG m_nRemaining;
+    LONG m_nPhase;
+};
+
+void on_phase_completed(void *)
+{
+    ++g_nCompleted;
+}
+
+template <typename T>
+struct phase_thread : public thread
+{
+    phase_thread(T &v_barrier) : thread(TRUE), m_barrier(v_barrier) {}
+    void run()
+    {
+        for (LONG i = 0; i < PHASES; ++i)
+        {
+            m_barrier.arrive_and_wait();
+        }
+    }
+
+    T &m_barrier;
+};
+
+template <typename T>
+void bench_barrier(const char *v_pszName, T &v_barrier, int v_nThreads)
+{
+    std::list<thread_ptr> threads;
+    g_nCompleted = 0;
+
+    calc_walltime ct;
+    for (int i = 0; i < v_nThreads; ++i)
+    {
+        threads.push_back(thread_ptr(new phase_thread<T>(v_barrier)));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    if (g_nCompleted != PHASES)
+    {
+        std::cout << "completed phases: " << g_nCompleted << std::endl;
+    }
+    std::cout << "  " << v_pszName << ": " << ct.run_time_in_second() * 1e6 / PHASES << " us per phase" << std::endl;
+}
+
+// 两个线程通过一对信号量交替传递令牌
+struct token_thread : public thread
+{
+    token_thread(counting_semaphore &v_semIn, counting_semaphore &v_semOut)
+        : thread(TRUE), m_semIn(v_semIn), m_semOut(v_semOut)
+    {
+    }
+    void run()
+    {
+        for (LONG i = 0; i < TOKENS; ++i)
+        {
+            m_semIn.acquire();
+            m_semOut.release();
+        }
+    }
+
+    counting_semaphore &m_semIn;
+    counting_semaphore &m_semOut;
+};
+
+void bench_semaphore()
+{
+    counting_semaphore semPing(1);
+    counting_semaphore semPong(0);
+    thread_ptr ping(new token_thread(semPing, semPong));
+    thread_ptr pong(new token_thread(semPong, semPing));
+
+    calc_walltime ct;
+    ping->start();
+    pong->start();
+    ping->join();
+    pong->join();
+    ct.end();
+
+    std::cout << "semaphore hand-off: " << ct.run_time_in_second() * 1e6 / (TOKENS * 2) << " us" << std::endl;
+}
+
+void count_down(void *v_param)
+{
+    static_cast<latch *>(v_param)->count_down();
+}
+
+void no_op(void *)
+{
+}
+
+// 每轮提交一批任务后等待全部完成，对比latch汇合与线程池wait()
+void bench_fork_join(int v_nTasks)
+{
+    thread_pool pool(4);
+
+    calc_walltime ct;
+    for (LONG i = 0; i < FORK_JOINS; ++i)
+    {
+        latch done(v_nTasks);
+        for (int j = 0; j < v_nTasks; ++j)
+        {
+            pool.submit(task_func(count_down, &done));
+        }
+        done.wait();
+    }
+    ct.end();
+    std::cout << "  latch join of " << v_nTasks << " tasks: " << ct.run_time_in_second() * 1e6 / FORK_JOINS << " us"
+              << std::endl;
+
+    ct.start();
+    for (LONG i = 0; i < FORK_JOINS; ++i)
+    {
+        for (int j = 0; j < v_nTasks; ++j)
+        {
+            pool.submit(task_func(no_op));
+        }
+        pool.wait();
+    }
+    ct.end();
+    std::cout << "  thread_pool::wait() of " << v_nTasks << " tasks: " << ct.run_time_in_second() * 1e6 / FORK_JOINS
+              << " us" << std::endl;
+}
+
+int main()
+{
+    for (int nThreads = 2; nThreads <= MAX_THREADS; nThreads *= 2)
+    {
+        std::cout << nThreads << " threads" << std::endl;
+        cv_barrier cvBarrier(nThreads);
+        bench_barrier("mutex + condition_variable", cvBarrier, nThreads);
+        barrier futexBarrier(nThreads, on_phase_completed);
+        bench_barrier("barrier                   ", futexBarrier, nThreads);
+    }
+
+    bench_semaphore();
+
+    std::cout << "fork-join" << std::endl;
+    bench_fork_join(16);
+    bench_fork_join(256);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#include <iostream>
+
+#include "../../src/utils/thread/spsc_queue.hpp"
+#include "../../src/utils/thread/message_queue.hpp"
+#include "../../src/utils/thread/mpmc_ring_queue.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG MESSAGES = 20000000; // 每种队列传递的消息数
+const size_t CAPACITY = 65536;
+const size_t BATCH = 64;
+
+atomic<LONG> g_nErrors;
+
+// 逐条写入，Q为message_queue或mpmc_ring_queue时同样可用
+template <typename Q>
+struct producer_thread : public thread
+{
+    producer_thread(Q &v_queue) : thread(TRUE), m_queue(v_queue) {}
+    void run()
+    {
+        for (LONG i = 0; i < MESSAGES; ++i)
+        {
+            m_queue.push_back(i);
+        }
+    }
+
+    Q &m_queue;
+};
+
+// 逐条读取并检查顺序
+template <typename Q>
+void consume(Q &v_queue)
+{
+    for (LONG i = 0; i < MESSAGES; ++i)
+    {
+        LONG nMsg = 0;
+        v_queue.pop(nMsg);
+        if (nMsg != i)
+        {
+            ++g_nErrors;
+        }
+    }
+}
+
+struct bulk_producer_thread : public thread
+{
+    bulk_producer_thread(spsc_queue<LONG> &v_queue) : thread(TRUE), m_queue(v_queue) {}
+    void run()
+    {
+        LONG msgs[BATCH];
+        for (LONG i = 0; i < MESSAGES; i += BATCH)
+        {
+            for (size_t j = 0; j < BATCH; ++j)
+            {
+                msgs[j] = i + static_cast<LONG>(j);
+            }
+            m_queue.push_back_bulk(msgs, BATCH);
+        }
+    }
+
+    spsc_queue<LONG> &m_queue;
+};
+
+void consume_bulk(spsc_queue<LONG> &v_queue)
+{
+    LONG msgs[BATCH];
+    for (LONG nNext = 0; nNext < MESSAGES;)
+    {
+        size_t nPop = v_queue.pop_bulk(msgs, BATCH);
+        for (size_t j = 0; j < nPop; ++j, ++nNext)
+        {
+            if (msgs[j] != nNext)
+            {
+                ++g_nErrors;
+            }
+        }
+    }
+}
+
+void report(const char *v_pszName, calc_walltime &v_ct)
+{
+    v_ct.end();
+    std::cout << "  " << v_pszName << ": " << MESSAGES / v_ct.run_time_in_second() / 1e6 << " M msgs/s" << std::endl;
+}
+
+template <typename Q>
+void bench(const char *v_pszName, Q &v_queue)
+{
+    producer_thread<Q> producer(v_queue);
+    calc_walltime ct;
+    producer.start();
+    consume(v_queue);
+    producer.join();
+    report(v_pszName, ct);
+}
+
+void bench_bulk(const char *v_pszName, spsc_queue<LONG> &v_queue)
+{
+    bulk_producer_thread producer(v_queue);
+    calc_walltime ct;
+    producer.start();
+    consume_bulk(v_queue);
+    producer.join();
+    report(v_pszName, ct);
+}
+
+int main()
+{
+    std::cout << "1 producer, 1 consumer, " << MESSAGES << " messages" << std::endl;
+    {
+        message_queue<LONG> queue(CAPACITY);
+        bench("message_queue             ", queue);
+    }
+    {
+        mpmc_ring_queue<LONG> queue(CAPACITY);
+        bench("mpmc_ring_queue           ", queue);
+    }
+    {
+        spsc_queue<LONG> queue(CAPACITY);
+        bench("spsc_queue blocking       ", queue);
+    }
+    {
+        spsc_queue<LONG> queue(CAPACITY, FALSE);
+        bench("spsc_queue spinning       ", queue);
+    }
+    {
+        spsc_queue<LONG> queue(CAPACITY);
+        bench_bulk("spsc_queue blocking, bulk ", queue);
+    }
+    {
+        spsc_queue<LONG> queue(CAPACITY, FALSE);
+        bench_bulk("spsc_queue spinning, bulk ", queue);
+    }
+
+    if (g_nErrors != 0)
+    {
+        std::cout << "out of order: " << g_nErrors << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,194 @@
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "../../src/utils/thread/mailbox.hpp"
+#include "../../src/utils/thread/message_queue.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+typedef shared_ptr<thread> thread_ptr;
+
+const int PRODUCERS = 4;
+const LONG MESSAGES = 2000000; // 每个生产者投递的消息数
+const size_t MAILBOXES = 10000;
+
+// 消息内嵌队列节点，预先分配，投递时不分配内存
+struct count_msg : public mpsc_node
+{
+    LONG m_nValue;
+};
+
+// 累加收到的消息值，同一信箱的消息串行处理，不需要原子操作
+class counter_actor : public mailbox<count_msg>
+{
+public:
+    counter_actor(mailbox_scheduler &v_scheduler) : mailbox<count_msg>(v_scheduler), m_nSum(0), m_nCount(0) {}
+
+    LONG m_nSum;
+    LONG m_nCount;
+
+protected:
+    void on_message(count_msg *v_pMsg)
+    {
+        m_nSum += v_pMsg->m_nValue;
+        ++m_nCount;
+    }
+};
+
+struct post_thread : public thread
+{
+    post_thread(std::vector<counter_actor *> &v_actors, count_msg *v_pMsgs)
+        : thread(TRUE), m_actors(v_actors), m_pMsgs(v_pMsgs)
+    {
+    }
+    void run()
+    {
+        for (LONG i = 0; i < MESSAGES; ++i)
+        {
+            m_pMsgs[i].m_nValue = 1;
+            m_actors[static_cast<size_t>(i) % m_actors.size()]->post(&m_pMsgs[i]);
+        }
+    }
+
+    std::vector<counter_actor *> &m_actors;
+    count_msg *m_pMsgs;
+};
+
+void bench_mailbox(size_t v_nMailboxes)
+{
+    thread_pool pool(4, 0);
+    mailbox_scheduler scheduler(pool);
+    std::vector<counter_actor *> actors;
+    for (size_t i = 0; i < v_nMailboxes; ++i)
+    {
+        actors.push_back(new counter_actor(scheduler));
+    }
+    std::vector<count_msg> msgs(static_cast<size_t>(PRODUCERS * MESSAGES));
+
+    std::list<thread_ptr> threads;
+    calc_walltime ct;
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        threads.push_back(thread_ptr(new post_thread(actors, &msgs[static_cast<size_t>(i * MESSAGES)])));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    scheduler.wait();
+    ct.end();
+
+    LONG nTotal = 0;
+    for (size_t i = 0; i < actors.size(); ++i)
+    {
+        nTotal += actors[i]->m_nSum;
+        delete actors[i];
+    }
+    if (nTotal != PRODUCERS * MESSAGES)
+    {
+        std::cout << "lost messages: " << PRODUCERS * MESSAGES - nTotal << std::endl;
+    }
+    std::cout << "  " << v_nMailboxes << " mailboxes: " << PRODUCERS * MESSAGES / ct.run_time_in_second() / 1e6
+              << " M msgs/s" << std::endl;
+}
+
+// 多个生产者写入同一个队列，单个消费者读取
+template <typename Q, typename M>
+struct queue_producer_thread : public thread
+{
+    queue_producer_thread(Q &v_queue, M *v_pMsgs) : thread(TRUE), m_queue(v_queue), m_pMsgs(v_pMsgs) {}
+    void run()
+    {
+        for (LONG i = 0; i < MESSAGES; ++i)
+        {
+            m_queue.push_back(&m_pMsgs[i]);
+        }
+    }
+
+    Q &m_queue;
+    M *m_pMsgs;
+};
+
+// 让mpsc_queue与message_queue使用相同的生产者代码
+struct mpsc_adapter
+{
+    void push_back(count_msg *v_pMsg) { m_queue.push(v_pMsg); }
+    mpsc_queue<count_msg> m_queue;
+};
+
+void bench_queues()
+{
+    std::vector<count_msg> msgs(static_cast<size_t>(PRODUCERS * MESSAGES));
+    LONG nTotal = PRODUCERS * MESSAGES;
+
+    {
+        message_queue<count_msg *> queue(0);
+        std::list<thread_ptr> threads;
+        calc_walltime ct;
+        for (int i = 0; i < PRODUCERS; ++i)
+        {
+            threads.push_back(thread_ptr(new queue_producer_thread<message_queue<count_msg *>, count_msg>(
+                queue, &msgs[static_cast<size_t>(i * MESSAGES)])));
+            threads.back()->start();
+        }
+        count_msg *pMsg = NULL;
+        for (LONG i = 0; i < nTotal; ++i)
+        {
+            queue.pop(pMsg);
+        }
+        ct.end();
+        for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+        {
+            (*it)->join();
+        }
+        std::cout << "  message_queue: " << nTotal / ct.run_time_in_second() / 1e6 << " M msgs/s" << std::endl;
+    }
+
+    {
+        mpsc_adapter queue;
+        std::list<thread_ptr> threads;
+        calc_walltime ct;
+        for (int i = 0; i < PRODUCERS; ++i)
+        {
+            threads.push_back(thread_ptr(new queue_producer_thread<mpsc_adapter, count_msg>(
+                queue, &msgs[static_cast<size_t>(i * MESSAGES)])));
+            threads.back()->start();
+        }
+        for (LONG i = 0; i < nTotal;)
+        {
+            if (queue.m_queue.pop())
+            {
+                ++i;
+            }
+            else
+            {
+                this_thread::yield();
+            }
+        }
+        ct.end();
+        for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+        {
+            (*it)->join();
+        }
+        std::cout << "  mpsc_queue:    " << nTotal / ct.run_time_in_second() / 1e6 << " M msgs/s" << std::endl;
+    }
+}
+
+int main()
+{
+    std::cout << "memory per mailbox, excluding kernel objects" << std::endl;
+    std::cout << "  message_queue<count_msg *>: " << sizeof(message_queue<count_msg *>) << " bytes" << std::endl;
+    std::cout << "  mailbox<count_msg>:         " << sizeof(mailbox<count_msg>) << " bytes" << std::endl;
+
+    std::cout << PRODUCERS << " producers, 1 consumer" << std::endl;
+    bench_queues();
+
+    std::cout << PRODUCERS << " producers, thread_pool with 4 workers" << std::endl;
+    bench_mailbox(1);
+    bench_mailbox(100);
+    bench_mailbox(MAILBOXES);
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <deque>
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/thread/message_queue.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG MESSAGES = 10000000; // 传递的消息数
+const size_t BATCH = 256;       // 生产者每批写入的消息数
+
+enum push_mode
+{
+    PUSH_ONE,   // push_back()逐条写入
+    PUSH_RANGE, // push_back_range()按批写入
+    PUSH_ALL    // push_back_all()整批交换
+};
+
+enum pop_mode
+{
+    POP_ONE, // pop()逐条读取
+    POP_N,   // pop_n()按批读取
+    POP_ALL  // pop_all()整批交换
+};
+
+atomic<LONG> g_nErrors;
+
+struct producer_thread : public thread
+{
+    producer_thread(message_queue<LONG> &v_queue, push_mode v_eMode)
+        : thread(TRUE), m_queue(v_queue), m_eMode(v_eMode)
+    {
+    }
+    void run()
+    {
+        std::vector<LONG> vecBatch(BATCH);
+        std::deque<LONG> dequeBatch;
+        for (LONG i = 0; i < MESSAGES; i += BATCH)
+        {
+            if (m_eMode == PUSH_ONE)
+            {
+                for (size_t j = 0; j < BATCH; ++j)
+                {
+                    m_queue.push_back(i + static_cast<LONG>(j));
+                }
+            }
+            else if (m_eMode == PUSH_RANGE)
+            {
+                for (size_t j = 0; j < BATCH; ++j)
+                {
+                    vecBatch[j] = i + static_cast<LONG>(j);
+                }
+                m_queue.push_back_range(vecBatch.begin(), vecBatch.end());
+            }
+            else
+            {
+                for (size_t j = 0; j < BATCH; ++j)
+                {
+                    dequeBatch.push_back(i + static_cast<LONG>(j));
+                }
+                m_queue.push_back_all(dequeBatch);
+            }
+        }
+    }
+
+    message_queue<LONG> &m_queue;
+    push_mode m_eMode;
+};
+
+void consume(message_queue<LONG> &v_queue, pop_mode v_eMode)
+{
+    std::vector<LONG> vecBatch(BATCH);
+    std::deque<LONG> dequeAll;
+    LONG nNext = 0;
+    while (nNext < MESSAGES)
+    {
+        if (v_eMode == POP_ONE)
+        {
+            LONG nMsg = 0;
+            v_queue.pop(nMsg);
+            g_nErrors += (nMsg != nNext++);
+        }
+        else if (v_eMode == POP_N)
+        {
+            size_t nPop = v_queue.pop_n(vecBatch.begin(), BATCH);
+            for (size_t i = 0; i < nPop; ++i)
+            {
+                g_nErrors += (vecBatch[i] != nNext++);
+            }
+        }
+        else
+        {
+            v_queue.pop_all(dequeAll);
+            for (std::deque<LONG>::iterator it = dequeAll.begin(); it != dequeAll.end(); ++it)
+            {
+                g_nErrors += (*it != nNext++);
+            }
+        }
+    }
+}
+
+void bench(const char *v_pszName, push_mode v_ePush, pop_mode v_ePop)
+{
+    message_queue<LONG> queue(65536);
+    producer_thread producer(queue, v_ePush);
+
+    calc_walltime ct;
+    producer.start();
+    consume(queue, v_ePop);
+    producer.join();
+    ct.end();
+
+    std::cout << "  " << v_pszName << ": " << MESSAGES / ct.run_time_in_second() / 1e6 << " M msgs/s" << std::endl;
+}
+
+int main()
+{
+    std::cout << "1 producer, 1 consumer, " << MESSAGES << " messages" << std::endl;
+    bench("push_back       + pop    ", PUSH_ONE, POP_ONE);
+    bench("push_back       + pop_n  ", PUSH_ONE, POP_N);
+    bench("push_back       + pop_all", PUSH_ONE, POP_ALL);
+    bench("push_back_range + pop_n  ", PUSH_RANGE, POP_N);
+    bench("push_back_range + pop_all", PUSH_RANGE, POP_ALL);
+    bench("push_back_all   + pop_all", PUSH_ALL, POP_ALL);
+
+    if (g_nErrors != 0)
+    {
+        std::cout << "out of order: " << g_nErrors << std::endl;
+    }
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,150 @@
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const size_t THREADS = 4;
+const int COMPACTIONS = 4000; // 后台压缩任务数，每个约0.5毫秒
+const int RPCS = 500;         // 延迟敏感的RPC请求数，每毫秒到达一个
+const int FLOOD = 20000;      // 饥饿测试中持续提交的高优先级任务数
+
+// 占用CPU约v_nMicros微秒，模拟计算
+void busy_work(int v_nMicros)
+{
+    calc_walltime ct;
+    volatile LONG nSink = 0;
+    while (ct.run_time_in_second() * 1e6 < v_nMicros)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            nSink = nSink + i;
+        }
+        ct.end();
+    }
+}
+
+void compaction_task(void *) { busy_work(500); }
+void flood_task(void *) { busy_work(50); }
+
+// RPC请求自己记录从提交到开始执行的时间
+struct rpc_request
+{
+    DWORD m_dwSubmitTick;
+    DWORD m_dwWaitMs;
+};
+
+void rpc_task(void *v_pParam)
+{
+    rpc_request *pRequest = static_cast<rpc_request *>(v_pParam);
+    pRequest->m_dwWaitMs = tick_count() - pRequest->m_dwSubmitTick;
+    busy_work(50);
+}
+
+void print_wait(const char *v_pszName, const std::vector<rpc_request> &v_requests)
+{
+    DWORD dwTotal = 0;
+    DWORD dwMax = 0;
+    for (size_t i = 0; i < v_requests.size(); ++i)
+    {
+        dwTotal += v_requests[i].m_dwWaitMs;
+        dwMax = v_requests[i].m_dwWaitMs > dwMax ? v_requests[i].m_dwWaitMs : dwMax;
+    }
+    std::cout << "  " << std::left << std::setw(28) << v_pszName << "rpc wait avg "
+              << static_cast<double>(dwTotal) / v_requests.size() << " ms, max " << dwMax << " ms" << std::endl;
+}
+
+void print_stats(thread_pool &v_pool)
+{
+    for (int i = thread_pool::PRIORITY_LEVELS - 1; i >= 0; --i)
+    {
+        thread_pool::priority_stats stats = v_pool.stats(i);
+        if (stats.m_llExecuted == 0)
+        {
+            continue;
+        }
+        std::cout << "    level " << i << ": executed " << stats.m_llExecuted << ", avg wait "
+                  << static_cast<double>(stats.m_llWaitMs) / stats.m_llExecuted << " ms, max wait "
+                  << stats.m_dwMaxWaitMs << " ms" << std::endl;
+    }
+}
+
+// 后台压缩任务积压时，RPC请求按固定间隔到达，比较使用相同优先级和高优先级时RPC的排队时间
+void bench_latency(thread_pool::schedule_mode v_eMode, BOOL v_bPriority)
+{
+    thread_pool pool(THREADS, 0, v_eMode);
+    for (int i = 0; i < COMPACTIONS; ++i)
+    {
+        if (v_bPriority)
+        {
+            pool.submit(task_func(compaction_task), 0);
+        }
+        else
+        {
+            pool.submit(task_func(compaction_task));
+        }
+    }
+
+    std::vector<rpc_request> requests(RPCS);
+    for (int i = 0; i < RPCS; ++i)
+    {
+        requests[i].m_dwSubmitTick = tick_count();
+        if (v_bPriority)
+        {
+            pool.submit(task_func(rpc_task, &requests[i]), thread_pool::HIGH_PRIORITY);
+        }
+        else
+        {
+            pool.submit(task_func(rpc_task, &requests[i]));
+        }
+        this_thread::sleep_for(1);
+    }
+    pool.wait();
+
+    const char *pszMode = v_eMode == thread_pool::GLOBAL_QUEUE ? "global" : "work stealing";
+    std::cout << pszMode << (v_bPriority ? ", rpc high priority:" : ", same priority:") << std::endl;
+    print_wait(v_bPriority ? "  high/low" : "  fifo", requests);
+    if (v_bPriority)
+    {
+        print_stats(pool);
+    }
+}
+
+// 高优先级任务持续提交时，低优先级任务依靠老化仍能执行
+void bench_aging(thread_pool::schedule_mode v_eMode)
+{
+    thread_pool pool(THREADS, 0, v_eMode);
+    calc_walltime ct;
+    for (int i = 0; i < FLOOD; ++i)
+    {
+        pool.submit(task_func(flood_task), thread_pool::HIGH_PRIORITY);
+        if (i % 100 == 0)
+        {
+            pool.submit(task_func(compaction_task), 0);
+        }
+    }
+    pool.wait();
+    ct.end();
+
+    const char *pszMode = v_eMode == thread_pool::GLOBAL_QUEUE ? "global" : "work stealing";
+    std::cout << pszMode << ", high priority flood for " << ct.run_time_in_second() * 1000 << " ms:" << std::endl;
+    print_stats(pool);
+
+    // 超出范围的优先级取最近的边界，与submit()一致
+    std::cout << "    stats(" << thread_pool::PRIORITY_LEVELS << ") executed "
+              << pool.stats(thread_pool::PRIORITY_LEVELS).m_llExecuted << ", stats(-1) executed "
+              << pool.stats(-1).m_llExecuted << std::endl;
+}
+
+int main()
+{
+    bench_latency(thread_pool::GLOBAL_QUEUE, FALSE);
+    bench_latency(thread_pool::GLOBAL_QUEUE, TRUE);
+    bench_latency(thread_pool::WORK_STEALING, FALSE);
+    bench_latency(thread_pool::WORK_STEALING, TRUE);
+
+    bench_aging(thread_pool::GLOBAL_QUEUE);
+    bench_aging(thread_pool::WORK_STEALING);
+    return 0;
+}
\ No newline at end of file
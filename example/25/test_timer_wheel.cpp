@@ -0,0 +1,161 @@
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/thread/timer_wheel.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const size_t TIMERS = 1000000;   // 同时存在的定时器数
+const DWORD MAX_DELAY = 600000;  // 最长定时，单位刻度
+const int JITTER_TIMERS = 2000;  // 测量触发误差的定时器数
+const int PERIODIC_ROUNDS = 200; // 周期定时器的触发次数
+
+void noop_task(void *) {}
+
+// 时间轮本身的添加、取消、到期吞吐，不加锁，不提交线程池
+void bench_wheel()
+{
+    timer_wheel wheel;
+    std::vector<timer_handle> handles(TIMERS);
+    std::vector<task_func> vecExpired;
+    UINT32 uiSeed = 12345;
+
+    for (int nRound = 0; nRound < 3; ++nRound)
+    {
+        calc_walltime ct;
+        for (size_t i = 0; i < TIMERS; ++i)
+        {
+            uiSeed = uiSeed * 1664525 + 1013904223;
+            handles[i] = wheel.add(uiSeed % MAX_DELAY, task_func(noop_task));
+        }
+        ct.end();
+        double dInsert = ct.run_time_in_second();
+
+        // 取消一半，模拟超时前完成的请求
+        ct.reset();
+        size_t nCancelled = 0;
+        for (size_t i = 0; i < TIMERS; i += 2)
+        {
+            nCancelled += wheel.cancel(handles[i]) ? 1 : 0;
+        }
+        ct.end();
+        double dCancel = ct.run_time_in_second();
+
+        ct.reset();
+        size_t nExpired = 0;
+        for (DWORD dwTick = 0; dwTick < MAX_DELAY; ++dwTick)
+        {
+            nExpired += wheel.advance(wheel.now() + 1, vecExpired);
+            vecExpired.clear();
+        }
+        ct.end();
+        double dExpire = ct.run_time_in_second();
+
+        // 已执行的定时器的句柄失效，取消不影响复用节点的新定时器
+        size_t nStale = wheel.cancel(handles[1]) ? 1 : 0;
+
+        std::cout << "round " << nRound << ": insert " << TIMERS / dInsert / 1e6 << " M/s, cancel "
+                  << nCancelled / dCancel / 1e6 << " M/s, expire " << nExpired / dExpire / 1e6 << " M/s over "
+                  << MAX_DELAY << " ticks, left " << wheel.size() << ", stale cancel " << nStale << ", nodes "
+                  << wheel.capacity() << std::endl;
+    }
+}
+
+// 到期任务记录实际执行时刻
+struct jitter_probe
+{
+    double m_dExpected; // 预定的执行时刻，单位秒
+    double m_dActual;   // 实际的执行时刻，单位秒
+};
+
+void probe_task(void *v_pParam)
+{
+    static_cast<jitter_probe *>(v_pParam)->m_dActual = calc_walltime::now();
+}
+
+void print_lateness(const char *v_pszName, std::vector<double> &v_vecLateMs)
+{
+    std::sort(v_vecLateMs.begin(), v_vecLateMs.end());
+    double dSum = 0;
+    for (size_t i = 0; i < v_vecLateMs.size(); ++i)
+    {
+        dSum += v_vecLateMs[i];
+    }
+    std::cout << v_pszName << ": min " << v_vecLateMs.front() << " ms, avg " << dSum / v_vecLateMs.size()
+              << " ms, p99 " << v_vecLateMs[v_vecLateMs.size() * 99 / 100] << " ms, max " << v_vecLateMs.back()
+              << " ms" << std::endl;
+}
+
+// 一次性定时器的触发误差：实际执行时刻减预定时刻
+void bench_jitter(thread_pool &v_pool)
+{
+    timer_service service(v_pool);
+    std::vector<jitter_probe> probes(JITTER_TIMERS);
+    for (int i = 0; i < JITTER_TIMERS; ++i)
+    {
+        DWORD dwDelay = static_cast<DWORD>(1 + i % 500);
+        probes[i].m_dExpected = calc_walltime::now() + dwDelay / 1000.0;
+        service.schedule_after(dwDelay, task_func(probe_task, &probes[i]));
+    }
+    this_thread::sleep_for(700);
+    v_pool.wait();
+
+    std::vector<double> vecLateMs;
+    int nEarly = 0;
+    for (int i = 0; i < JITTER_TIMERS; ++i)
+    {
+        vecLateMs.push_back((probes[i].m_dActual - probes[i].m_dExpected) * 1000);
+        nEarly += vecLateMs.back() < 0 ? 1 : 0;
+    }
+    print_lateness("one-shot lateness", vecLateMs);
+    std::cout << "fired early: " << nEarly << (nEarly ? " (ERROR)" : "") << std::endl;
+}
+
+struct periodic_probe
+{
+    std::vector<double> m_vecFired;
+    timer_service *m_pService;
+    timer_handle m_handle;
+};
+
+void periodic_task(void *v_pParam)
+{
+    periodic_probe *pProbe = static_cast<periodic_probe *>(v_pParam);
+    pProbe->m_vecFired.push_back(calc_walltime::now());
+    if (pProbe->m_vecFired.size() == PERIODIC_ROUNDS)
+    {
+        pProbe->m_pService->cancel(pProbe->m_handle);
+    }
+}
+
+// 周期定时器的误差：第n次执行时刻减去第一次执行时刻加n个周期，周期按刻度累加，误差不随次数累积
+void bench_periodic(thread_pool &v_pool)
+{
+    const DWORD PERIOD_MS = 5;
+    timer_service service(v_pool);
+    periodic_probe probe;
+    probe.m_pService = &service;
+    probe.m_handle = service.schedule_every(PERIOD_MS, task_func(periodic_task, &probe));
+    this_thread::sleep_for(PERIOD_MS * (PERIODIC_ROUNDS + 20));
+    v_pool.wait();
+
+    std::vector<double> vecLateMs;
+    for (size_t i = 1; i < probe.m_vecFired.size(); ++i)
+    {
+        double dDrift = (probe.m_vecFired[i] - probe.m_vecFired[0]) * 1000 - static_cast<double>(i * PERIOD_MS);
+        vecLateMs.push_back(dDrift > 0 ? dDrift : -dDrift);
+    }
+    std::cout << "periodic fired " << probe.m_vecFired.size() << " times, left " << service.size() << std::endl;
+    print_lateness("periodic drift", vecLateMs);
+}
+
+int main()
+{
+    bench_wheel();
+
+    // 周期任务在单个线程中执行，不需要同步
+    thread_pool pool(1, 0);
+    bench_jitter(pool);
+    bench_periodic(pool);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/thread/task_graph.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const size_t THREADS = 4;
+const int RUNS = 200;    // 每种图的执行次数
+const int WORK = 2000;   // 每个节点的计算量
+const size_t FAN_IN = 3; // 每个节点依赖上一层的节点数
+
+// 节点按层排列，每层的节点依赖上一层的FAN_IN个节点
+struct layered_graph
+{
+    layered_graph(size_t v_nDepth, size_t v_nWidth) : m_nDepth(v_nDepth), m_nWidth(v_nWidth)
+    {
+        m_counts.resize(v_nDepth * v_nWidth, 0);
+    }
+
+    size_t index(size_t v_nLayer, size_t v_nColumn) const { return v_nLayer * m_nWidth + v_nColumn; }
+
+    size_t m_nDepth;
+    size_t m_nWidth;
+    std::vector<LONG> m_counts; // 每个节点的执行次数，每个节点同一时刻只有一个线程执行
+};
+
+void node_task(void *v_pParam)
+{
+    volatile LONG nSink = 0;
+    for (int i = 0; i < WORK; ++i)
+    {
+        nSink = nSink + i;
+    }
+    ++*static_cast<LONG *>(v_pParam);
+}
+
+// 逐层提交并等待整层执行完，层内并行，层间有同步点
+double bench_layer_by_layer(thread_pool &v_pool, layered_graph &v_graph)
+{
+    std::vector<task_func> vecLayer(v_graph.m_nWidth);
+    calc_walltime ct;
+    for (int nRun = 0; nRun < RUNS; ++nRun)
+    {
+        for (size_t nLayer = 0; nLayer < v_graph.m_nDepth; ++nLayer)
+        {
+            for (size_t i = 0; i < v_graph.m_nWidth; ++i)
+            {
+                vecLayer[i] = task_func(node_task, &v_graph.m_counts[v_graph.index(nLayer, i)]);
+            }
+            v_pool.submit_bulk(&vecLayer[0], vecLayer.size());
+            v_pool.wait();
+        }
+    }
+    ct.end();
+    return ct.run_time_in_second();
+}
+
+// 声明一次依赖图，反复执行，节点只等待自己的前驱
+double bench_task_graph(thread_pool &v_pool, layered_graph &v_graph)
+{
+    task_graph graph;
+    for (size_t i = 0; i < v_graph.m_counts.size(); ++i)
+    {
+        graph.add_node(task_func(node_task, &v_graph.m_counts[i]));
+    }
+    for (size_t nLayer = 1; nLayer < v_graph.m_nDepth; ++nLayer)
+    {
+        for (size_t i = 0; i < v_graph.m_nWidth; ++i)
+        {
+            for (size_t j = 0; j < FAN_IN && j < v_graph.m_nWidth; ++j)
+            {
+                graph.precede(v_graph.index(nLayer - 1, (i * 7 + j) % v_graph.m_nWidth), v_graph.index(nLayer, i));
+            }
+        }
+    }
+
+    calc_walltime ct;
+    for (int nRun = 0; nRun < RUNS; ++nRun)
+    {
+        graph.run(v_pool);
+    }
+    ct.end();
+    return ct.run_time_in_second();
+}
+
+BOOL verify(const layered_graph &v_graph, LONG v_nExpected)
+{
+    for (size_t i = 0; i < v_graph.m_counts.size(); ++i)
+    {
+        if (v_graph.m_counts[i] != v_nExpected)
+        {
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+void bench_shape(const char *v_pszName, size_t v_nDepth, size_t v_nWidth, thread_pool::schedule_mode v_eMode)
+{
+    thread_pool pool(THREADS, 0, v_eMode);
+    layered_graph graph(v_nDepth, v_nWidth);
+    double dLayer = bench_layer_by_layer(pool, graph);
+    double dGraph = bench_task_graph(pool, graph);
+    std::cout << "  " << v_pszName << " (" << v_nDepth << " x " << v_nWidth << "): layer by layer " << dLayer
+              << " s, task_graph " << dGraph << " s" << (verify(graph, 2 * RUNS) ? "" : ", count error")
+              << std::endl;
+}
+
+void check_cycle()
+{
+    LONG nCount = 0;
+    task_graph graph;
+    task_graph::node_id a = graph.add_node(task_func(node_task, &nCount));
+    task_graph::node_id b = graph.add_node(task_func(node_task, &nCount));
+    graph.precede(a, b);
+    graph.precede(b, a);
+
+    thread_pool pool(1, 0);
+    std::cout << "cycle rejected: " << (!graph.run(pool) && nCount == 0 ? "yes" : "no") << std::endl;
+}
+
+int main()
+{
+    const char *modes[] = {"global queue", "work stealing"};
+    thread_pool::schedule_mode eModes[] = {thread_pool::GLOBAL_QUEUE, thread_pool::WORK_STEALING};
+    for (int i = 0; i < 2; ++i)
+    {
+        std::cout << modes[i] << ":" << std::endl;
+        bench_shape("wide", 8, 256, eModes[i]);
+        bench_shape("deep", 256, 8, eModes[i]);
+        bench_shape("chain", 512, 1, eModes[i]);
+    }
+    check_cycle();
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include "../../src/utils/thread/parallel_algorithm.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const size_t ELEMENTS = 100000000;
+
+// 元素取值，防止编译器把归约优化掉
+struct square
+{
+    double operator()(int v_nValue) const { return static_cast<double>(v_nValue) * v_nValue; }
+};
+
+void fill_random(std::vector<int> &v_vec)
+{
+    UINT32 uiSeed = 2463534242U;
+    for (size_t i = 0; i < v_vec.size(); ++i)
+    {
+        uiSeed ^= uiSeed << 13;
+        uiSeed ^= uiSeed >> 17;
+        uiSeed ^= uiSeed << 5;
+        v_vec[i] = static_cast<int>(uiSeed & 0x7FFFFFFF);
+    }
+}
+
+void bench_reduce(thread_pool &v_pool, const std::vector<int> &v_vec)
+{
+    calc_walltime ct;
+    long long llSerial = std::accumulate(v_vec.begin(), v_vec.end(), 0LL);
+    ct.end();
+    double dSerial = ct.run_time_in_second();
+
+    ct.reset();
+    long long llParallel = parallel_reduce(v_pool, v_vec.begin(), v_vec.end(), 0LL);
+    ct.end();
+    std::cout << "reduce:    std::accumulate " << dSerial << " s, parallel_reduce " << ct.run_time_in_second() << " s"
+              << (llSerial == llParallel ? "" : ", result mismatch") << std::endl;
+}
+
+void bench_transform(thread_pool &v_pool, const std::vector<int> &v_vec)
+{
+    std::vector<double> vecSerial(v_vec.size());
+    std::vector<double> vecParallel(v_vec.size());
+
+    calc_walltime ct;
+    std::transform(v_vec.begin(), v_vec.end(), vecSerial.begin(), square());
+    ct.end();
+    double dSerial = ct.run_time_in_second();
+    ct.reset();
+    parallel_transform(v_pool, v_vec.begin(), v_vec.end(), vecParallel.begin(), square());
+    ct.end();
+    std::cout << "transform: std::transform " << dSerial << " s, parallel_transform " << ct.run_time_in_second()
+              << " s" << (vecSerial == vecParallel ? "" : ", result mismatch") << std::endl;
+}
+
+// 用整数求前缀和，浮点加法顺序不同时末位可能不同，无法与串行结果直接比较
+void bench_scan(thread_pool &v_pool, const std::vector<int> &v_vec)
+{
+    std::vector<long long> vecInput(v_vec.begin(), v_vec.end());
+    std::vector<long long> vecSum(vecInput.size());
+    std::vector<long long> vecParallelSum(vecInput.size());
+
+    calc_walltime ct;
+    std::partial_sum(vecInput.begin(), vecInput.end(), vecSum.begin());
+    ct.end();
+    double dSerial = ct.run_time_in_second();
+    ct.reset();
+    parallel_scan(v_pool, vecInput.begin(), vecInput.end(), vecParallelSum.begin());
+    ct.end();
+    std::cout << "scan:      std::partial_sum " << dSerial << " s, parallel_scan " << ct.run_time_in_second() << " s"
+              << (vecSum == vecParallelSum ? "" : ", result mismatch") << std::endl;
+}
+
+void bench_sort(thread_pool &v_pool, const std::vector<int> &v_vec)
+{
+    std::vector<int> vecSerial(v_vec);
+    calc_walltime ct;
+    std::sort(vecSerial.begin(), vecSerial.end());
+    ct.end();
+    double dSerial = ct.run_time_in_second();
+
+    std::vector<int> vecParallel(v_vec);
+    ct.reset();
+    parallel_sort(v_pool, vecParallel.begin(), vecParallel.end());
+    ct.end();
+    std::cout << "sort:      std::sort " << dSerial << " s, parallel_sort " << ct.run_time_in_second() << " s"
+              << (vecSerial == vecParallel ? "" : ", result mismatch") << std::endl;
+}
+
+int main()
+{
+    thread_pool pool(processor_count() > 1 ? processor_count() - 1 : 1, 0, thread_pool::WORK_STEALING);
+    std::cout << ELEMENTS << " elements, " << pool.thread_count() << " workers + caller" << std::endl;
+
+    std::vector<int> vec(ELEMENTS);
+    fill_random(vec);
+    bench_reduce(pool, vec);
+    bench_transform(pool, vec);
+    bench_scan(pool, vec);
+    bench_sort(pool, vec);
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const LONG TASKS = 1000000;
+
+// 统计全局operator new的调用次数
+atomic<LONG> g_nAllocs;
+
+// operator new/delete成对使用malloc/free，gcc内联后误报不匹配
+#if defined(__GNUC__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+#if __cplusplus >= 201103L || defined(_MSC_VER)
+#define NEW_THROW_SPEC
+#else
+#define NEW_THROW_SPEC throw(std::bad_alloc)
+#endif
+
+void *operator new(size_t v_nSize) NEW_THROW_SPEC
+{
+    ++g_nAllocs;
+    void *p = std::malloc(v_nSize ? v_nSize : 1);
+    if (!p)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+void *operator new[](size_t v_nSize) NEW_THROW_SPEC { return operator new(v_nSize); }
+void operator delete(void *v_p) throw() { std::free(v_p); }
+void operator delete[](void *v_p) throw() { std::free(v_p); }
+#if __cplusplus >= 201402L
+// C++14起按大小释放的版本，不替换时-Wsized-deallocation会警告
+void operator delete(void *v_p, size_t) throw() { std::free(v_p); }
+void operator delete[](void *v_p, size_t) throw() { std::free(v_p); }
+#endif
+
+atomic<LONG> g_nExecuted;
+
+void count_task(void *) { ++g_nExecuted; }
+
+// 32字节的函数对象，存放在task内部
+struct small_functor
+{
+    LONG m_values[8];
+    void operator()() const { g_nExecuted += m_values[0]; }
+};
+
+// 超过task内部缓冲区的函数对象，从对象池分配
+struct large_functor
+{
+    LONG m_values[32];
+    void operator()() const { g_nExecuted += m_values[0]; }
+};
+
+template <typename P, typename T>
+void submit_all(P &v_pool, const T &v_task)
+{
+    for (LONG i = 0; i < TASKS; ++i)
+    {
+        v_pool.submit(v_task);
+    }
+    v_pool.wait();
+}
+
+template <typename P, typename T>
+void report(const char *v_pszPool, const char *v_pszTask, P &v_pool, const T &v_task)
+{
+    submit_all(v_pool, v_task); // 预热，队列、对象池和线程本地缓存达到稳定大小
+
+    g_nExecuted = 0;
+    LONG nAllocs = g_nAllocs.load();
+    calc_walltime ct;
+    submit_all(v_pool, v_task);
+    ct.end();
+    nAllocs = g_nAllocs.load() - nAllocs;
+
+    std::cout << "  " << v_pszPool << ", " << v_pszTask << ": " << static_cast<double>(nAllocs) / TASKS
+              << " allocs/task, " << TASKS / ct.run_time_in_second() / 1e6 << " M tasks/s"
+              << (g_nExecuted.load() == TASKS ? "" : ", count error") << std::endl;
+}
+
+template <typename P>
+void bench_pool(const char *v_pszPool, P &v_pool)
+{
+    small_functor small = {{1}};
+    large_functor large = {{1}};
+    report(v_pszPool, "task_func", v_pool, task_func(count_task));
+    report(v_pszPool, "small functor", v_pool, small);
+    report(v_pszPool, "large functor", v_pool, large);
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+    LONG nOne = 1;
+    report(v_pszPool, "lambda", v_pool, [nOne]() { g_nExecuted += nOne; });
+#endif
+}
+
+// 工作线程内提交的任务放入该线程的本地环形队列
+struct spawn_param
+{
+    thread_pool *m_pPool;
+    task m_task;
+};
+
+void spawn_task(void *v_pParam)
+{
+    spawn_param *pParam = static_cast<spawn_param *>(v_pParam);
+    for (LONG i = 0; i < TASKS; ++i)
+    {
+        pParam->m_pPool->submit(pParam->m_task);
+    }
+}
+
+void bench_local_deque()
+{
+    thread_pool pool(4, 0, thread_pool::WORK_STEALING);
+    small_functor small = {{1}};
+    spawn_param param = {&pool, task(small)};
+    for (int nRound = 0; nRound < 2; ++nRound)
+    {
+        g_nExecuted = 0;
+        LONG nAllocs = g_nAllocs.load();
+        calc_walltime ct;
+        pool.submit(task_func(spawn_task, &param));
+        pool.wait();
+        ct.end();
+        nAllocs = g_nAllocs.load() - nAllocs;
+        if (nRound > 0)
+        {
+            std::cout << "  work stealing local deque, small functor: " << static_cast<double>(nAllocs) / TASKS
+                      << " allocs/task, " << TASKS / ct.run_time_in_second() / 1e6 << " M tasks/s" << std::endl;
+        }
+    }
+}
+
+// 统计存活的函数对象，检查窃取时的复制以及任务执行后的析构
+atomic<LONG> g_nLiveFunctors;
+
+template <size_t N>
+struct tracked_functor
+{
+    tracked_functor()
+    {
+        std::fill(m_values, m_values + N, 1);
+        ++g_nLiveFunctors;
+    }
+    tracked_functor(const tracked_functor &v_other)
+    {
+        std::copy(v_other.m_values, v_other.m_values + N, m_values);
+        ++g_nLiveFunctors;
+    }
+    ~tracked_functor() { --g_nLiveFunctors; }
+    void operator()() const { ++g_nExecuted; }
+
+    LONG m_values[N];
+};
+
+const LONG STEAL_TASKS = 200000;
+
+template <typename F>
+void spawn_tracked(void *v_pParam)
+{
+    thread_pool *pPool = static_cast<thread_pool *>(v_pParam);
+    for (LONG i = 0; i < STEAL_TASKS; ++i)
+    {
+        pPool->submit(F());
+    }
+}
+
+// 每个工作线程向本地队列提交任务，同时被其他空闲线程窃取；wait()返回时所有函数对象都应已析构
+template <typename F>
+void stress_steal(const char *v_pszTask)
+{
+    const size_t THREADS = 4;
+    thread_pool pool(THREADS, 0, thread_pool::WORK_STEALING);
+    g_nExecuted = 0;
+    g_nLiveFunctors = 0;
+
+    std::vector<task_func> spawners(THREADS, task_func(spawn_tracked<F>, &pool));
+    pool.submit_bulk(&spawners[0], spawners.size());
+    pool.wait();
+
+    LONG nExpected = static_cast<LONG>(THREADS) * STEAL_TASKS;
+    std::cout << "  work stealing stress, " << v_pszTask << ": executed " << g_nExecuted.load() << "/" << nExpected
+              << ", live functors after wait " << g_nLiveFunctors.load()
+              << (g_nExecuted.load() == nExpected && g_nLiveFunctors.load() == 0 ? "" : " (ERROR)") << std::endl;
+}
+
+int main()
+{
+    std::cout << "sizeof(task) = " << sizeof(task) << ", inline size = " << task::INLINE_SIZE << std::endl;
+    {
+        thread_pool pool(4, 0);
+        bench_pool("message_queue", pool);
+    }
+    {
+        basic_thread_pool<mpmc_ring_queue> pool(4, 65536);
+        bench_pool("mpmc_ring_queue", pool);
+    }
+    bench_local_deque();
+    stress_steal<tracked_functor<4> >("small functor");
+    stress_steal<tracked_functor<32> >("large functor");
+    return 0;
+}
\ No newline at end of file
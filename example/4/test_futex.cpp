@@ -0,0 +1,159 @@
+#include <iostream>
+#include <list>
+#include <pthread.h>
+
+#include "../../src/utils/thread/condition_variable.hpp"
+#include "../../src/utils/thread/thread.hpp"
+#include "../../src/utils/smart_ptr/shared_ptr.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+// pthread互斥量，接口与mutex一致，作为对照组
+class pthread_mutex
+{
+public:
+    pthread_mutex() { pthread_mutex_init(&m_mutex, NULL); }
+    ~pthread_mutex() { pthread_mutex_destroy(&m_mutex); }
+    void lock() { pthread_mutex_lock(&m_mutex); }
+    void unlock() { pthread_mutex_unlock(&m_mutex); }
+    BOOL try_lock() { return pthread_mutex_trylock(&m_mutex) == 0; }
+
+    pthread_mutex_t m_mutex;
+};
+
+// pthread条件变量，接口与condition_variable一致，作为对照组
+class pthread_condition_variable
+{
+public:
+    pthread_condition_variable(pthread_mutex &v_mutex) : m_pMutex(&v_mutex) { pthread_cond_init(&m_cond, NULL); }
+    ~pthread_condition_variable() { pthread_cond_destroy(&m_cond); }
+    void wait(unique_lock<pthread_mutex> &) { pthread_cond_wait(&m_cond, &m_pMutex->m_mutex); }
+    void notify_one() { pthread_cond_signal(&m_cond); }
+
+private:
+    pthread_cond_t m_cond;
+    pthread_mutex *m_pMutex;
+};
+
+const int LOCK_THREADS = 4;
+const int LOCK_LOOPS = 2000000;
+const int PING_PONG_ROUNDS = 100000;
+
+template <class M>
+struct lock_thread : public thread
+{
+    lock_thread(M &m, long &n) : thread(TRUE), m(m), n(n) {}
+    void run()
+    {
+        for (int i = 0; i < LOCK_LOOPS; ++i)
+        {
+            unique_lock<M> lock(m);
+            ++n;
+        }
+    }
+    M &m;
+    long &n;
+};
+
+// 多线程争用同一把锁，每次临界区只做一次自增
+template <class M>
+double bench_lock()
+{
+    typedef shared_ptr<thread> thread_ptr;
+    M m;
+    long n = 0;
+    std::list<thread_ptr> threads;
+
+    calc_walltime ct;
+    for (int i = 0; i < LOCK_THREADS; ++i)
+    {
+        threads.push_back(thread_ptr(new lock_thread<M>(m, n)));
+        threads.back()->start();
+    }
+    for (std::list<thread_ptr>::iterator it = threads.begin(); it != threads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    if (n != (long)LOCK_THREADS * LOCK_LOOPS)
+    {
+        std::cout << "lock count error: " << n << std::endl;
+    }
+    return ct.run_time_in_second();
+}
+
+template <class M, class CV>
+struct ping_pong_state
+{
+    ping_pong_state() : cvPing(m), cvPong(m), nTurn(0) {}
+    M m;
+    CV cvPing;
+    CV cvPong;
+    int nTurn;
+};
+
+template <class M, class CV>
+struct pong_thread : public thread
+{
+    pong_thread(ping_pong_state<M, CV> &s) : thread(TRUE), s(s) {}
+    void run()
+    {
+        for (int i = 0; i < PING_PONG_ROUNDS; ++i)
+        {
+            unique_lock<M> lock(s.m);
+            while (s.nTurn != 1)
+            {
+                s.cvPing.wait(lock);
+            }
+            s.nTurn = 0;
+            s.cvPong.notify_one();
+        }
+    }
+    ping_pong_state<M, CV> &s;
+};
+
+// 两个线程轮流唤醒对方，返回一次唤醒的平均耗时，单位微秒
+template <class M, class CV>
+double bench_wakeup()
+{
+    ping_pong_state<M, CV> s;
+    pong_thread<M, CV> t(s);
+    t.start();
+
+    calc_walltime ct;
+    for (int i = 0; i < PING_PONG_ROUNDS; ++i)
+    {
+        unique_lock<M> lock(s.m);
+        s.nTurn = 1;
+        s.cvPing.notify_one();
+        while (s.nTurn != 0)
+        {
+            s.cvPong.wait(lock);
+        }
+    }
+    ct.end();
+    t.join();
+
+    return ct.run_time_in_second() * 1e6 / (PING_PONG_ROUNDS * 2);
+}
+
+// futex条件变量的构造函数不需要互斥量，这里适配对照组的构造方式
+struct futex_condition_variable : public condition_variable
+{
+    futex_condition_variable(mutex &) {}
+};
+
+int main()
+{
+    std::cout << "contended lock/unlock, " << LOCK_THREADS << " threads x " << LOCK_LOOPS << std::endl;
+    std::cout << "  futex mutex:   " << bench_lock<mutex>() << " s" << std::endl;
+    std::cout << "  pthread mutex: " << bench_lock<pthread_mutex>() << " s" << std::endl;
+
+    std::cout << "wakeup latency, " << PING_PONG_ROUNDS << " ping-pong rounds" << std::endl;
+    std::cout << "  futex condition_variable:   " << bench_wakeup<mutex, futex_condition_variable>() << " us"
+              << std::endl;
+    std::cout << "  pthread condition_variable: " << bench_wakeup<pthread_mutex, pthread_condition_variable>()
+              << " us" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const int PRODUCERS = 3;
+const int TASKS_PER_PRODUCER = 3000000;
+const LONG TOTAL_TASKS = (LONG)PRODUCERS * TASKS_PER_PRODUCER;
+
+void task1(void *param)
+{
+    atomic<LONG> *a = static_cast<atomic<LONG> *>(param);
+    ++(*a);
+}
+
+struct submit_task_thread : public thread
+{
+    submit_task_thread(thread_pool &pool, atomic<LONG> &a) : thread(TRUE), pool(pool), a(a) {}
+    void run()
+    {
+        for (int i = 0; i < TASKS_PER_PRODUCER; ++i)
+        {
+            pool.submit(task_func(task1, &a));
+        }
+    }
+    thread_pool &pool;
+    atomic<LONG> &a;
+};
+
+// 与example/1相同：3个外部线程各提交3M个小任务
+double bench_external(thread_pool::schedule_mode mode)
+{
+    typedef shared_ptr<thread> thread_ptr;
+    typedef std::list<thread_ptr> threads;
+
+    calc_walltime ct;
+    thread_pool pool(4, 0, mode);
+    atomic<LONG> count = 0;
+    threads listThreads;
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        listThreads.push_back(thread_ptr(new submit_task_thread(pool, count)));
+        listThreads.back()->start();
+    }
+    for (threads::iterator it = listThreads.begin(); it != listThreads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    pool.wait();
+    ct.end();
+
+    if (count != TOTAL_TASKS)
+    {
+        std::cout << "count error: " << count << std::endl;
+    }
+    return ct.run_time_in_second();
+}
+
+// 任务在工作线程内递归二分产生子任务，共TOTAL_TASKS个叶子任务；
+// 结点序号按完全二叉树编号，直接作为任务参数，避免为每个任务分配参数结构
+thread_pool *g_pool = NULL;
+atomic<LONG> g_count = 0;
+
+void split_task(void *param)
+{
+    size_t node = (size_t)param;
+    if (node >= (size_t)TOTAL_TASKS - 1)
+    {
+        ++g_count;
+        return;
+    }
+
+    g_pool->submit(task_func(split_task, (void *)(2 * node + 1)));
+    g_pool->submit(task_func(split_task, (void *)(2 * node + 2)));
+}
+
+double bench_recursive(thread_pool::schedule_mode mode)
+{
+    calc_walltime ct;
+    thread_pool pool(4, 0, mode);
+    g_pool = &pool;
+    g_count = 0;
+
+    pool.submit(task_func(split_task, (void *)0));
+    while (g_count != TOTAL_TASKS)
+    {
+        this_thread::sleep_for(1);
+    }
+    pool.wait();
+    ct.end();
+
+    return ct.run_time_in_second();
+}
+
+int main()
+{
+    std::cout << "external producers, " << PRODUCERS << " x " << TASKS_PER_PRODUCER << " tasks" << std::endl;
+    std::cout << "  global queue:  " << bench_external(thread_pool::GLOBAL_QUEUE) << " s" << std::endl;
+    std::cout << "  work stealing: " << bench_external(thread_pool::WORK_STEALING) << " s" << std::endl;
+
+    std::cout << "tasks spawned by workers, " << TOTAL_TASKS << " leaf tasks" << std::endl;
+    std::cout << "  global queue:  " << bench_recursive(thread_pool::GLOBAL_QUEUE) << " s" << std::endl;
+    std::cout << "  work stealing: " << bench_recursive(thread_pool::WORK_STEALING) << " s" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
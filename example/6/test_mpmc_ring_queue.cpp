@@ -0,0 +1,148 @@
+#include <iostream>
+#include <list>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const int PRODUCERS = 3;
+const int CONSUMERS = 3;
+const int MSGS_PER_PRODUCER = 1000000;
+
+typedef shared_ptr<thread> thread_ptr;
+typedef std::list<thread_ptr> threads;
+
+template <class Q>
+struct producer_thread : public thread
+{
+    producer_thread(Q &q) : thread(TRUE), q(q) {}
+    void run()
+    {
+        for (int i = 1; i <= MSGS_PER_PRODUCER; ++i)
+        {
+            q.push_back(i);
+        }
+    }
+    Q &q;
+};
+
+template <class Q>
+struct consumer_thread : public thread
+{
+    consumer_thread(Q &q, int n) : thread(TRUE), q(q), n(n), sum(0) {}
+    void run()
+    {
+        int v = 0;
+        for (int i = 0; i < n; ++i)
+        {
+            q.pop(v);
+            sum += v;
+        }
+    }
+    Q &q;
+    int n;
+    long long sum;
+};
+
+// 多生产者多消费者收发，校验总和
+template <class Q>
+double bench_queue(size_t capacity)
+{
+    Q q(capacity);
+    threads listThreads;
+    std::list<consumer_thread<Q> *> consumers;
+
+    calc_walltime ct;
+    for (int i = 0; i < CONSUMERS; ++i)
+    {
+        int n = PRODUCERS * MSGS_PER_PRODUCER / CONSUMERS;
+        consumer_thread<Q> *c = new consumer_thread<Q>(q, n);
+        consumers.push_back(c);
+        listThreads.push_back(thread_ptr(c));
+    }
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        listThreads.push_back(thread_ptr(new producer_thread<Q>(q)));
+    }
+    for (threads::iterator it = listThreads.begin(); it != listThreads.end(); ++it)
+    {
+        (*it)->start();
+    }
+    for (threads::iterator it = listThreads.begin(); it != listThreads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    ct.end();
+
+    long long sum = 0;
+    for (typename std::list<consumer_thread<Q> *>::iterator it = consumers.begin(); it != consumers.end(); ++it)
+    {
+        sum += (*it)->sum;
+    }
+    if (sum != (long long)PRODUCERS * MSGS_PER_PRODUCER * (MSGS_PER_PRODUCER + 1) / 2)
+    {
+        std::cout << "sum error: " << sum << std::endl;
+    }
+    return ct.run_time_in_second();
+}
+
+void task1(void *param)
+{
+    atomic<LONG> *a = static_cast<atomic<LONG> *>(param);
+    ++(*a);
+}
+
+template <class P>
+struct submit_task_thread : public thread
+{
+    submit_task_thread(P &pool, atomic<LONG> &a) : thread(TRUE), pool(pool), a(a) {}
+    void run()
+    {
+        for (int i = 0; i < 3000000; ++i)
+        {
+            pool.submit(task_func(task1, &a));
+        }
+    }
+    P &pool;
+    atomic<LONG> &a;
+};
+
+// example/1的负载，线程池分别使用两种任务队列
+template <class P>
+double bench_pool(size_t capacity)
+{
+    calc_walltime ct;
+    P pool(4, capacity);
+    atomic<LONG> count = 0;
+    threads listThreads;
+    for (int i = 0; i < 3; ++i)
+    {
+        listThreads.push_back(thread_ptr(new submit_task_thread<P>(pool, count)));
+        listThreads.back()->start();
+    }
+    for (threads::iterator it = listThreads.begin(); it != listThreads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    pool.wait();
+    ct.end();
+
+    if (count != 9000000)
+    {
+        std::cout << "count error: " << count << std::endl;
+    }
+    return ct.run_time_in_second();
+}
+
+int main()
+{
+    std::cout << PRODUCERS << " producers x " << CONSUMERS << " consumers, " << MSGS_PER_PRODUCER
+              << " msgs per producer, capacity 1024" << std::endl;
+    std::cout << "  message_queue:   " << bench_queue<message_queue<int> >(1024) << " s" << std::endl;
+    std::cout << "  mpmc_ring_queue: " << bench_queue<mpmc_ring_queue<int> >(1024) << " s" << std::endl;
+
+    std::cout << "thread_pool, 3 x 3000000 tasks, queue capacity 65536" << std::endl;
+    std::cout << "  message_queue:   " << bench_pool<thread_pool>(65536) << " s" << std::endl;
+    std::cout << "  mpmc_ring_queue: " << bench_pool<basic_thread_pool<mpmc_ring_queue> >(65536) << " s" << std::endl;
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <list>
+#include <vector>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const int PRODUCERS = 3;
+const size_t TASKS_PER_PRODUCER = 3000000;
+
+void task1(void *param)
+{
+    atomic<LONG> *a = static_cast<atomic<LONG> *>(param);
+    ++(*a);
+}
+
+// 每次凑够batch个任务后批量提交，batch为1时使用submit()
+struct submit_task_thread : public thread
+{
+    submit_task_thread(thread_pool &pool, atomic<LONG> &a, size_t batch)
+        : thread(TRUE), pool(pool), tasks(batch, task_func(task1, &a))
+    {
+    }
+    void run()
+    {
+        size_t batch = tasks.size();
+        if (batch == 1)
+        {
+            for (size_t i = 0; i < TASKS_PER_PRODUCER; ++i)
+            {
+                pool.submit(tasks[0]);
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < TASKS_PER_PRODUCER; i += batch)
+        {
+            size_t n = TASKS_PER_PRODUCER - i < batch ? TASKS_PER_PRODUCER - i : batch;
+            pool.submit_bulk(&tasks[0], n);
+        }
+    }
+    thread_pool &pool;
+    std::vector<task_func> tasks;
+};
+
+// example/1的负载，返回每秒执行的任务数
+double bench(size_t batch)
+{
+    typedef shared_ptr<thread> thread_ptr;
+    typedef std::list<thread_ptr> threads;
+
+    calc_walltime ct;
+    thread_pool pool(4, 0);
+    pool.set_pop_batch(batch);
+    atomic<LONG> count = 0;
+    threads listThreads;
+    for (int i = 0; i < PRODUCERS; ++i)
+    {
+        listThreads.push_back(thread_ptr(new submit_task_thread(pool, count, batch)));
+        listThreads.back()->start();
+    }
+    for (threads::iterator it = listThreads.begin(); it != listThreads.end(); ++it)
+    {
+        (*it)->join();
+    }
+    pool.wait();
+    ct.end();
+
+    if (count != (LONG)(PRODUCERS * TASKS_PER_PRODUCER))
+    {
+        std::cout << "count error: " << count << std::endl;
+    }
+    return PRODUCERS * TASKS_PER_PRODUCER / ct.run_time_in_second();
+}
+
+int main()
+{
+    std::cout << PRODUCERS << " producers x " << TASKS_PER_PRODUCER << " tasks, 4 workers" << std::endl;
+
+    size_t batches[] = {1, 16, 256};
+    for (size_t i = 0; i < sizeof(batches) / sizeof(batches[0]); ++i)
+    {
+        std::cout << "  batch " << batches[i] << ": " << (long long)bench(batches[i]) << " tasks/s" << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
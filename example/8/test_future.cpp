@@ -0,0 +1,113 @@
+#include <iostream>
+#include <vector>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const int ROUNDS = 2000;
+const int FANOUT = 64;
+
+int square(int x)
+{
+    return x * x;
+}
+
+// 对照组：每个任务在堆上分配带互斥量和条件变量的结果
+struct heap_result
+{
+    heap_result(int x) : x(x), value(0), ready(FALSE) {}
+    int get()
+    {
+        unique_lock<mutex> lock(m);
+        while (!ready)
+        {
+            cv.wait(lock);
+        }
+        return value;
+    }
+    int x;
+    int value;
+    BOOL ready;
+    mutex m;
+    condition_variable cv;
+};
+
+void heap_task(void *param)
+{
+    heap_result *r = static_cast<heap_result *>(param);
+    unique_lock<mutex> lock(r->m);
+    r->value = square(r->x);
+    r->ready = TRUE;
+    r->cv.notify_one();
+}
+
+double bench_heap(thread_pool &pool, long long &sum)
+{
+    calc_walltime ct;
+    std::vector<heap_result *> results(FANOUT);
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        for (int i = 0; i < FANOUT; ++i)
+        {
+            results[i] = new heap_result(i);
+            pool.submit(task_func(heap_task, results[i]));
+        }
+        for (int i = 0; i < FANOUT; ++i)
+        {
+            sum += results[i]->get();
+            delete results[i];
+        }
+    }
+    ct.end();
+    return ct.run_time_in_second();
+}
+
+double bench_future(thread_pool &pool, long long &sum)
+{
+    calc_walltime ct;
+    std::vector<future<int> > results(FANOUT);
+    for (int r = 0; r < ROUNDS; ++r)
+    {
+        for (int i = 0; i < FANOUT; ++i)
+        {
+            results[i] = pool.async(square, i);
+        }
+        when_all(results.begin(), results.end()).wait();
+        for (int i = 0; i < FANOUT; ++i)
+        {
+            sum += results[i].get();
+        }
+    }
+    ct.end();
+    return ct.run_time_in_second();
+}
+
+int main()
+{
+    thread_pool pool(4, 0);
+    long long expected = 0;
+    for (int i = 0; i < FANOUT; ++i)
+    {
+        expected += square(i);
+    }
+    expected *= ROUNDS;
+
+    std::cout << ROUNDS << " rounds x " << FANOUT << " tasks, 4 workers" << std::endl;
+
+    long long sum = 0;
+    std::cout << "  heap mutex/cv:     " << bench_heap(pool, sum) << " s" << std::endl;
+    if (sum != expected)
+    {
+        std::cout << "sum error: " << sum << std::endl;
+    }
+
+    sum = 0;
+    std::cout << "  async + when_all:  " << bench_future(pool, sum) << " s" << std::endl;
+    if (sum != expected)
+    {
+        std::cout << "sum error: " << sum << std::endl;
+    }
+
+    pool.wait();
+    return 0;
+}
\ No newline at end of file
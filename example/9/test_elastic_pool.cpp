@@ -0,0 +1,61 @@
+#include <iostream>
+
+#include "../../src/utils/thread/thread_pool.hpp"
+#include "../../src/utils/calc_runtime.hpp"
+
+const int TASKS = 400;
+const DWORD TASK_MS = 5;
+
+// 模拟阻塞IO的任务
+void blocking_task(void *param)
+{
+    this_thread::sleep_for(TASK_MS);
+    ++(*static_cast<atomic<LONG> *>(param));
+}
+
+double bench(thread_pool &pool, atomic<LONG> &count, size_t &peak)
+{
+    calc_walltime ct;
+    for (int i = 0; i < TASKS; ++i)
+    {
+        pool.submit(task_func(blocking_task, &count));
+    }
+    peak = 0;
+    while (count < (LONG)TASKS)
+    {
+        if (pool.thread_count() > peak)
+        {
+            peak = pool.thread_count();
+        }
+        this_thread::sleep_for(1);
+    }
+    ct.end();
+    return ct.run_time_in_second();
+}
+
+int main()
+{
+    std::cout << TASKS << " blocking tasks x " << TASK_MS << " ms" << std::endl;
+
+    size_t peak = 0;
+    {
+        atomic<LONG> count = 0;
+        thread_pool pool(2, 0);
+        double t = bench(pool, count, peak);
+        std::cout << "  fixed 2 threads:        " << t << " s, peak " << peak << " threads" << std::endl;
+    }
+
+    {
+        atomic<LONG> count = 0;
+        thread_pool pool(2, 0);
+        pool.set_elastic(2, 32, 200);
+        double t = bench(pool, count, peak);
+        std::cout << "  elastic 2..32 threads:  " << t << " s, peak " << peak << " threads" << std::endl;
+
+        // 空闲超过保活时间后退回最少线程数
+        this_thread::sleep_for(1000);
+        std::cout << "  after 1s idle:          " << pool.thread_count() << " threads" << std::endl;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -2,6 +2,9 @@
 #define CALU_RUNTIME_H
 
 #include <ctime>
+#if defined(_WIN32)
+#include <windows.h>
+#endif
 
 class calc_runtime
 {
@@ -34,4 +37,46 @@ private:
     clock_t m_tRunTime;
 };
 
+/**
+ * @brief 按墙上时间计时，多线程场景下clock()统计的是进程CPU时间，需用此类
+ */
+class calc_walltime
+{
+public:
+    calc_walltime() { start(); }
+    virtual ~calc_walltime() {}
+
+public:
+    void start() { reset(); }
+    void end() { m_dEnd = now(); }
+    void reset()
+    {
+        m_dStart = now();
+        m_dEnd = m_dStart;
+    }
+
+    double run_time_in_second() const { return m_dEnd - m_dStart; }
+
+    /**
+     * @brief 单调时钟的当前时间，单位秒
+     */
+    static double now()
+    {
+#if defined(_WIN32)
+        LARGE_INTEGER liFreq, liNow;
+        ::QueryPerformanceFrequency(&liFreq);
+        ::QueryPerformanceCounter(&liNow);
+        return (double)liNow.QuadPart / (double)liFreq.QuadPart;
+#else
+        timespec ts;
+        ::clock_gettime(CLOCK_MONOTONIC, &ts);
+        return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+    }
+
+private:
+    double m_dStart;
+    double m_dEnd;
+};
+
 #endif // CALU_RUNTIME_H
\ No newline at end of file
@@ -0,0 +1,129 @@
+﻿/**
+ * @file adaptive_mutex.hpp
+ * @brief 自适应互斥量，加锁失败时先指数退避自旋，自旋次数按历史自动校准，仍未获得锁再按地址挂起
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef ADAPTIVE_MUTEX_HPP
+#define ADAPTIVE_MUTEX_HPP
+
+#include "atomic.hpp"
+#include "futex.hpp"
+
+/**
+ * @brief 自适应互斥量，可与unique_lock<T>配合使用
+ * @details 状态字与linux下的mutex相同：0 未锁定，1 已锁定且无等待者，2 已锁定且可能有等待者。
+ *          每次自旋的预算为历史上自旋成功所用次数估计值的2倍加一个下限，自旋成功时估计值向本次用量靠拢，
+ *          自旋失败时估计值衰减。临界区很短时自旋次数收敛到实际需要的量，临界区较长时很快改为直接挂起
+ * @note 自旋次数以pause指令数计，单核机器上默认不自旋
+ */
+class adaptive_mutex
+{
+    typedef atomic_detail::ops<LONG> ops;
+
+public:
+    enum
+    {
+        DEFAULT_MAX_SPIN = 2000, // 多核时默认的自旋上限
+        MIN_SPIN = 16,           // 每次自旋预算的下限，估计值衰减到0后仍保留少量自旋用于重新校准
+        MAX_BACKOFF = 16         // 两次检查锁之间的最大pause指令数
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nMaxSpin 自旋上限，单位为pause指令数，0表示不自旋，-1表示按处理器个数自动选择
+     */
+    adaptive_mutex(int v_nMaxSpin = -1) : m_nState(0), m_nSpinEstimate(MIN_SPIN)
+    {
+        set_max_spin(v_nMaxSpin);
+    }
+    ~adaptive_mutex() {}
+
+public:
+    void lock()
+    {
+        if (!try_lock())
+        {
+            lock_slow();
+        }
+    }
+
+    void unlock()
+    {
+        if (ops::exchange(&m_nState, 0, memory_order_release) == 2)
+        {
+            futex::wake(&m_nState, 1);
+        }
+    }
+
+    BOOL try_lock()
+    {
+        LONG nExpected = 0;
+        return ops::compare_exchange(&m_nState, nExpected, 1, false, memory_order_acquire);
+    }
+
+public:
+    void set_max_spin(int v_nMaxSpin)
+    {
+        m_nMaxSpin.store(v_nMaxSpin >= 0 ? v_nMaxSpin : (processor_count() > 1 ? DEFAULT_MAX_SPIN : 0),
+                         memory_order_relaxed);
+    }
+    int max_spin() const { return m_nMaxSpin.load(memory_order_relaxed); }
+
+    /**
+     * @brief 当前的自旋次数估计值
+     */
+    int spin_estimate() const { return m_nSpinEstimate.load(memory_order_relaxed); }
+
+private:
+    void lock_slow()
+    {
+        int nMaxSpin = m_nMaxSpin.load(memory_order_relaxed);
+        int nEstimate = m_nSpinEstimate.load(memory_order_relaxed);
+        int nBudget = nEstimate * 2 + MIN_SPIN < nMaxSpin ? nEstimate * 2 + MIN_SPIN : nMaxSpin;
+
+        // 指数退避自旋，只在看到未锁定时才尝试抢锁，避免反复写缓存行
+        for (int nSpent = 0, nPause = 1; nSpent < nBudget;)
+        {
+            for (int i = 0; i < nPause; ++i)
+            {
+                cpu_relax();
+            }
+            nSpent += nPause;
+            if (nPause < MAX_BACKOFF)
+            {
+                nPause <<= 1;
+            }
+
+            if (ops::load(&m_nState, memory_order_relaxed) == 0 && try_lock())
+            {
+                // 估计值只是统计量，多个线程并发更新时丢失个别更新无关紧要
+                m_nSpinEstimate.store(nEstimate + (nSpent - nEstimate) / 8, memory_order_relaxed);
+                return;
+            }
+        }
+        if (nBudget > 0)
+        {
+            m_nSpinEstimate.store(nEstimate - nEstimate / 8, memory_order_relaxed);
+        }
+
+        // 标记为有等待者后挂起，被唤醒后同样以2抢锁，保证解锁方不会漏掉其他等待者
+        while (ops::exchange(&m_nState, 2, memory_order_acquire) != 0)
+        {
+            futex::wait(&m_nState, 2);
+        }
+    }
+
+private:
+    adaptive_mutex(const adaptive_mutex &);
+    adaptive_mutex &operator=(const adaptive_mutex &);
+
+private:
+    volatile LONG m_nState;      // 锁状态，同时作为futex等待地址
+    atomic<int> m_nSpinEstimate; // 自旋成功所需次数的估计值
+    atomic<int> m_nMaxSpin;      // 自旋上限
+};
+
+#endif // ADAPTIVE_MUTEX_HPP
\ No newline at end of file
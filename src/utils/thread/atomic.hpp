@@ -1,6 +1,8 @@
 ﻿/**
  * @file atomic.hpp
- * @brief C++98 windows下的原子模板类实现
+ * @brief C++98 原子模板类实现，支持8/16/32/64位整数和指针，支持内存序
+ * @details linux下基于GCC的__atomic内建函数；windows下基于_Interlocked系列内建函数，
+ *          x86/x64上加锁指令本身是完整屏障，各内存序都按比较交换实现，只有普通读写区分内存序
  * @author zhengw
  * @date 2024-06-07
  */
@@ -8,87 +10,513 @@
 #ifndef ATOMIC_HPP
 #define ATOMIC_HPP
 
-#include <windows.h>
+#include "platform.hpp"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 /**
- * @brief 原子模板类，采用windows API实现原子操作，线程安全
- * @tparam T 原子操作的数据类型，只能是LONG，不支持LONG64是为了兼容XP系统
+ * @brief 内存序，含义与C++11的std::memory_order一致
  */
-template <typename T> class atomic
+enum memory_order
 {
-public:
-    atomic(T v_value = 0) : m_value(v_value) {}
+    memory_order_relaxed, // 只保证本身的原子性
+    memory_order_consume, // 按memory_order_acquire处理
+    memory_order_acquire, // 之后的读写不会重排到本操作之前
+    memory_order_release, // 之前的读写不会重排到本操作之后
+    memory_order_acq_rel, // 同时具有acquire和release语义
+    memory_order_seq_cst  // 顺序一致
+};
 
-    // 取值
-    operator T() const { return m_value; }
+namespace atomic_detail
+{
+/**
+ * @brief 读操作不能带release语义，去掉release部分
+ */
+inline memory_order load_order(memory_order v_order)
+{
+    if (v_order == memory_order_release)
+    {
+        return memory_order_relaxed;
+    }
+    if (v_order == memory_order_acq_rel)
+    {
+        return memory_order_acquire;
+    }
+    return v_order;
+}
 
-    // 重载++运算符
-    atomic& operator++()
+/**
+ * @brief 写操作不能带acquire语义，去掉acquire部分
+ */
+inline memory_order store_order(memory_order v_order)
+{
+    if (v_order == memory_order_consume || v_order == memory_order_acquire)
     {
-        InterlockedIncrement(&m_value);
-        return *this;
+        return memory_order_relaxed;
     }
-    atomic operator++(int)
+    if (v_order == memory_order_acq_rel)
     {
-        atomic temp = *this;
-        InterlockedIncrement(&m_value);
-        return temp;
+        return memory_order_release;
     }
+    return v_order;
+}
 
-    // 重载--运算符
-    atomic& operator--()
+#if defined(__GNUC__)
+/**
+ * @brief 转换为GCC的内存序常量
+ * @note 内存序参数在内联后是编译期常量，GCC按常量生成指令；未开启优化时GCC按__ATOMIC_SEQ_CST处理
+ */
+inline int to_gcc(memory_order v_order)
+{
+    switch (v_order)
     {
-        InterlockedDecrement(&m_value);
-        return *this;
+    case memory_order_relaxed:
+        return __ATOMIC_RELAXED;
+    case memory_order_consume:
+        return __ATOMIC_CONSUME;
+    case memory_order_acquire:
+        return __ATOMIC_ACQUIRE;
+    case memory_order_release:
+        return __ATOMIC_RELEASE;
+    case memory_order_acq_rel:
+        return __ATOMIC_ACQ_REL;
+    default:
+        return __ATOMIC_SEQ_CST;
     }
-    atomic operator--(int)
+}
+
+/**
+ * @brief 原子操作，T为1/2/4/8字节的整数或指针
+ */
+template <typename T> struct ops
+{
+    static T load(const volatile T *v_p, memory_order v_order)
+    {
+        return __atomic_load_n(v_p, to_gcc(load_order(v_order)));
+    }
+    static void store(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        __atomic_store_n(v_p, v_value, to_gcc(store_order(v_order)));
+    }
+    static T exchange(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        return __atomic_exchange_n(v_p, v_value, to_gcc(v_order));
+    }
+    static bool compare_exchange(volatile T *v_p, T &v_expected, T v_desired, bool v_bWeak, memory_order v_order)
+    {
+        return __atomic_compare_exchange_n(v_p, &v_expected, v_desired, v_bWeak, to_gcc(v_order),
+                                           to_gcc(load_order(v_order)));
+    }
+    template <typename D>
+    static T fetch_add(volatile T *v_p, D v_delta, memory_order v_order)
     {
-        atomic temp = *this;
-        InterlockedDecrement(&m_value);
-        return temp;
+        return __atomic_fetch_add(v_p, v_delta, to_gcc(v_order));
     }
+    template <typename D>
+    static T fetch_sub(volatile T *v_p, D v_delta, memory_order v_order)
+    {
+        return __atomic_fetch_sub(v_p, v_delta, to_gcc(v_order));
+    }
+    static T fetch_and(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        return __atomic_fetch_and(v_p, v_value, to_gcc(v_order));
+    }
+    static T fetch_or(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        return __atomic_fetch_or(v_p, v_value, to_gcc(v_order));
+    }
+    static T fetch_xor(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        return __atomic_fetch_xor(v_p, v_value, to_gcc(v_order));
+    }
+};
 
-    // 重载+=运算符
-    atomic& operator+=(T v_value)
+#else
+/**
+ * @brief 按字节数选择_InterlockedCompareExchange内建函数
+ */
+template <size_t N> struct interlocked;
+template <> struct interlocked<1>
+{
+    typedef char type;
+    static type cas(volatile type *v_p, type v_desired, type v_expected)
     {
-        InterlockedExchangeAdd(&m_value, v_value);
-        return *this;
+        return _InterlockedCompareExchange8(v_p, v_desired, v_expected);
+    }
+};
+template <> struct interlocked<2>
+{
+    typedef short type;
+    static type cas(volatile type *v_p, type v_desired, type v_expected)
+    {
+        return _InterlockedCompareExchange16(v_p, v_desired, v_expected);
+    }
+};
+template <> struct interlocked<4>
+{
+    typedef long type;
+    static type cas(volatile type *v_p, type v_desired, type v_expected)
+    {
+        return _InterlockedCompareExchange(v_p, v_desired, v_expected);
+    }
+};
+template <> struct interlocked<8>
+{
+    typedef __int64 type;
+    static type cas(volatile type *v_p, type v_desired, type v_expected)
+    {
+        return _InterlockedCompareExchange64(v_p, v_desired, v_expected);
     }
+};
 
-    // 重载-=运算符
-    atomic& operator-=(T v_value)
+/**
+ * @brief 按位转换相同大小的类型，用于整数与指针之间
+ */
+template <typename To, typename From> To bit_cast(From v_from)
+{
+    union
     {
-        InterlockedExchangeAdd(&m_value, -v_value);
-        return *this;
+        From m_from;
+        To m_to;
+    } u;
+    u.m_from = v_from;
+    return u.m_to;
+}
+
+/**
+ * @brief 原子操作，T为1/2/4/8字节的整数或指针
+ * @note 读写不超过指针宽度时普通读写本身是原子的，x86上普通读带acquire语义、普通写带release语义，
+ *       只需阻止编译器重排；顺序一致的写以及32位系统上的64位读写使用比较交换
+ */
+template <typename T> struct ops
+{
+    typedef interlocked<sizeof(T)> impl;
+    typedef typename impl::type raw;
+
+    static T load(const volatile T *v_p, memory_order v_order)
+    {
+        (void)v_order;
+        if (sizeof(T) > sizeof(void *))
+        {
+            volatile raw *p = const_cast<volatile raw *>(reinterpret_cast<const volatile raw *>(v_p));
+            return bit_cast<T>(impl::cas(p, 0, 0));
+        }
+        T value = *v_p;
+        _ReadWriteBarrier();
+        return value;
+    }
+    static void store(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        if (sizeof(T) > sizeof(void *) || store_order(v_order) == memory_order_seq_cst)
+        {
+            exchange(v_p, v_value, v_order);
+            return;
+        }
+        _ReadWriteBarrier();
+        *v_p = v_value;
+    }
+    static T exchange(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        T old = load(v_p, memory_order_relaxed);
+        while (!compare_exchange(v_p, old, v_value, false, v_order))
+        {
+        }
+        return old;
+    }
+    static bool compare_exchange(volatile T *v_p, T &v_expected, T v_desired, bool v_bWeak, memory_order v_order)
+    {
+        (void)v_bWeak;
+        (void)v_order;
+        raw expected = bit_cast<raw>(v_expected);
+        raw old = impl::cas(reinterpret_cast<volatile raw *>(v_p), bit_cast<raw>(v_desired), expected);
+        if (old == expected)
+        {
+            return true;
+        }
+        v_expected = bit_cast<T>(old);
+        return false;
+    }
+    template <typename D>
+    static T fetch_add(volatile T *v_p, D v_delta, memory_order v_order)
+    {
+        T old = load(v_p, memory_order_relaxed);
+        while (!compare_exchange(v_p, old, static_cast<T>(old + v_delta), false, v_order))
+        {
+        }
+        return old;
     }
+    template <typename D>
+    static T fetch_sub(volatile T *v_p, D v_delta, memory_order v_order)
+    {
+        T old = load(v_p, memory_order_relaxed);
+        while (!compare_exchange(v_p, old, static_cast<T>(old - v_delta), false, v_order))
+        {
+        }
+        return old;
+    }
+    static T fetch_and(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        T old = load(v_p, memory_order_relaxed);
+        while (!compare_exchange(v_p, old, static_cast<T>(old & v_value), false, v_order))
+        {
+        }
+        return old;
+    }
+    static T fetch_or(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        T old = load(v_p, memory_order_relaxed);
+        while (!compare_exchange(v_p, old, static_cast<T>(old | v_value), false, v_order))
+        {
+        }
+        return old;
+    }
+    static T fetch_xor(volatile T *v_p, T v_value, memory_order v_order)
+    {
+        T old = load(v_p, memory_order_relaxed);
+        while (!compare_exchange(v_p, old, static_cast<T>(old ^ v_value), false, v_order))
+        {
+        }
+        return old;
+    }
+};
+#endif
+} // namespace atomic_detail
 
-    // 重载=运算符
-    atomic& operator=(T v_value)
+/**
+ * @brief 原子类型的公共部分：读、写、交换、比较交换
+ * @tparam T 1/2/4/8字节的整数或指针
+ */
+template <typename T> class atomic_base
+{
+    typedef atomic_detail::ops<T> ops;
+
+public:
+    atomic_base(T v_value) : m_value(v_value) {}
+
+public:
+    T load(memory_order v_order = memory_order_seq_cst) const { return ops::load(&m_value, v_order); }
+    void store(T v_value, memory_order v_order = memory_order_seq_cst) { ops::store(&m_value, v_value, v_order); }
+
+    /**
+     * @brief 替换为新值
+     * @return T 原值
+     */
+    T exchange(T v_value, memory_order v_order = memory_order_seq_cst)
     {
-        InterlockedExchange(&m_value, v_value);
-        return *this;
+        return ops::exchange(&m_value, v_value, v_order);
+    }
+
+    /**
+     * @brief 比较并交换，当前值等于v_expected时替换为v_desired
+     * @param [in,out] v_expected 期望值，失败时返回当前值
+     * @param [in] v_desired 新值
+     * @param [in] v_order 成功时的内存序，失败时的内存序由其去掉release部分得到
+     * @return bool 是否替换成功
+     */
+    bool compare_exchange_strong(T &v_expected, T v_desired, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::compare_exchange(&m_value, v_expected, v_desired, false, v_order);
     }
 
+    /**
+     * @brief 比较并交换，当前值等于v_expected时也可能失败，用于循环中，在LL/SC架构上更快
+     */
+    bool compare_exchange_weak(T &v_expected, T v_desired, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::compare_exchange(&m_value, v_expected, v_desired, true, v_order);
+    }
+
+    // 取值
+    operator T() const { return load(); }
+
     // 重载==运算符
-    bool operator==(T v_value) const { return m_value == v_value; }
+    bool operator==(T v_value) const { return load() == v_value; }
 
     // 重载!=运算符
-    bool operator!=(T v_value) const { return m_value != v_value; }
+    bool operator!=(T v_value) const { return load() != v_value; }
 
     // 重载<运算符
-    bool operator<(T v_value) const { return m_value < v_value; }
+    bool operator<(T v_value) const { return load() < v_value; }
 
     // 重载<=运算符
-    bool operator<=(T v_value) const { return m_value <= v_value; }
+    bool operator<=(T v_value) const { return load() <= v_value; }
 
     // 重载>运算符
-    bool operator>(T v_value) const { return m_value > v_value; }
+    bool operator>(T v_value) const { return load() > v_value; }
 
     // 重载>=运算符
-    bool operator>=(T v_value) const { return m_value >= v_value; }
+    bool operator>=(T v_value) const { return load() >= v_value; }
+
+protected:
+#if defined(__GNUC__)
+    volatile T m_value __attribute__((aligned(sizeof(T)))); // 32位系统上64位整数也需按8字节对齐
+#else
+    volatile T m_value;
+#endif
+};
+
+/**
+ * @brief 原子模板类，线程安全
+ * @note 自增、自减及复合赋值运算符返回运算后的值，与C++11一致，可直接用于判断引用计数是否归零
+ * @tparam T 原子操作的数据类型，1/2/4/8字节的整数
+ */
+template <typename T> class atomic : public atomic_base<T>
+{
+    typedef atomic_detail::ops<T> ops;
+
+public:
+    atomic(T v_value = 0) : atomic_base<T>(v_value) {}
+
+public:
+    /**
+     * @brief 原子加
+     * @return T 原值
+     */
+    T fetch_add(T v_value, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_add(&this->m_value, v_value, v_order);
+    }
+    T fetch_sub(T v_value, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_sub(&this->m_value, v_value, v_order);
+    }
+    T fetch_and(T v_value, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_and(&this->m_value, v_value, v_order);
+    }
+    T fetch_or(T v_value, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_or(&this->m_value, v_value, v_order);
+    }
+    T fetch_xor(T v_value, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_xor(&this->m_value, v_value, v_order);
+    }
+
+    // 重载++运算符
+    T operator++() { return static_cast<T>(fetch_add(1) + 1); }
+    T operator++(int) { return fetch_add(1); }
+
+    // 重载--运算符
+    T operator--() { return static_cast<T>(fetch_sub(1) - 1); }
+    T operator--(int) { return fetch_sub(1); }
+
+    // 重载复合赋值运算符
+    T operator+=(T v_value) { return static_cast<T>(fetch_add(v_value) + v_value); }
+    T operator-=(T v_value) { return static_cast<T>(fetch_sub(v_value) - v_value); }
+    T operator&=(T v_value) { return static_cast<T>(fetch_and(v_value) & v_value); }
+    T operator|=(T v_value) { return static_cast<T>(fetch_or(v_value) | v_value); }
+    T operator^=(T v_value) { return static_cast<T>(fetch_xor(v_value) ^ v_value); }
+
+    // 重载=运算符
+    atomic &operator=(T v_value)
+    {
+        this->store(v_value);
+        return *this;
+    }
+};
+
+/**
+ * @brief 指针的原子模板类，加减按元素大小偏移
+ * @tparam T 指针指向的类型
+ */
+template <typename T> class atomic<T *> : public atomic_base<T *>
+{
+    typedef atomic_detail::ops<T *> ops;
+
+public:
+    atomic(T *v_value = NULL) : atomic_base<T *>(v_value) {}
+
+public:
+    /**
+     * @brief 原子地偏移v_nDiff个元素
+     * @return T* 原值
+     */
+    T *fetch_add(ptrdiff_t v_nDiff, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_add(&this->m_value, v_nDiff * scale(), v_order);
+    }
+    T *fetch_sub(ptrdiff_t v_nDiff, memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::fetch_sub(&this->m_value, v_nDiff * scale(), v_order);
+    }
+
+    T *operator++() { return fetch_add(1) + 1; }
+    T *operator++(int) { return fetch_add(1); }
+    T *operator--() { return fetch_sub(1) - 1; }
+    T *operator--(int) { return fetch_sub(1); }
+    T *operator+=(ptrdiff_t v_nDiff) { return fetch_add(v_nDiff) + v_nDiff; }
+    T *operator-=(ptrdiff_t v_nDiff) { return fetch_sub(v_nDiff) - v_nDiff; }
+
+    atomic &operator=(T *v_value)
+    {
+        this->store(v_value);
+        return *this;
+    }
+
+private:
+    /**
+     * @brief GCC内建函数对指针按字节偏移，windows下的实现按元素偏移
+     */
+    static ptrdiff_t scale()
+    {
+#if defined(__GNUC__)
+        return static_cast<ptrdiff_t>(sizeof(T));
+#else
+        return 1;
+#endif
+    }
+};
+
+/**
+ * @brief 内存屏障，含义与C++11的std::atomic_thread_fence一致，用于按内存序约束前后的普通读写
+ */
+inline void atomic_thread_fence(memory_order v_order)
+{
+#if defined(__GNUC__)
+    __atomic_thread_fence(atomic_detail::to_gcc(v_order));
+#else
+    if (v_order == memory_order_seq_cst)
+    {
+        MemoryBarrier();
+    }
+    else if (v_order != memory_order_relaxed)
+    {
+        _ReadWriteBarrier(); // x86/x64上只有写-读会被CPU重排，其余只需阻止编译器重排
+    }
+#endif
+}
+
+/**
+ * @brief 原子标志，仿照C++11的std::atomic_flag，可用于实现最简单的自旋锁
+ */
+class atomic_flag
+{
+    typedef atomic_detail::ops<LONG> ops;
+
+public:
+    atomic_flag() : m_value(0) {}
+
+public:
+    /**
+     * @brief 置位
+     * @return bool 置位前是否已置位
+     */
+    bool test_and_set(memory_order v_order = memory_order_seq_cst)
+    {
+        return ops::exchange(&m_value, 1, v_order) != 0;
+    }
+    void clear(memory_order v_order = memory_order_seq_cst) { ops::store(&m_value, 0, v_order); }
+    bool test(memory_order v_order = memory_order_seq_cst) const { return ops::load(&m_value, v_order) != 0; }
+
+private:
+    atomic_flag(const atomic_flag &);
+    atomic_flag &operator=(const atomic_flag &);
 
 private:
-    T m_value;
+    volatile LONG m_value;
 };
 
 #endif // ATOMIC_HPP
\ No newline at end of file
@@ -0,0 +1,122 @@
+﻿/**
+ * @file barrier.hpp
+ * @brief 可重复使用的屏障，所有参与线程到达后执行完成函数并进入下一阶段
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef BARRIER_HPP
+#define BARRIER_HPP
+
+#include "atomic.hpp"
+#include "futex.hpp"
+
+/**
+ * @brief 屏障，接口与C++20的std::barrier一致
+ * @details 到达时原子减少本阶段的剩余计数，最后到达的线程执行完成函数、重置剩余计数后递增阶段号，
+ *          其余线程在阶段号上挂起；最后到达的线程只有在存在等待者时才进入内核唤醒
+ * @note 完成函数在最后到达的线程中执行，此时其他线程都还在等待，可以安全地读写本阶段的共享数据
+ */
+class barrier
+{
+    typedef atomic_detail::ops<LONG> ops;
+
+public:
+    typedef void (*completion_func)(void *); // 完成函数
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nExpected 每个阶段的参与线程数
+     * @param [in] v_func 完成函数，可以为NULL
+     * @param [in] v_param 完成函数的参数
+     */
+    explicit barrier(LONG v_nExpected, completion_func v_func = NULL, void *v_param = NULL)
+        : m_nExpected(v_nExpected), m_nRemaining(v_nExpected), m_nPhase(0), m_nWaiters(0), m_func(v_func),
+          m_param(v_param)
+    {
+    }
+    ~barrier() {}
+
+public:
+    /**
+     * @brief 到达并等待本阶段的其他参与线程
+     */
+    void arrive_and_wait()
+    {
+        LONG nPhase = ops::load(&m_nPhase, memory_order_acquire);
+        if (!arrive())
+        {
+            wait(nPhase);
+        }
+    }
+
+    /**
+     * @brief 到达，并退出之后的阶段，不等待
+     */
+    void arrive_and_drop()
+    {
+        // 先减少参与线程数再到达：本阶段要等本线程到达才能完成，重置剩余计数时一定已经看到减少后的值
+        ops::fetch_sub(&m_nExpected, 1, memory_order_relaxed);
+        arrive();
+    }
+
+    /**
+     * @brief 当前阶段号，每完成一个阶段加1
+     */
+    LONG phase() const { return ops::load(&m_nPhase, memory_order_acquire); }
+
+private:
+    /**
+     * @brief 到达，最后到达时完成本阶段
+     * @return BOOL 是否是最后到达的线程
+     */
+    BOOL arrive()
+    {
+        if (ops::fetch_sub(&m_nRemaining, 1, memory_order_acq_rel) != 1)
+        {
+            return FALSE;
+        }
+
+        if (m_func)
+        {
+            m_func(m_param);
+        }
+
+        // 先重置剩余计数再递增阶段号，看到新阶段号的线程再次到达时计数已经重置
+        ops::store(&m_nRemaining, ops::load(&m_nExpected, memory_order_relaxed), memory_order_relaxed);
+        ops::fetch_add(&m_nPhase, 1, memory_order_seq_cst); // 与等待方登记后的检查配对，不会丢失唤醒
+        if (m_nWaiters.load() > 0)
+        {
+            futex::wake(&m_nPhase, INT_MAX);
+        }
+        return TRUE;
+    }
+
+    /**
+     * @brief 等待阶段号离开v_nPhase
+     */
+    void wait(LONG v_nPhase)
+    {
+        ++m_nWaiters; // 原子操作带完整屏障，之后读到的阶段号不会早于登记
+        while (ops::load(&m_nPhase, memory_order_acquire) == v_nPhase)
+        {
+            futex::wait(&m_nPhase, v_nPhase);
+        }
+        --m_nWaiters;
+    }
+
+private:
+    barrier(const barrier &);
+    barrier &operator=(const barrier &);
+
+private:
+    volatile LONG m_nExpected;  // 每个阶段的参与线程数
+    volatile LONG m_nRemaining; // 本阶段尚未到达的线程数
+    volatile LONG m_nPhase;     // 阶段号，同时作为futex等待地址
+    atomic<LONG> m_nWaiters;    // 挂起或即将挂起的线程数
+    completion_func m_func;     // 完成函数
+    void *m_param;              // 完成函数的参数
+};
+
+#endif // BARRIER_HPP
\ No newline at end of file
@@ -0,0 +1,66 @@
+﻿/**
+ * @file cache_padded.hpp
+ * @brief 独占缓存行的包装类，避免被不同线程频繁修改的数据发生伪共享
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef CACHE_PADDED_HPP
+#define CACHE_PADDED_HPP
+
+#include "atomic.hpp"
+
+/**
+ * @brief 前置填充，作为基类放在被包装对象之前
+ */
+struct cache_line_pad
+{
+    char m_padBefore[CACHE_LINE_SIZE];
+};
+
+/**
+ * @brief 独占缓存行的包装类
+ * @details 前后各填充一整个缓存行，C++98无法保证堆上对象按缓存行对齐，不依赖对齐也能保证
+ *          被包装对象不与相邻数据共享缓存行
+ * @tparam T 被包装的类型
+ */
+template <typename T> class cache_padded : private cache_line_pad
+{
+public:
+    cache_padded() : m_value() {}
+    cache_padded(const T &v_value) : m_value(v_value) {}
+
+public:
+    T &get() { return m_value; }
+    const T &get() const { return m_value; }
+    T &operator*() { return m_value; }
+    const T &operator*() const { return m_value; }
+    T *operator->() { return &m_value; }
+    const T *operator->() const { return &m_value; }
+
+private:
+    T m_value;
+    char m_padAfter[CACHE_LINE_SIZE];
+};
+
+/**
+ * @brief 独占缓存行的原子类型，接口与atomic<T>一致
+ * @tparam T 原子操作的数据类型
+ */
+template <typename T> class aligned_atomic : private cache_line_pad, public atomic<T>
+{
+public:
+    aligned_atomic(T v_value = T()) : atomic<T>(v_value) {}
+
+public:
+    aligned_atomic &operator=(T v_value)
+    {
+        this->store(v_value);
+        return *this;
+    }
+
+private:
+    char m_padAfter[CACHE_LINE_SIZE];
+};
+
+#endif // CACHE_PADDED_HPP
\ No newline at end of file
@@ -1,6 +1,6 @@
 ﻿/**
  * @file condition_variable.hpp
- * @brief C++98 windows下的条件变量实现
+ * @brief C++98 条件变量实现，windows下基于事件，linux下基于futex
  * @author zhengw
  * @date 2024-06-07
  */
@@ -9,8 +9,13 @@
 
 #include "atomic.hpp"
 #include "mutex.hpp"
+#if defined(_WIN32)
 #include "../win/win_event.hpp"
+#else
+#include "futex.hpp"
+#endif
 
+#if defined(_WIN32)
 /**
  * @brief 条件变量
  * @note XP系统下无法使用windows api实现的条件变量，故通过事件实现
@@ -35,10 +40,84 @@ public:
      */
     BOOL wait_for(unique_lock<mutex>& v_lock, DWORD v_dwMilliseconds)
     {
+        // 释放锁之前登记为等待线程，释放锁之后到开始等待之间的通知会使事件保持有信号，不会丢失
+        ++m_nWaiters;
+
         v_lock.unlock(); // 释放锁
+        BOOL bRet = wait_registered(v_dwMilliseconds);
+        v_lock.lock(); // 重新获取锁
+
+        return bRet;
+    }
+
+    /**
+     * @brief 等待条件变量，同时释放另一把锁，直到被唤醒或超时
+     * @note 用于通知方持有的是另一把锁的场景：登记为等待线程之后才释放v_lockExtra，
+     *       通知方获取v_lockExtra之后的通知不会丢失；唤醒后先获取v_lock再获取v_lockExtra
+     * @param [in] v_lock 互斥锁
+     * @param [in] v_lockExtra 同时释放的另一把互斥锁
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 被唤醒，FALSE 超时或其他原因导致的退出
+     */
+    BOOL wait_for(unique_lock<mutex>& v_lock, unique_lock<mutex>& v_lockExtra, DWORD v_dwMilliseconds)
+    {
+        ++m_nWaiters;
+
+        v_lockExtra.unlock();
+        v_lock.unlock();
+        BOOL bRet = wait_registered(v_dwMilliseconds);
+        v_lock.lock();
+        v_lockExtra.lock();
+
+        return bRet;
+    }
+
+    /**
+     * @brief 等待条件变量，直到被唤醒或到达截止时间
+     * @param [in] v_lock 互斥锁
+     * @param [in] v_dwDeadline 截止时间，tick_count()的值
+     * @return BOOL TRUE 被唤醒，FALSE 超时
+     */
+    BOOL wait_until(unique_lock<mutex>& v_lock, DWORD v_dwDeadline)
+    {
+        LONG nRemain = static_cast<LONG>(v_dwDeadline - tick_count());
+        return nRemain > 0 && wait_for(v_lock, static_cast<DWORD>(nRemain));
+    }
+
+    /**
+     * @brief 等待条件变量，直到被唤醒
+     * @param [in] v_lock 互斥锁
+     */
+    void wait(unique_lock<mutex>& v_lock) { wait_for(v_lock, INFINITE); }
+
+    /**
+     * @brief 通知等待线程，唤醒一个
+     */
+    void notify_one() const
+    {
+        if (m_nWaiters > (LONG)0)
+        {
+            m_eventSignal.set();
+        }
+    }
 
-        ++m_nWaiters; // 等待线程数加1
+    /**
+     * @brief 通知等待线程，唤醒所有
+     */
+    void notify_all() const
+    {
+        if (m_nWaiters > (LONG)0)
+        {
+            m_eventBroadcast.set();
+        }
+    }
 
+private:
+    /**
+     * @brief 已登记为等待线程并释放锁之后，等待事件
+     */
+    BOOL wait_registered(DWORD v_dwMilliseconds)
+    {
         // 等待事件集合中的事件
         DWORD dwRet = m_events.wait_for(v_dwMilliseconds, FALSE);
 
@@ -53,12 +132,105 @@ public:
             m_eventBroadcast.reset();
         }
 
-        v_lock.lock(); // 重新获取锁
-
         // 如果不是事件通知唤醒，则说明超时或其他原因导致的退出
         return win_events::is_wait_for_seted(dwRet);
     }
 
+private:
+    atomic<LONG> m_nWaiters;    // 等待线程数，原子变量，无需锁保护
+    win_event m_eventSignal;    // 自动重置事件，用于通知单个等待线程
+    win_event m_eventBroadcast; // 手动重置事件，用于通知所有等待线程
+    win_events m_events;        // 事件集合，用于等待多个事件
+};
+#else
+/**
+ * @brief 条件变量，基于futex序列号实现
+ * @note 等待方记录序列号后释放锁并在序列号上挂起；通知方递增序列号，
+ *       只有存在等待线程时才进入内核唤醒，因此无等待者时通知没有系统调用
+ * @note notify_all()只唤醒一个等待线程，其余的由内核直接转移到互斥量的futex上（FUTEX_CMP_REQUEUE），
+ *       由前一个线程解锁时逐个唤醒，避免所有线程同时醒来争抢同一把锁；
+ *       转移目标是第一次等待时使用的互斥量，一旦有等待线程使用了其他互斥量，之后的notify_all()全部直接唤醒
+ */
+class condition_variable
+{
+public:
+    condition_variable() : m_iSeq(0), m_nWaiters(0), m_pMutex(NULL), m_iMixed(0) {}
+    virtual ~condition_variable() {}
+
+public:
+    /**
+     * @brief 等待条件变量，直到被唤醒或超时
+     * @param [in] v_lock 互斥锁
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 被唤醒，FALSE 超时
+     */
+    BOOL wait_for(unique_lock<mutex>& v_lock, DWORD v_dwMilliseconds)
+    {
+        int iSeq = enter_wait(v_lock);
+
+        v_lock.unlock();
+        BOOL bRet = futex::wait(&m_iSeq, iSeq, v_dwMilliseconds);
+        leave_wait(v_lock);
+
+        return bRet;
+    }
+
+    /**
+     * @brief 等待条件变量，同时释放另一把锁，直到被唤醒或超时
+     * @note 用于通知方持有的是另一把锁的场景：读取序列号之后才释放v_lockExtra，
+     *       通知方获取v_lockExtra之后的通知不会丢失；唤醒后先获取v_lock再获取v_lockExtra
+     * @param [in] v_lock 互斥锁，notify_all()把等待线程转移到这把锁上
+     * @param [in] v_lockExtra 同时释放的另一把互斥锁
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 被唤醒，FALSE 超时
+     */
+    BOOL wait_for(unique_lock<mutex>& v_lock, unique_lock<mutex>& v_lockExtra, DWORD v_dwMilliseconds)
+    {
+        int iSeq = enter_wait(v_lock);
+
+        v_lockExtra.unlock();
+        v_lock.unlock();
+        BOOL bRet = futex::wait(&m_iSeq, iSeq, v_dwMilliseconds);
+        leave_wait(v_lock);
+        v_lockExtra.lock();
+
+        return bRet;
+    }
+
+    /**
+     * @brief 等待条件变量，直到被唤醒或到达截止时间
+     * @note 截止时间换算为CLOCK_MONOTONIC的绝对时间后交给内核，虚假唤醒后重新等待不会累积误差
+     * @param [in] v_lock 互斥锁
+     * @param [in] v_dwDeadline 截止时间，tick_count()的值
+     * @return BOOL TRUE 被唤醒，FALSE 超时
+     */
+    BOOL wait_until(unique_lock<mutex>& v_lock, DWORD v_dwDeadline)
+    {
+        LONG nRemain = static_cast<LONG>(v_dwDeadline - tick_count());
+        if (nRemain <= 0)
+        {
+            return FALSE;
+        }
+
+        timespec tsDeadline;
+        ::clock_gettime(CLOCK_MONOTONIC, &tsDeadline);
+        tsDeadline.tv_sec += nRemain / 1000;
+        tsDeadline.tv_nsec += (nRemain % 1000) * 1000000L;
+        if (tsDeadline.tv_nsec >= 1000000000L)
+        {
+            ++tsDeadline.tv_sec;
+            tsDeadline.tv_nsec -= 1000000000L;
+        }
+
+        int iSeq = enter_wait(v_lock);
+
+        v_lock.unlock();
+        BOOL bRet = futex::wait_until(&m_iSeq, iSeq, tsDeadline);
+        leave_wait(v_lock);
+
+        return bRet;
+    }
+
     /**
      * @brief 等待条件变量，直到被唤醒
      * @param [in] v_lock 互斥锁
@@ -70,28 +242,72 @@ public:
      */
     void notify_one() const
     {
+        __sync_add_and_fetch(&m_iSeq, 1); // 全屏障，保证先递增序列号再读取等待线程数
         if (m_nWaiters > (LONG)0)
         {
-            m_eventSignal.set();
+            futex::wake(&m_iSeq, 1);
         }
     }
 
     /**
      * @brief 通知等待线程，唤醒所有
+     * @note 唤醒一个，其余转移到互斥量上；等待线程使用过不同的互斥量，或序列号在此期间被其他通知修改时，
+     *       退化为全部唤醒
      */
     void notify_all() const
     {
+        int iSeq = __sync_add_and_fetch(&m_iSeq, 1); // 全屏障，保证先递增序列号再读取混用标志
         if (m_nWaiters > (LONG)0)
         {
-            m_eventBroadcast.set();
+            mutex *pMutex = __atomic_load_n(&m_pMutex, __ATOMIC_RELAXED);
+            if (pMutex == NULL || __atomic_load_n(&m_iMixed, __ATOMIC_SEQ_CST) != 0 ||
+                !futex::requeue(&m_iSeq, iSeq, 1, &pMutex->m_iState))
+            {
+                futex::wake(&m_iSeq, INT_MAX);
+            }
         }
     }
 
 private:
-    atomic<LONG> m_nWaiters;    // 等待线程数，原子变量，无需锁保护
-    win_event m_eventSignal;    // 自动重置事件，用于通知单个等待线程
-    win_event m_eventBroadcast; // 手动重置事件，用于通知所有等待线程
-    win_events m_events;        // 事件集合，用于等待多个事件
+    /**
+     * @brief 释放锁之前登记为等待线程
+     * @note 必须在释放锁之前读取序列号，释放锁之后的通知都会使futex等待立即返回，不会丢失
+     * @note 转移目标只记录第一次等待的互斥量；混用标志在读取序列号之前置位，
+     *       读到旧序列号挂起的线程，其混用标志对递增序列号之后的notify_all()一定可见
+     * @return int 当前序列号
+     */
+    int enter_wait(unique_lock<mutex>& v_lock)
+    {
+        mutex *pMutex = NULL;
+        if (!__atomic_compare_exchange_n(&m_pMutex, &pMutex, &v_lock.m_mutex, false, __ATOMIC_RELAXED,
+                                         __ATOMIC_RELAXED) &&
+            pMutex != &v_lock.m_mutex)
+        {
+            __atomic_store_n(&m_iMixed, 1, __ATOMIC_SEQ_CST);
+        }
+        int iSeq = __atomic_load_n(&m_iSeq, __ATOMIC_SEQ_CST);
+        ++m_nWaiters;
+        return iSeq;
+    }
+
+    /**
+     * @brief 唤醒后重新加锁
+     * @note 可能是被转移到互斥量上之后才唤醒的，必须以"可能有等待者"状态加锁，
+     *       解锁时才会继续唤醒其余被转移的线程
+     */
+    void leave_wait(unique_lock<mutex>& v_lock)
+    {
+        --m_nWaiters;
+        v_lock.m_mutex.lock_contended();
+        v_lock.m_bLocked = TRUE;
+    }
+
+private:
+    mutable volatile int m_iSeq; // 通知序列号，每次通知加1
+    atomic<LONG> m_nWaiters;     // 等待线程数，原子变量，无需锁保护
+    mutex *m_pMutex;             // 第一次等待时使用的互斥量，notify_all()的转移目标
+    int m_iMixed;                // 是否有等待线程使用过其他互斥量，置位后notify_all()不再转移
 };
+#endif // _WIN32
 
 #endif // CONDITION_VARIABLE_HPP
\ No newline at end of file
@@ -0,0 +1,342 @@
+﻿/**
+ * @file ebr.hpp
+ * @brief 基于纪元的内存回收（epoch-based reclamation），用于无锁数据结构中被摘除节点的延迟释放
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef EBR_HPP
+#define EBR_HPP
+
+#include "atomic.hpp"
+#include "object_pool.hpp"
+#include "thread_exit.hpp"
+
+/**
+ * @brief 基于纪元的内存回收，全局一个域
+ * @details 全局纪元单调递增。线程访问共享节点前enter()，记录进入时的全局纪元并标记为活跃，访问完leave()；
+ *          摘除的节点retire()到本线程的待回收链表，记下当时的全局纪元。所有活跃线程都已看到当前纪元时全局纪元才能推进，
+ *          节点退休后全局纪元推进两次，退休前进入的线程必然都已离开，节点可以释放
+ * @note 线程首次enter()/retire()时自动登记，线程退出时经thread_exit自动注销（不论线程以何种方式创建），
+ *       也可以提前调用detach()
+ * @note 某个线程长时间停留在临界区内会阻止纪元推进，期间所有线程退休的节点都无法释放
+ */
+class ebr
+{
+    /**
+     * @brief 退休节点
+     */
+    struct retired
+    {
+        void *m_p;              // 待释放的对象
+        void (*m_func)(void *); // 释放函数
+        DWORD m_nEpoch;         // 退休时的全局纪元
+        retired *m_pNext;       // 下一个节点
+    };
+
+    /**
+     * @brief 线程登记记录，线程注销后留给其他线程复用，不释放
+     */
+    struct record
+    {
+        volatile DWORD m_nLocal; // 0 不在临界区，否则为(进入时的纪元 << 1) | 1，其他线程推进纪元时读取
+        char m_pad0[CACHE_LINE_SIZE - sizeof(DWORD)];
+
+        volatile LONG m_nInUse; // 是否被某个线程占用
+        record *m_pNext;        // 登记链表的下一个记录，发布后不再修改
+        size_t m_nNesting;      // 临界区嵌套层数
+        retired *m_pHead;       // 待回收链表头，按退休纪元递增
+        retired *m_pTail;       // 待回收链表尾
+        size_t m_nRetired;      // 待回收节点数
+        char m_pad1[CACHE_LINE_SIZE];
+    };
+
+    /**
+     * @brief 全局状态，类模板的静态成员在多个编译单元中只有一份定义，且都是零初始化的POD
+     */
+    template <int N>
+    struct globals
+    {
+        static volatile DWORD s_nEpoch;     // 全局纪元
+        static record *volatile s_pRecords; // 登记链表，只增不减
+        static volatile LONG s_nOrphanLock; // 孤儿链表锁
+        static retired *s_pOrphans;         // 已注销线程未释放的节点
+    };
+    typedef globals<0> g;
+
+    typedef atomic_detail::ops<DWORD> epoch_ops;
+    typedef atomic_detail::ops<LONG> long_ops;
+
+public:
+    enum
+    {
+        COLLECT_THRESHOLD = 64 // 本线程待回收节点数达到该值时尝试推进纪元并回收
+    };
+
+public:
+    /**
+     * @brief 进入临界区，可嵌套
+     */
+    static void enter()
+    {
+        record *pRecord = local_record();
+        if (pRecord->m_nNesting++ == 0)
+        {
+            DWORD nEpoch = epoch_ops::load(&g::s_nEpoch, memory_order_relaxed);
+            // 顺序一致的交换保证标记为活跃先于之后读取共享指针，推进纪元的线程不会漏看
+            epoch_ops::exchange(&pRecord->m_nLocal, (nEpoch << 1) | 1, memory_order_seq_cst);
+        }
+    }
+
+    /**
+     * @brief 离开临界区
+     */
+    static void leave()
+    {
+        record *pRecord = local();
+        if (--pRecord->m_nNesting == 0)
+        {
+            epoch_ops::store(&pRecord->m_nLocal, 0, memory_order_release);
+        }
+    }
+
+    /**
+     * @brief 退休一个已从共享结构中摘除的对象，等所有可能持有它的线程离开临界区后释放
+     * @param [in] v_p 对象
+     * @param [in] v_func 释放函数，在某个调用retire()/collect()的线程中执行
+     */
+    static void retire(void *v_p, void (*v_func)(void *))
+    {
+        record *pRecord = local_record();
+        retired *pNode = object_pool<retired>::create();
+        pNode->m_p = v_p;
+        pNode->m_func = v_func;
+        pNode->m_nEpoch = epoch_ops::load(&g::s_nEpoch, memory_order_seq_cst);
+        pNode->m_pNext = NULL;
+        if (pRecord->m_pTail)
+        {
+            pRecord->m_pTail->m_pNext = pNode;
+        }
+        else
+        {
+            pRecord->m_pHead = pNode;
+        }
+        pRecord->m_pTail = pNode;
+
+        if (++pRecord->m_nRetired >= COLLECT_THRESHOLD)
+        {
+            collect(pRecord);
+        }
+    }
+
+    /**
+     * @brief 退休用new创建的对象，释放时delete
+     */
+    template <typename T>
+    static void retire(T *v_p)
+    {
+        retire(v_p, &delete_object<T>);
+    }
+
+    /**
+     * @brief 尝试推进纪元，释放本线程及已注销线程中可以释放的节点
+     * @return size_t 释放的节点数
+     */
+    static size_t collect() { return collect(local_record()); }
+
+    /**
+     * @brief 本线程尚未释放的节点数
+     */
+    static size_t pending() { return local() ? local()->m_nRetired : 0; }
+
+    /**
+     * @brief 当前线程是否在临界区内
+     */
+    static BOOL in_critical() { return local() && local()->m_nNesting > 0; }
+
+    /**
+     * @brief 登记当前线程，enter()/retire()会自动调用
+     */
+    static void attach() { local_record(); }
+
+    /**
+     * @brief 注销当前线程，尚未释放的节点转入孤儿链表由其他线程释放；必须在临界区外调用
+     */
+    static void detach()
+    {
+        record *pRecord = local();
+        if (!pRecord)
+        {
+            return;
+        }
+
+        collect(pRecord);
+        if (pRecord->m_pHead)
+        {
+            lock_orphans();
+            pRecord->m_pTail->m_pNext = g::s_pOrphans;
+            g::s_pOrphans = pRecord->m_pHead;
+            unlock_orphans();
+            pRecord->m_pHead = pRecord->m_pTail = NULL;
+            pRecord->m_nRetired = 0;
+        }
+
+        epoch_ops::store(&pRecord->m_nLocal, 0, memory_order_relaxed);
+        long_ops::store(&pRecord->m_nInUse, 0, memory_order_release);
+        local() = NULL;
+    }
+
+private:
+    template <typename T>
+    static void delete_object(void *v_p)
+    {
+        delete static_cast<T *>(v_p);
+    }
+
+    static record *&local()
+    {
+        static THREAD_LOCAL record *s_pRecord = NULL;
+        return s_pRecord;
+    }
+
+    /**
+     * @brief 当前线程的登记记录，未登记时先复用已注销的记录，没有再新建，并登记线程退出时注销
+     */
+    static record *local_record()
+    {
+        record *&pLocal = local();
+        if (pLocal)
+        {
+            return pLocal;
+        }
+
+        thread_exit::at_exit(&ebr::detach);
+        for (record *p = g::s_pRecords; p; p = p->m_pNext)
+        {
+            LONG nExpected = 0;
+            if (long_ops::load(&p->m_nInUse, memory_order_relaxed) == 0 &&
+                long_ops::compare_exchange(&p->m_nInUse, nExpected, 1, false, memory_order_acquire))
+            {
+                pLocal = p;
+                return p;
+            }
+        }
+
+        record *pRecord = new record();
+        pRecord->m_nInUse = 1;
+        pRecord->m_pNext = g::s_pRecords;
+        while (InterlockedCompareExchangePointer(reinterpret_cast<void *volatile *>(&g::s_pRecords), pRecord,
+                                                 pRecord->m_pNext) != pRecord->m_pNext)
+        {
+            pRecord->m_pNext = g::s_pRecords;
+        }
+        pLocal = pRecord;
+        return pRecord;
+    }
+
+    /**
+     * @brief 所有活跃线程都已看到当前纪元时推进纪元
+     * @return DWORD 推进后（或未能推进时）的全局纪元
+     */
+    static DWORD try_advance()
+    {
+        DWORD nEpoch = epoch_ops::load(&g::s_nEpoch, memory_order_seq_cst);
+        for (record *p = g::s_pRecords; p; p = p->m_pNext)
+        {
+            DWORD nLocal = epoch_ops::load(&p->m_nLocal, memory_order_seq_cst);
+            if ((nLocal & 1) && (nLocal >> 1) != (nEpoch & 0x7FFFFFFF))
+            {
+                return nEpoch;
+            }
+        }
+
+        DWORD nExpected = nEpoch;
+        epoch_ops::compare_exchange(&g::s_nEpoch, nExpected, nEpoch + 1, false, memory_order_seq_cst);
+        return epoch_ops::load(&g::s_nEpoch, memory_order_acquire);
+    }
+
+    static BOOL reclaimable(const retired *v_pNode, DWORD v_nEpoch) { return v_nEpoch - v_pNode->m_nEpoch >= 2; }
+
+    static void free_node(retired *v_pNode)
+    {
+        v_pNode->m_func(v_pNode->m_p);
+        object_pool<retired>::destroy(v_pNode);
+    }
+
+    static size_t collect(record *v_pRecord)
+    {
+        DWORD nEpoch = try_advance();
+        size_t nFreed = 0;
+        while (v_pRecord->m_pHead && reclaimable(v_pRecord->m_pHead, nEpoch))
+        {
+            retired *pNode = v_pRecord->m_pHead;
+            v_pRecord->m_pHead = pNode->m_pNext;
+            if (!v_pRecord->m_pHead)
+            {
+                v_pRecord->m_pTail = NULL;
+            }
+            --v_pRecord->m_nRetired;
+            free_node(pNode);
+            ++nFreed;
+        }
+
+        // 孤儿链表很少非空，先不加锁看一眼
+        if (g::s_pOrphans && try_lock_orphans())
+        {
+            retired *pKeep = NULL;
+            retired *pFree = NULL;
+            for (retired *pNode = g::s_pOrphans, *pNext = NULL; pNode; pNode = pNext)
+            {
+                pNext = pNode->m_pNext;
+                retired *&pList = reclaimable(pNode, nEpoch) ? pFree : pKeep;
+                pNode->m_pNext = pList;
+                pList = pNode;
+            }
+            g::s_pOrphans = pKeep;
+            unlock_orphans();
+
+            for (retired *pNext = NULL; pFree; pFree = pNext)
+            {
+                pNext = pFree->m_pNext;
+                free_node(pFree);
+                ++nFreed;
+            }
+        }
+        return nFreed;
+    }
+
+    static void lock_orphans()
+    {
+        while (!try_lock_orphans())
+        {
+            cpu_relax();
+        }
+    }
+    static BOOL try_lock_orphans() { return InterlockedExchange(&g::s_nOrphanLock, 1) == 0; }
+    static void unlock_orphans() { InterlockedExchange(&g::s_nOrphanLock, 0); }
+};
+
+template <int N>
+volatile DWORD ebr::globals<N>::s_nEpoch = 0;
+template <int N>
+ebr::record *volatile ebr::globals<N>::s_pRecords = NULL;
+template <int N>
+volatile LONG ebr::globals<N>::s_nOrphanLock = 0;
+template <int N>
+ebr::retired *ebr::globals<N>::s_pOrphans = NULL;
+
+/**
+ * @brief EBR临界区的局部守卫
+ */
+class ebr_guard
+{
+public:
+    ebr_guard() { ebr::enter(); }
+    ~ebr_guard() { ebr::leave(); }
+
+private:
+    ebr_guard(const ebr_guard &);
+    ebr_guard &operator=(const ebr_guard &);
+};
+
+#endif // EBR_HPP
\ No newline at end of file
@@ -0,0 +1,110 @@
+﻿/**
+ * @file event_count.hpp
+ * @brief 事件计数器，用于无锁数据结构在空/满时阻塞等待
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef EVENT_COUNT_HPP
+#define EVENT_COUNT_HPP
+
+#include "atomic.hpp"
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+
+/**
+ * @brief 事件计数器
+ * @details 等待方先调用prepare_wait()登记并取得当前纪元，再次检查条件，条件仍不满足才调用commit_wait()挂起，
+ *          否则调用cancel_wait()；通知方修改状态后调用notify_one()/notify_all()，没有等待者时只有一次读取，不加锁
+ * @code
+ *     while (!try_pop(v))
+ *     {
+ *         LONG nKey = ec.prepare_wait();
+ *         if (try_pop(v)) { ec.cancel_wait(); break; }
+ *         ec.commit_wait(nKey);
+ *     }
+ * @endcode
+ */
+class event_count
+{
+public:
+    event_count() : m_nWaiters(0), m_nEpoch(0) {}
+    virtual ~event_count() {}
+
+public:
+    /**
+     * @brief 登记为等待者，返回当前纪元
+     * @return LONG 纪元，传给commit_wait()
+     */
+    LONG prepare_wait()
+    {
+        ++m_nWaiters; // 原子操作带完整屏障，之后读取的纪元和条件都不会早于登记
+        return m_nEpoch;
+    }
+
+    /**
+     * @brief 取消等待，条件已满足时调用
+     */
+    void cancel_wait() { --m_nWaiters; }
+
+    /**
+     * @brief 挂起直到纪元变化或超时
+     * @param [in] v_nKey prepare_wait()返回的纪元
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 纪元已变化，FALSE 超时
+     */
+    BOOL commit_wait(LONG v_nKey, DWORD v_dwMilliseconds = INFINITE)
+    {
+        BOOL bRet = TRUE;
+        {
+            unique_lock<mutex> lock(m_mutex);
+            while (m_nEpoch == v_nKey)
+            {
+                if (!m_cv.wait_for(lock, v_dwMilliseconds))
+                {
+                    bRet = (m_nEpoch != v_nKey);
+                    break;
+                }
+            }
+        }
+        --m_nWaiters;
+        return bRet;
+    }
+
+    /**
+     * @brief 唤醒一个等待者
+     * @note 调用前对条件的修改需对等待者可见，函数内的屏障保证先修改条件再检查等待者
+     */
+    void notify_one()
+    {
+        memory_barrier();
+        if (m_nWaiters > (LONG)0)
+        {
+            unique_lock<mutex> lock(m_mutex);
+            ++m_nEpoch;
+            m_cv.notify_one();
+        }
+    }
+
+    /**
+     * @brief 唤醒所有等待者
+     */
+    void notify_all()
+    {
+        memory_barrier();
+        if (m_nWaiters > (LONG)0)
+        {
+            unique_lock<mutex> lock(m_mutex);
+            ++m_nEpoch;
+            m_cv.notify_all();
+        }
+    }
+
+private:
+    atomic<LONG> m_nWaiters; // 已登记的等待者数
+    atomic<LONG> m_nEpoch;   // 纪元，每次通知加1，只在锁内修改
+    mutex m_mutex;
+    condition_variable m_cv;
+};
+
+#endif // EVENT_COUNT_HPP
\ No newline at end of file
@@ -0,0 +1,166 @@
+﻿/**
+ * @file futex.hpp
+ * @brief 按地址等待/唤醒，linux下为futex系统调用的封装，windows下用分段的互斥量和条件变量模拟
+ * @note windows下的模拟不创建与地址一一对应的内核对象，所有地址共享固定数量的分段
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef FUTEX_HPP
+#define FUTEX_HPP
+
+#include <limits.h>
+
+#include "platform.hpp"
+
+#if defined(_WIN32)
+#include "mutex.hpp"
+#include "condition_variable.hpp"
+
+namespace futex
+{
+/**
+ * @brief 等待分段，地址按哈希落到某个分段，在分段的条件变量上等待
+ */
+struct bucket
+{
+    mutex m_mutex;
+    condition_variable m_cv;
+};
+
+/**
+ * @brief 分段表，类模板的静态成员在多个编译单元中只有一份定义
+ */
+template <int N>
+struct bucket_table
+{
+    static bucket s_buckets[N];
+};
+template <int N>
+bucket bucket_table<N>::s_buckets[N];
+
+inline bucket &get_bucket(volatile void *v_pAddr)
+{
+    return bucket_table<64>::s_buckets[(reinterpret_cast<size_t>(v_pAddr) / sizeof(LONG)) % 64];
+}
+
+/**
+ * @brief 若*v_pAddr仍等于v_nExpected，则挂起当前线程，直到被唤醒或超时
+ * @param [in] v_pAddr 等待的地址
+ * @param [in] v_nExpected 期望值
+ * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+ * @return BOOL TRUE 被唤醒或值已改变（可能是虚假唤醒），FALSE 超时
+ */
+inline BOOL wait(volatile LONG *v_pAddr, LONG v_nExpected, DWORD v_dwMilliseconds = INFINITE)
+{
+    bucket &b = get_bucket(v_pAddr);
+    unique_lock<mutex> lock(b.m_mutex);
+    if (*v_pAddr != v_nExpected)
+    {
+        return TRUE;
+    }
+    return b.m_cv.wait_for(lock, v_dwMilliseconds);
+}
+
+/**
+ * @brief 唤醒等待在v_pAddr上的线程
+ * @note 同一分段内可能有等待其他地址的线程，只能全部唤醒，由等待方自行检查值
+ * @param [in] v_pAddr 等待的地址
+ * @param [in] v_iCount 最多唤醒的线程数
+ * @return int 0
+ */
+inline int wake(volatile LONG *v_pAddr, int v_iCount = 1)
+{
+    (void)v_iCount;
+    bucket &b = get_bucket(v_pAddr);
+    unique_lock<mutex> lock(b.m_mutex);
+    b.m_cv.notify_all();
+    return 0;
+}
+} // namespace futex
+
+#else
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace futex
+{
+/**
+ * @brief 将毫秒转换为相对时间
+ * @param [in] v_dwMilliseconds 毫秒
+ * @param [out] v_ts 相对时间
+ */
+inline void to_timespec(DWORD v_dwMilliseconds, timespec &v_ts)
+{
+    v_ts.tv_sec = v_dwMilliseconds / 1000;
+    v_ts.tv_nsec = (v_dwMilliseconds % 1000) * 1000000L;
+}
+
+/**
+ * @brief 若*v_pAddr仍等于v_iExpected，则挂起当前线程，直到被唤醒或超时
+ * @param [in] v_pAddr futex字地址
+ * @param [in] v_iExpected 期望值
+ * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+ * @return BOOL TRUE 被唤醒或值已改变（可能是虚假唤醒），FALSE 超时
+ */
+inline BOOL wait(volatile int *v_pAddr, int v_iExpected, DWORD v_dwMilliseconds = INFINITE)
+{
+    timespec ts;
+    timespec *pts = NULL;
+    if (v_dwMilliseconds != INFINITE)
+    {
+        to_timespec(v_dwMilliseconds, ts);
+        pts = &ts;
+    }
+
+    long lRet = ::syscall(SYS_futex, v_pAddr, FUTEX_WAIT_PRIVATE, v_iExpected, pts, NULL, 0);
+    return !(lRet == -1 && errno == ETIMEDOUT);
+}
+
+/**
+ * @brief 唤醒等待在v_pAddr上的线程
+ * @param [in] v_pAddr futex字地址
+ * @param [in] v_iCount 最多唤醒的线程数
+ * @return int 实际唤醒的线程数
+ */
+inline int wake(volatile int *v_pAddr, int v_iCount = 1)
+{
+    long lRet = ::syscall(SYS_futex, v_pAddr, FUTEX_WAKE_PRIVATE, v_iCount, NULL, NULL, 0);
+    return lRet < 0 ? 0 : static_cast<int>(lRet);
+}
+
+/**
+ * @brief 若*v_pAddr仍等于v_iExpected，则挂起当前线程，直到被唤醒或到达截止时间
+ * @param [in] v_pAddr futex字地址
+ * @param [in] v_iExpected 期望值
+ * @param [in] v_tsDeadline 截止时间，CLOCK_MONOTONIC的绝对时间，不受系统时间调整影响
+ * @return BOOL TRUE 被唤醒或值已改变（可能是虚假唤醒），FALSE 超时
+ */
+inline BOOL wait_until(volatile int *v_pAddr, int v_iExpected, const timespec &v_tsDeadline)
+{
+    long lRet = ::syscall(SYS_futex, v_pAddr, FUTEX_WAIT_BITSET_PRIVATE, v_iExpected, &v_tsDeadline, NULL,
+                          FUTEX_BITSET_MATCH_ANY);
+    return !(lRet == -1 && errno == ETIMEDOUT);
+}
+
+/**
+ * @brief 若*v_pAddr仍等于v_iExpected，唤醒其上的v_iWake个线程，其余等待线程转移到v_pTarget上等待
+ * @param [in] v_pAddr futex字地址
+ * @param [in] v_iExpected 期望值
+ * @param [in] v_iWake 唤醒的线程数
+ * @param [in] v_pTarget 转移到的futex字地址
+ * @return BOOL FALSE *v_pAddr已不等于v_iExpected，没有唤醒和转移任何线程
+ */
+inline BOOL requeue(volatile int *v_pAddr, int v_iExpected, int v_iWake, volatile int *v_pTarget)
+{
+    long lRet = ::syscall(SYS_futex, v_pAddr, FUTEX_CMP_REQUEUE_PRIVATE, v_iWake,
+                          reinterpret_cast<void *>(static_cast<long>(INT_MAX)), v_pTarget, v_iExpected);
+    return lRet >= 0;
+}
+} // namespace futex
+#endif // _WIN32
+
+#endif // FUTEX_HPP
\ No newline at end of file
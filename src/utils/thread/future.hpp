@@ -0,0 +1,541 @@
+﻿/**
+ * @file future.hpp
+ * @brief C++98 future/promise，共享状态从对象池分配，等待时先自旋再按地址挂起
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef FUTURE_HPP
+#define FUTURE_HPP
+
+#include <limits.h>
+
+#include "atomic.hpp"
+#include "futex.hpp"
+#include "object_pool.hpp"
+
+/**
+ * @brief 共享状态基类，保存就绪标志、引用计数和就绪回调
+ * @details 状态字取值为PENDING/WAITING/READY，有线程挂起等待时由PENDING改为WAITING，
+ *          置为就绪的一方只在原值为WAITING时才调用futex::wake()，无人等待时没有系统调用
+ */
+class future_state_base
+{
+    /**
+     * @brief 就绪回调节点，无锁压栈，就绪时一次性取出
+     */
+    struct continuation
+    {
+        void (*m_func)(void *); // 回调函数
+        void *m_param;          // 回调参数
+        continuation *m_pNext;  // 下一个节点
+    };
+
+public:
+    future_state_base() : m_nState(PENDING), m_nRef(1), m_bFailed(FALSE), m_pContinuations(NULL) {}
+    virtual ~future_state_base() {}
+
+public:
+    void add_ref() { ++m_nRef; }
+    void release()
+    {
+        if (--m_nRef == 0)
+        {
+            destroy();
+        }
+    }
+
+    BOOL is_ready() const { return m_nState == READY; }
+    BOOL failed() const { return m_bFailed; }
+
+    /**
+     * @brief 等待共享状态就绪
+     * @note 多核时先自旋一小段时间，短任务通常在自旋期间完成，不必挂起
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待；被虚假唤醒时重新计时，超时只是近似值
+     * @return BOOL TRUE 已就绪，FALSE 超时
+     */
+    BOOL wait(DWORD v_dwMilliseconds = INFINITE)
+    {
+        for (int i = default_spin_count(); i > 0; --i)
+        {
+            if (m_nState == READY)
+            {
+                memory_barrier(); // 之后读取的结果不会早于就绪标志
+                return TRUE;
+            }
+            cpu_relax();
+        }
+
+        if (InterlockedCompareExchange(&m_nState, WAITING, PENDING) != READY)
+        {
+            while (m_nState != READY)
+            {
+                if (!futex::wait(&m_nState, WAITING, v_dwMilliseconds) && m_nState != READY)
+                {
+                    return FALSE;
+                }
+            }
+        }
+        memory_barrier();
+        return TRUE;
+    }
+
+    /**
+     * @brief 注册就绪回调，在置为就绪的线程中执行；已就绪时立即在当前线程执行
+     * @param [in] v_func 回调函数
+     * @param [in] v_param 回调参数
+     */
+    void on_ready(void (*v_func)(void *), void *v_param)
+    {
+        continuation *pNode = object_pool<continuation>::create();
+        pNode->m_func = v_func;
+        pNode->m_param = v_param;
+        while (TRUE)
+        {
+            continuation *pHead = m_pContinuations;
+            if (pHead == closed())
+            {
+                object_pool<continuation>::destroy(pNode);
+                v_func(v_param);
+                return;
+            }
+
+            pNode->m_pNext = pHead;
+            if (InterlockedCompareExchangePointer(reinterpret_cast<void *volatile *>(&m_pContinuations), pNode,
+                                                  pHead) == pHead)
+            {
+                return;
+            }
+        }
+    }
+
+protected:
+    /**
+     * @brief 置为就绪，唤醒挂起的等待者并执行就绪回调，只能调用一次
+     * @param [in] v_bFailed 是否失败（promise未设置值即析构或异步任务抛出异常）
+     */
+    void set_ready(BOOL v_bFailed = FALSE)
+    {
+        m_bFailed = v_bFailed;
+        if (InterlockedExchange(&m_nState, READY) == WAITING)
+        {
+            futex::wake(&m_nState, INT_MAX);
+        }
+
+        // 关闭回调链表，之后注册的回调直接执行；链表为后进先出，倒序后按注册顺序执行
+        continuation *pList = static_cast<continuation *>(
+            InterlockedExchangePointer(reinterpret_cast<void *volatile *>(&m_pContinuations), closed()));
+        continuation *pOrdered = NULL;
+        while (pList)
+        {
+            continuation *pNext = pList->m_pNext;
+            pList->m_pNext = pOrdered;
+            pOrdered = pList;
+            pList = pNext;
+        }
+        while (pOrdered)
+        {
+            continuation *pNext = pOrdered->m_pNext;
+            pOrdered->m_func(pOrdered->m_param);
+            object_pool<continuation>::destroy(pOrdered);
+            pOrdered = pNext;
+        }
+    }
+
+    /**
+     * @brief 引用计数归零时释放自身，派生类归还到各自大小的对象池
+     */
+    virtual void destroy() = 0;
+
+private:
+    /**
+     * @brief 回调链表已关闭的标记
+     */
+    static continuation *closed()
+    {
+        static continuation s_closed;
+        return &s_closed;
+    }
+
+private:
+    future_state_base(const future_state_base &);
+    future_state_base &operator=(const future_state_base &);
+
+private:
+    enum
+    {
+        PENDING = 0, // 未就绪，无人挂起
+        READY = 1,   // 已就绪
+        WAITING = 2  // 未就绪，有线程挂起等待
+    };
+
+    volatile LONG m_nState;                  // 状态字，同时作为futex等待地址
+    atomic<LONG> m_nRef;                     // 引用计数
+    volatile BOOL m_bFailed;                 // 是否失败
+    continuation *volatile m_pContinuations; // 就绪回调链表
+};
+
+/**
+ * @brief 带结果的共享状态
+ * @tparam T 结果类型，需可默认构造和复制
+ */
+template <typename T> class future_state : public future_state_base
+{
+public:
+    future_state() : m_tValue() {}
+
+public:
+    void set_value(const T &v_tValue)
+    {
+        m_tValue = v_tValue;
+        set_ready();
+    }
+    void set_failed() { set_ready(TRUE); }
+    const T &value() const { return m_tValue; }
+
+protected:
+    virtual void destroy() { object_pool<future_state>::destroy(this); }
+
+private:
+    T m_tValue; // 结果
+};
+
+/**
+ * @brief 无结果的共享状态
+ */
+template <> class future_state<void> : public future_state_base
+{
+public:
+    void set_value() { set_ready(); }
+    void set_failed() { set_ready(TRUE); }
+
+protected:
+    virtual void destroy() { object_pool<future_state>::destroy(this); }
+};
+
+/**
+ * @brief future公共部分，持有共享状态的一个引用
+ */
+class future_base
+{
+public:
+    future_base() : m_pState(NULL) {}
+    future_base(const future_base &v_other) : m_pState(v_other.m_pState)
+    {
+        if (m_pState)
+        {
+            m_pState->add_ref();
+        }
+    }
+    virtual ~future_base()
+    {
+        if (m_pState)
+        {
+            m_pState->release();
+        }
+    }
+    future_base &operator=(const future_base &v_other)
+    {
+        if (v_other.m_pState)
+        {
+            v_other.m_pState->add_ref();
+        }
+        if (m_pState)
+        {
+            m_pState->release();
+        }
+        m_pState = v_other.m_pState;
+        return *this;
+    }
+
+public:
+    BOOL valid() const { return m_pState != NULL; }
+    BOOL is_ready() const { return m_pState && m_pState->is_ready(); }
+
+    /**
+     * @brief 是否失败，promise未设置值即析构或异步任务抛出异常时为TRUE，此时get()返回默认值
+     */
+    BOOL failed() const { return m_pState && m_pState->failed(); }
+
+    void wait() const
+    {
+        if (m_pState)
+        {
+            m_pState->wait();
+        }
+    }
+
+    /**
+     * @brief 等待结果就绪
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 已就绪，FALSE 超时或future无效
+     */
+    BOOL wait_for(DWORD v_dwMilliseconds) const { return m_pState && m_pState->wait(v_dwMilliseconds); }
+
+    /**
+     * @brief 注册就绪回调，见future_state_base::on_ready()
+     * @note 回调执行时future可能已析构，回调参数的生存期由调用者保证
+     */
+    void on_ready(void (*v_func)(void *), void *v_param) const
+    {
+        if (m_pState)
+        {
+            m_pState->on_ready(v_func, v_param);
+        }
+        else
+        {
+            v_func(v_param);
+        }
+    }
+
+protected:
+    /**
+     * @brief 接管共享状态的一个引用
+     */
+    explicit future_base(future_state_base *v_pState) : m_pState(v_pState) {}
+
+protected:
+    future_state_base *m_pState; // 共享状态
+};
+
+/**
+ * @brief 仿照C++11的std::future，可复制，多个副本共享同一结果
+ * @tparam T 结果类型
+ */
+template <typename T> class future : public future_base
+{
+public:
+    future() {}
+    explicit future(future_state<T> *v_pState) : future_base(v_pState) {}
+
+public:
+    /**
+     * @brief 等待并返回结果，可多次调用
+     * @return T 结果的副本，future无效时返回默认值
+     */
+    T get() const
+    {
+        if (!m_pState)
+        {
+            return T();
+        }
+        m_pState->wait();
+        return static_cast<future_state<T> *>(m_pState)->value();
+    }
+};
+
+template <> class future<void> : public future_base
+{
+public:
+    future() {}
+    explicit future(future_state<void> *v_pState) : future_base(v_pState) {}
+
+public:
+    void get() const { wait(); }
+};
+
+/**
+ * @brief 仿照C++11的std::promise，不可复制
+ * @note 未设置值即析构时结果置为失败，等待者不会永远阻塞
+ * @tparam T 结果类型
+ */
+template <typename T> class promise
+{
+public:
+    promise() : m_pState(object_pool<future_state<T> >::create()), m_bSatisfied(FALSE) {}
+    virtual ~promise()
+    {
+        if (!m_bSatisfied)
+        {
+            m_pState->set_failed();
+        }
+        m_pState->release();
+    }
+
+public:
+    future<T> get_future()
+    {
+        m_pState->add_ref();
+        return future<T>(m_pState);
+    }
+
+    /**
+     * @brief 设置结果，只有第一次调用生效
+     */
+    void set_value(const T &v_tValue)
+    {
+        if (!m_bSatisfied)
+        {
+            m_bSatisfied = TRUE;
+            m_pState->set_value(v_tValue);
+        }
+    }
+
+private:
+    promise(const promise &);
+    promise &operator=(const promise &);
+
+private:
+    future_state<T> *m_pState; // 共享状态
+    BOOL m_bSatisfied;         // 是否已设置结果
+};
+
+template <> class promise<void>
+{
+public:
+    promise() : m_pState(object_pool<future_state<void> >::create()), m_bSatisfied(FALSE) {}
+    virtual ~promise()
+    {
+        if (!m_bSatisfied)
+        {
+            m_pState->set_failed();
+        }
+        m_pState->release();
+    }
+
+public:
+    future<void> get_future()
+    {
+        m_pState->add_ref();
+        return future<void>(m_pState);
+    }
+
+    void set_value()
+    {
+        if (!m_bSatisfied)
+        {
+            m_bSatisfied = TRUE;
+            m_pState->set_value();
+        }
+    }
+
+private:
+    promise(const promise &);
+    promise &operator=(const promise &);
+
+private:
+    future_state<void> *m_pState;
+    BOOL m_bSatisfied;
+};
+
+/**
+ * @brief when_all()的共享状态，计数归零时就绪
+ */
+class when_all_state : public future_state<void>
+{
+public:
+    when_all_state() : m_nPending(1), m_bAnyFailed(FALSE) {}
+
+public:
+    /**
+     * @brief 登记一个输入
+     */
+    void attach(const future_base &v_future)
+    {
+        if (v_future.is_ready())
+        {
+            if (v_future.failed())
+            {
+                m_bAnyFailed = TRUE;
+            }
+            return; // 已就绪的输入不计数，也不分配回调
+        }
+
+        ++m_nPending;
+        add_ref(); // 回调持有一个引用
+        v_future.on_ready(on_input_ready, new_input(v_future));
+    }
+
+    /**
+     * @brief 登记完毕，释放初始计数
+     */
+    void seal() { arrive(FALSE); }
+
+private:
+    struct input
+    {
+        when_all_state *m_pState;
+        future_base m_future; // 保持输入的共享状态，回调中查询是否失败
+    };
+
+    input *new_input(const future_base &v_future)
+    {
+        input *pInput = object_pool<input>::create();
+        pInput->m_pState = this;
+        pInput->m_future = v_future;
+        return pInput;
+    }
+
+    static void on_input_ready(void *v_param)
+    {
+        input *pInput = static_cast<input *>(v_param);
+        when_all_state *pState = pInput->m_pState;
+        BOOL bFailed = pInput->m_future.failed();
+        object_pool<input>::destroy(pInput);
+        pState->arrive(bFailed);
+        pState->release();
+    }
+
+    void arrive(BOOL v_bFailed)
+    {
+        if (v_bFailed)
+        {
+            m_bAnyFailed = TRUE;
+        }
+        if (--m_nPending == 0)
+        {
+            if (m_bAnyFailed)
+            {
+                set_failed();
+            }
+            else
+            {
+                set_value();
+            }
+        }
+    }
+
+protected:
+    virtual void destroy() { object_pool<when_all_state>::destroy(this); }
+
+private:
+    atomic<LONG> m_nPending;    // 未就绪的输入数，加上登记阶段的1
+    volatile BOOL m_bAnyFailed; // 是否有输入失败
+};
+
+/**
+ * @brief 汇合一组future，全部就绪后返回的future就绪，不阻塞当前线程
+ * @note 任一输入失败时返回的future也标记为失败
+ * @tparam InputIt 迭代器，元素为future<T>
+ * @param [in] v_itFirst 第一个future
+ * @param [in] v_itLast 最后一个future的下一个位置
+ * @return future<void> 汇合后的future
+ */
+template <typename InputIt>
+future<void> when_all(InputIt v_itFirst, InputIt v_itLast)
+{
+    when_all_state *pState = object_pool<when_all_state>::create();
+    for (; v_itFirst != v_itLast; ++v_itFirst)
+    {
+        pState->attach(*v_itFirst);
+    }
+    pState->seal();
+    return future<void>(pState);
+}
+
+/**
+ * @brief 阻塞等待一组future全部就绪
+ * @tparam InputIt 迭代器，元素为future<T>
+ * @param [in] v_itFirst 第一个future
+ * @param [in] v_itLast 最后一个future的下一个位置
+ */
+template <typename InputIt>
+void wait_all(InputIt v_itFirst, InputIt v_itLast)
+{
+    for (; v_itFirst != v_itLast; ++v_itFirst)
+    {
+        v_itFirst->wait();
+    }
+}
+
+#endif // FUTURE_HPP
\ No newline at end of file
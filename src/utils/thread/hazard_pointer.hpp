@@ -0,0 +1,378 @@
+﻿/**
+ * @file hazard_pointer.hpp
+ * @brief 风险指针（hazard pointer），无锁数据结构中被摘除节点的延迟释放，未释放的节点数有上界
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef HAZARD_POINTER_HPP
+#define HAZARD_POINTER_HPP
+
+#include <vector>
+
+#include "atomic.hpp"
+#include "object_pool.hpp"
+#include "thread_exit.hpp"
+
+/**
+ * @brief 风险指针域，全局一个
+ * @details 每个线程登记一条记录，记录中有SLOTS个风险指针槽。线程读取共享指针前先把它写入槽中并复查，
+ *          复查通过后该节点在槽清空前不会被释放；摘除的节点retire()到本线程的待回收链表，
+ *          链表长度达到阈值时扫描所有线程的槽，释放没有被任何槽引用的节点
+ * @note 阈值取所有槽总数的2倍（至少MIN_THRESHOLD），每次扫描至少释放一半节点，扫描用哈希表查找，
+ *       每个退休节点分摊的回收代价为O(1)；每个线程未释放的节点数不超过阈值，与读者持有节点的时间无关
+ * @note 与ebr相同：线程退出时经thread_exit自动注销，也可以提前调用detach()
+ */
+class hazard_domain
+{
+    friend class hazard_pointer;
+
+public:
+    enum
+    {
+        SLOTS = 4,         // 每条记录的风险指针槽数，一个线程同时持有更多hazard_pointer时自动追加记录
+        MIN_THRESHOLD = 64 // 触发扫描的最小待回收节点数
+    };
+
+private:
+    typedef atomic_detail::ops<void *> ptr_ops;
+    typedef atomic_detail::ops<LONG> long_ops;
+
+    /**
+     * @brief 退休节点
+     */
+    struct retired
+    {
+        void *m_p;              // 待释放的对象
+        void (*m_func)(void *); // 释放函数
+        retired *m_pNext;       // 下一个节点
+    };
+
+    /**
+     * @brief 线程登记记录，线程注销后留给其他线程复用，不释放
+     */
+    struct record
+    {
+        void *volatile m_slots[SLOTS]; // 风险指针槽，其他线程扫描时读取
+        char m_pad0[CACHE_LINE_SIZE];
+
+        volatile LONG m_nInUse; // 是否被某个线程占用
+        record *m_pNext;        // 登记链表的下一个记录，发布后不再修改
+        record *m_pOverflow;    // 同一线程追加的记录
+        UINT32 m_uiUsed;        // 已分配给hazard_pointer的槽，按位记录
+        retired *m_pRetired;    // 待回收链表
+        size_t m_nRetired;      // 待回收节点数
+        char m_pad1[CACHE_LINE_SIZE];
+    };
+
+    /**
+     * @brief 全局状态，类模板的静态成员在多个编译单元中只有一份定义，且都是零初始化的POD
+     */
+    template <int N>
+    struct globals
+    {
+        static record *volatile s_pRecords; // 登记链表，只增不减
+        static volatile LONG s_nRecords;    // 登记链表的记录数
+    };
+    typedef globals<0> g;
+
+public:
+    /**
+     * @brief 退休一个已从共享结构中摘除的对象，没有任何风险指针引用它时释放
+     * @param [in] v_p 对象
+     * @param [in] v_func 释放函数，在某个调用retire()/collect()的线程中执行
+     */
+    static void retire(void *v_p, void (*v_func)(void *))
+    {
+        record *pRecord = local_record();
+        retired *pNode = object_pool<retired>::create();
+        pNode->m_p = v_p;
+        pNode->m_func = v_func;
+        pNode->m_pNext = pRecord->m_pRetired;
+        pRecord->m_pRetired = pNode;
+
+        if (++pRecord->m_nRetired >= threshold())
+        {
+            scan(pRecord);
+        }
+    }
+
+    /**
+     * @brief 退休用new创建的对象，释放时delete
+     */
+    template <typename T>
+    static void retire(T *v_p)
+    {
+        retire(v_p, &delete_object<T>);
+    }
+
+    /**
+     * @brief 立即扫描一次，释放本线程中没有被引用的节点
+     * @return size_t 释放的节点数
+     */
+    static size_t collect() { return scan(local_record()); }
+
+    /**
+     * @brief 本线程尚未释放的节点数
+     */
+    static size_t pending() { return local() ? local()->m_nRetired : 0; }
+
+    /**
+     * @brief 所有线程尚未释放的节点数，不加锁统计，只是近似值
+     */
+    static size_t pending_total()
+    {
+        size_t nCount = 0;
+        for (record *p = g::s_pRecords; p; p = p->m_pNext)
+        {
+            nCount += *static_cast<volatile size_t *>(&p->m_nRetired);
+        }
+        return nCount;
+    }
+
+    /**
+     * @brief 注销当前线程，尚未释放的节点留在记录中，由下一个复用该记录的线程释放；
+     *        调用前当前线程不能持有hazard_pointer
+     */
+    static void detach()
+    {
+        record *pRecord = local();
+        if (!pRecord)
+        {
+            return;
+        }
+
+        scan(pRecord);
+        while (pRecord)
+        {
+            record *pOverflow = pRecord->m_pOverflow;
+            pRecord->m_pOverflow = NULL;
+            long_ops::store(&pRecord->m_nInUse, 0, memory_order_release);
+            pRecord = pOverflow;
+        }
+        local() = NULL;
+    }
+
+private:
+    template <typename T>
+    static void delete_object(void *v_p)
+    {
+        delete static_cast<T *>(v_p);
+    }
+
+    static record *&local()
+    {
+        static THREAD_LOCAL record *s_pRecord = NULL;
+        return s_pRecord;
+    }
+
+    static record *local_record()
+    {
+        record *&pLocal = local();
+        if (!pLocal)
+        {
+            thread_exit::at_exit(&hazard_domain::detach);
+            pLocal = acquire_record();
+        }
+        return pLocal;
+    }
+
+    /**
+     * @brief 取得一条记录，先复用已注销的记录，没有再新建
+     */
+    static record *acquire_record()
+    {
+        for (record *p = g::s_pRecords; p; p = p->m_pNext)
+        {
+            LONG nExpected = 0;
+            if (long_ops::load(&p->m_nInUse, memory_order_relaxed) == 0 &&
+                long_ops::compare_exchange(&p->m_nInUse, nExpected, 1, false, memory_order_acquire))
+            {
+                return p;
+            }
+        }
+
+        record *pRecord = new record();
+        pRecord->m_nInUse = 1;
+        pRecord->m_pNext = g::s_pRecords;
+        while (InterlockedCompareExchangePointer(reinterpret_cast<void *volatile *>(&g::s_pRecords), pRecord,
+                                                 pRecord->m_pNext) != pRecord->m_pNext)
+        {
+            pRecord->m_pNext = g::s_pRecords;
+        }
+        InterlockedIncrement(&g::s_nRecords);
+        return pRecord;
+    }
+
+    /**
+     * @brief 为hazard_pointer分配一个槽，本线程的记录都已占满时追加记录
+     * @param [out] v_nSlot 槽序号
+     * @return record* 槽所在的记录
+     */
+    static record *acquire_slot(int &v_nSlot)
+    {
+        for (record *p = local_record();; p = p->m_pOverflow)
+        {
+            for (int i = 0; i < SLOTS; ++i)
+            {
+                if (!(p->m_uiUsed & (1U << i)))
+                {
+                    p->m_uiUsed |= 1U << i;
+                    v_nSlot = i;
+                    return p;
+                }
+            }
+            if (!p->m_pOverflow)
+            {
+                p->m_pOverflow = acquire_record();
+            }
+        }
+    }
+
+    static void release_slot(record *v_pRecord, int v_nSlot)
+    {
+        ptr_ops::store(&v_pRecord->m_slots[v_nSlot], NULL, memory_order_release);
+        v_pRecord->m_uiUsed &= ~(1U << v_nSlot);
+    }
+
+    static size_t threshold()
+    {
+        size_t nThreshold = static_cast<size_t>(long_ops::load(&g::s_nRecords, memory_order_relaxed)) * SLOTS * 2;
+        return nThreshold < MIN_THRESHOLD ? static_cast<size_t>(MIN_THRESHOLD) : nThreshold;
+    }
+
+    static size_t hash(void *v_p) { return (reinterpret_cast<size_t>(v_p) >> 4) * 2654435761U; }
+
+    /**
+     * @brief 收集所有非空的槽放入开放寻址哈希表（装载因子不超过1/2），释放本线程待回收链表中不在表中的节点
+     */
+    static size_t scan(record *v_pRecord)
+    {
+        // 摘除节点（调用方的比较交换）先于读取各线程的槽，与读者的写槽、复查构成Dekker式互斥
+        atomic_thread_fence(memory_order_seq_cst);
+
+        // 先收集再建表：遍历期间其他线程可能追加记录，表的大小只能按实际收集到的个数确定
+        std::vector<void *> vecHazards;
+        for (record *p = g::s_pRecords; p; p = p->m_pNext)
+        {
+            for (int i = 0; i < SLOTS; ++i)
+            {
+                void *pHazard = ptr_ops::load(&p->m_slots[i], memory_order_acquire);
+                if (pHazard)
+                {
+                    vecHazards.push_back(pHazard);
+                }
+            }
+        }
+
+        size_t nSize = 16;
+        while (nSize < vecHazards.size() * 2)
+        {
+            nSize <<= 1;
+        }
+        std::vector<void *> vecTable(nSize, static_cast<void *>(NULL));
+        for (std::vector<void *>::const_iterator it = vecHazards.begin(); it != vecHazards.end(); ++it)
+        {
+            size_t nPos = hash(*it) & (nSize - 1);
+            while (vecTable[nPos] && vecTable[nPos] != *it)
+            {
+                nPos = (nPos + 1) & (nSize - 1);
+            }
+            vecTable[nPos] = *it;
+        }
+
+        // 先从记录上摘下整条链表再释放，释放函数中再次retire()不会干扰遍历
+        retired *pList = v_pRecord->m_pRetired;
+        v_pRecord->m_pRetired = NULL;
+        v_pRecord->m_nRetired = 0;
+        size_t nFreed = 0;
+        for (retired *pNext = NULL; pList; pList = pNext)
+        {
+            pNext = pList->m_pNext;
+            if (contains(vecTable, pList->m_p))
+            {
+                pList->m_pNext = v_pRecord->m_pRetired;
+                v_pRecord->m_pRetired = pList;
+                ++v_pRecord->m_nRetired;
+            }
+            else
+            {
+                pList->m_func(pList->m_p);
+                object_pool<retired>::destroy(pList);
+                ++nFreed;
+            }
+        }
+        return nFreed;
+    }
+
+    static BOOL contains(const std::vector<void *> &v_vecTable, void *v_p)
+    {
+        size_t nMask = v_vecTable.size() - 1;
+        for (size_t nPos = hash(v_p) & nMask; v_vecTable[nPos]; nPos = (nPos + 1) & nMask)
+        {
+            if (v_vecTable[nPos] == v_p)
+            {
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+};
+
+template <int N>
+hazard_domain::record *volatile hazard_domain::globals<N>::s_pRecords = NULL;
+template <int N>
+volatile LONG hazard_domain::globals<N>::s_nRecords = 0;
+
+/**
+ * @brief 风险指针，占用当前线程的一个槽，析构时归还
+ * @note 只能在创建它的线程中使用
+ */
+class hazard_pointer
+{
+public:
+    hazard_pointer() : m_pRecord(hazard_domain::acquire_slot(m_nSlot)) {}
+    ~hazard_pointer() { hazard_domain::release_slot(m_pRecord, m_nSlot); }
+
+public:
+    /**
+     * @brief 读取共享指针并加以保护，返回后在reset()或再次protect()之前该对象不会被释放
+     * @param [in] v_src 共享指针
+     * @return T* 受保护的指针，可能为NULL
+     */
+    template <typename T>
+    T *protect(const atomic<T *> &v_src)
+    {
+        T *p = v_src.load(memory_order_relaxed);
+        while (TRUE)
+        {
+            set(p);
+            T *pCheck = v_src.load(memory_order_acquire);
+            if (pCheck == p)
+            {
+                return p;
+            }
+            p = pCheck;
+        }
+    }
+
+    /**
+     * @brief 直接设置保护的指针，调用方需自行复查指针仍可达
+     */
+    void set(void *v_p)
+    {
+        hazard_domain::ptr_ops::store(&m_pRecord->m_slots[m_nSlot], v_p, memory_order_seq_cst);
+    }
+
+    void reset() { hazard_domain::ptr_ops::store(&m_pRecord->m_slots[m_nSlot], NULL, memory_order_release); }
+
+private:
+    hazard_pointer(const hazard_pointer &);
+    hazard_pointer &operator=(const hazard_pointer &);
+
+private:
+    int m_nSlot;                      // 槽序号
+    hazard_domain::record *m_pRecord; // 槽所在的记录
+};
+
+#endif // HAZARD_POINTER_HPP
\ No newline at end of file
@@ -0,0 +1,168 @@
+﻿/**
+ * @file latch.hpp
+ * @brief 一次性的倒计数门闩，以及可重复使用的任务计数器wait_group
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef LATCH_HPP
+#define LATCH_HPP
+
+#include "atomic.hpp"
+#include "futex.hpp"
+
+/**
+ * @brief 倒计数门闩，接口与C++20的std::latch一致
+ * @details 计数与“有等待者”标志合在同一个字里，该字同时作为futex等待地址：计数减到0的线程只有在标志置位时
+ *          才进入内核唤醒，等待方在计数已经为0时只有一次读取
+ * @note 计数减到0只有一次原子读改写，之后只按地址唤醒、不再访问对象，
+ *       与std::latch一样，wait()返回后即可销毁门闩，不必等count_down()的线程返回
+ */
+class latch
+{
+protected:
+    typedef atomic_detail::ops<LONG> ops;
+
+    enum
+    {
+        WAITERS_BIT = 1, // 有线程挂起或即将挂起
+        COUNT_SHIFT = 1, // 计数位于标志之上
+        COUNT_UNIT = 1 << COUNT_SHIFT
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nExpected 初始计数
+     */
+    explicit latch(LONG v_nExpected = 0) : m_nState(v_nExpected * COUNT_UNIT) {}
+    ~latch() {}
+
+public:
+    /**
+     * @brief 计数减v_nUpdate，减到0时唤醒所有等待线程
+     */
+    void count_down(LONG v_nUpdate = 1)
+    {
+        LONG nState = ops::load(&m_nState, memory_order_relaxed);
+        LONG nCount = 0;
+        LONG nNew = 0;
+        do
+        {
+            nCount = (nState >> COUNT_SHIFT) - v_nUpdate;
+            nNew = nCount == 0 ? 0 : (nCount * COUNT_UNIT) | (nState & WAITERS_BIT); // 减到0时同时清除标志
+        } while (!ops::compare_exchange(&m_nState, nState, nNew, true, memory_order_seq_cst));
+
+        // 交换成功后门闩可能已被销毁，只使用局部变量和地址
+        if (nCount == 0 && (nState & WAITERS_BIT))
+        {
+            futex::wake(&m_nState, INT_MAX);
+        }
+    }
+
+    /**
+     * @brief 计数是否已经为0
+     */
+    BOOL try_wait() const { return (ops::load(&m_nState, memory_order_acquire) >> COUNT_SHIFT) == 0; }
+
+    /**
+     * @brief 等待计数减到0
+     */
+    void wait() const { wait_for(INFINITE); }
+
+    /**
+     * @brief 等待计数减到0，直到超时
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 计数为0，FALSE 超时
+     */
+    BOOL wait_for(DWORD v_dwMilliseconds) const
+    {
+        LONG nState = ops::load(&m_nState, memory_order_acquire);
+        if ((nState >> COUNT_SHIFT) == 0)
+        {
+            return TRUE;
+        }
+
+        DWORD dwStart = tick_count();
+        while ((nState >> COUNT_SHIFT) != 0)
+        {
+            DWORD dwWait = INFINITE;
+            if (v_dwMilliseconds != INFINITE)
+            {
+                DWORD dwElapsed = tick_count() - dwStart;
+                if (dwElapsed >= v_dwMilliseconds)
+                {
+                    return FALSE; // 标志留给计数减到0的线程清除，最多多一次唤醒
+                }
+                dwWait = v_dwMilliseconds - dwElapsed;
+            }
+
+            // 先置位标志再挂起，置位失败说明计数已变化，重新检查
+            if ((nState & WAITERS_BIT) ||
+                ops::compare_exchange(&m_nState, nState, nState | WAITERS_BIT, false, memory_order_seq_cst))
+            {
+                futex::wait(&m_nState, nState | WAITERS_BIT, dwWait);
+                nState = ops::load(&m_nState, memory_order_acquire);
+            }
+        }
+        return TRUE;
+    }
+
+    /**
+     * @brief 计数减v_nUpdate后等待计数减到0
+     */
+    void arrive_and_wait(LONG v_nUpdate = 1)
+    {
+        count_down(v_nUpdate);
+        wait();
+    }
+
+private:
+    latch(const latch &);
+    latch &operator=(const latch &);
+
+protected:
+    mutable volatile LONG m_nState; // (计数 << COUNT_SHIFT) | WAITERS_BIT，同时作为futex等待地址
+};
+
+/**
+ * @brief 任务计数器，计数可以重新增加的门闩
+ * @details 提交任务前add()，任务完成后done()，wait()等待所有已提交的任务完成；
+ *          计数回到0后可以继续add()，等待中的线程醒来时若计数又变为非0则继续等待
+ */
+class wait_group : public latch
+{
+public:
+    wait_group() {}
+
+public:
+    /**
+     * @brief 增加未完成的任务数
+     */
+    void add(LONG v_nDelta = 1) { ops::fetch_add(&m_nState, v_nDelta * COUNT_UNIT, memory_order_relaxed); }
+
+    /**
+     * @brief 任务完成
+     */
+    void done(LONG v_nCount = 1) { count_down(v_nCount); }
+
+    /**
+     * @brief 未完成的任务数，只作为参考
+     */
+    LONG pending() const { return ops::load(&m_nState, memory_order_relaxed) >> COUNT_SHIFT; }
+
+    /**
+     * @brief 计数清零并唤醒等待线程，用于丢弃尚未执行的任务
+     * @note 不能与add()/done()并发调用
+     */
+    void reset()
+    {
+        LONG nCount = pending();
+        if (nCount != 0)
+        {
+            count_down(nCount);
+        }
+    }
+};
+
+#endif // LATCH_HPP
\ No newline at end of file
@@ -0,0 +1,129 @@
+﻿/**
+ * @file lock_free_queue.hpp
+ * @brief 无锁队列（Michael-Scott队列），用风险指针回收出队的节点
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef LOCK_FREE_QUEUE_HPP
+#define LOCK_FREE_QUEUE_HPP
+
+#include "hazard_pointer.hpp"
+
+/**
+ * @brief 无锁队列，多生产者多消费者，无容量限制
+ * @details 链表头部始终有一个哑节点，出队时取哑节点之后的元素，并让该节点成为新的哑节点、退休旧的哑节点；
+ *          入队把新节点接在尾节点之后，尾指针落后时由任一线程帮助推进
+ * @tparam T 元素类型，需可复制、可默认构造
+ */
+template <typename T> class lock_free_queue
+{
+    struct node
+    {
+        node() : m_value(), m_pNext(NULL) {}
+        node(const T &v_value) : m_value(v_value), m_pNext(NULL) {}
+
+        T m_value;
+        atomic<node *> m_pNext;
+    };
+
+public:
+    lock_free_queue() : m_pHead(NULL), m_pTail(NULL)
+    {
+        node *pDummy = new node();
+        m_pHead = pDummy;
+        m_pTail = pDummy;
+    }
+    virtual ~lock_free_queue()
+    {
+        node *p = m_pHead.load(memory_order_relaxed);
+        while (p)
+        {
+            node *pNext = p->m_pNext.load(memory_order_relaxed);
+            delete p;
+            p = pNext;
+        }
+    }
+
+public:
+    void push(const T &v_value)
+    {
+        node *pNode = new node(v_value);
+        hazard_pointer hp;
+        while (TRUE)
+        {
+            node *pTail = hp.protect(m_pTail);
+            node *pNext = pTail->m_pNext.load(memory_order_acquire);
+            if (pNext)
+            {
+                m_pTail.compare_exchange_weak(pTail, pNext); // 尾指针落后，帮助推进后重试
+                continue;
+            }
+
+            node *pExpected = NULL;
+            if (pTail->m_pNext.compare_exchange_strong(pExpected, pNode, memory_order_release))
+            {
+                m_pTail.compare_exchange_strong(pTail, pNode);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief 出队
+     * @param [out] v_value 队首元素
+     * @return BOOL FALSE 队列为空
+     */
+    BOOL pop(T &v_value)
+    {
+        hazard_pointer hpHead;
+        hazard_pointer hpNext;
+        while (TRUE)
+        {
+            node *pHead = hpHead.protect(m_pHead);
+            node *pNext = hpNext.protect(pHead->m_pNext);
+            if (pHead != m_pHead.load(memory_order_acquire))
+            {
+                continue; // 保护next期间头节点已出队，next可能已被释放
+            }
+            if (!pNext)
+            {
+                return FALSE;
+            }
+
+            node *pTail = m_pTail.load(memory_order_acquire);
+            if (pHead == pTail)
+            {
+                m_pTail.compare_exchange_weak(pTail, pNext); // 尾指针还指向哑节点，先推进，避免退休后仍被尾指针引用
+                continue;
+            }
+
+            if (m_pHead.compare_exchange_strong(pHead, pNext, memory_order_acq_rel))
+            {
+                v_value = pNext->m_value;
+                pNext->m_value = T(); // pNext成为新的哑节点，只有本线程访问其元素，清空后元素持有的资源不必等到节点回收
+                hpHead.reset();
+                hpNext.reset();
+                hazard_domain::retire(pHead);
+                return TRUE;
+            }
+        }
+    }
+
+    BOOL empty() const
+    {
+        node *pHead = m_pHead.load(memory_order_acquire);
+        return pHead->m_pNext.load(memory_order_acquire) == NULL;
+    }
+
+private:
+    lock_free_queue(const lock_free_queue &);
+    lock_free_queue &operator=(const lock_free_queue &);
+
+private:
+    atomic<node *> m_pHead; // 队首的哑节点，消费者修改
+    char m_pad[CACHE_LINE_SIZE - sizeof(atomic<node *>)];
+    atomic<node *> m_pTail; // 队尾节点，生产者修改
+};
+
+#endif // LOCK_FREE_QUEUE_HPP
\ No newline at end of file
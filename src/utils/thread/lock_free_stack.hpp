@@ -0,0 +1,89 @@
+﻿/**
+ * @file lock_free_stack.hpp
+ * @brief 无锁栈（Treiber栈），用风险指针回收出栈的节点
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef LOCK_FREE_STACK_HPP
+#define LOCK_FREE_STACK_HPP
+
+#include "hazard_pointer.hpp"
+
+/**
+ * @brief 无锁栈，多生产者多消费者
+ * @details 出栈时先用风险指针保护栈顶再读取其next，保证比较交换前栈顶节点不会被释放，
+ *          同时避免了节点被释放重用导致的ABA问题
+ * @tparam T 元素类型，需可复制
+ */
+template <typename T> class lock_free_stack
+{
+    struct node
+    {
+        node(const T &v_value) : m_value(v_value), m_pNext(NULL) {}
+
+        T m_value;
+        node *m_pNext;
+    };
+
+public:
+    lock_free_stack() : m_pHead(NULL) {}
+    virtual ~lock_free_stack()
+    {
+        node *p = m_pHead.load(memory_order_relaxed);
+        while (p)
+        {
+            node *pNext = p->m_pNext;
+            delete p;
+            p = pNext;
+        }
+    }
+
+public:
+    void push(const T &v_value)
+    {
+        node *pNode = new node(v_value);
+        pNode->m_pNext = m_pHead.load(memory_order_relaxed);
+        while (!m_pHead.compare_exchange_weak(pNode->m_pNext, pNode, memory_order_release))
+        {
+        }
+    }
+
+    /**
+     * @brief 出栈
+     * @param [out] v_value 栈顶元素
+     * @return BOOL FALSE 栈为空
+     */
+    BOOL pop(T &v_value)
+    {
+        hazard_pointer hp;
+        while (TRUE)
+        {
+            node *pHead = hp.protect(m_pHead);
+            if (!pHead)
+            {
+                return FALSE;
+            }
+
+            node *pNext = pHead->m_pNext;
+            if (m_pHead.compare_exchange_strong(pHead, pNext, memory_order_acquire))
+            {
+                v_value = pHead->m_value;
+                hp.reset();
+                hazard_domain::retire(pHead);
+                return TRUE;
+            }
+        }
+    }
+
+    BOOL empty() const { return m_pHead.load(memory_order_relaxed) == NULL; }
+
+private:
+    lock_free_stack(const lock_free_stack &);
+    lock_free_stack &operator=(const lock_free_stack &);
+
+private:
+    atomic<node *> m_pHead; // 栈顶
+};
+
+#endif // LOCK_FREE_STACK_HPP
\ No newline at end of file
@@ -0,0 +1,177 @@
+﻿/**
+ * @file mailbox.hpp
+ * @brief 基于侵入式多生产者单消费者队列的信箱，有消息时由线程池的工作线程处理
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef MAILBOX_HPP
+#define MAILBOX_HPP
+
+#include "mpsc_queue.hpp"
+#include "thread_pool.hpp"
+
+class mailbox_base;
+
+/**
+ * @brief 信箱调度器，把有消息的信箱作为任务提交到线程池
+ * @details 每个信箱同一时刻最多只有一个任务在线程池中，因此同一信箱的消息按入队顺序串行处理，
+ *          处理时不需要加锁；不同信箱的消息由不同工作线程并行处理
+ * @note 仍有消息的信箱由工作线程重新提交，线程池的共享队列有容量限制时可能所有工作线程都阻塞在提交上，
+ *       应使用无限容量（v_nQueueSize为0）或工作窃取模式的线程池
+ */
+class mailbox_scheduler
+{
+public:
+    enum
+    {
+        DEFAULT_THROUGHPUT = 64 // 默认每次调度最多处理的消息数
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_pool 执行信箱的线程池，需比调度器和信箱存活得更久
+     * @param [in] v_nThroughput 每次调度最多处理的消息数，处理完仍有消息时重新提交，避免一个信箱长期占用工作线程
+     */
+    mailbox_scheduler(thread_pool &v_pool, size_t v_nThroughput = DEFAULT_THROUGHPUT)
+        : m_pool(v_pool), m_nThroughput(v_nThroughput ? v_nThroughput : 1)
+    {
+    }
+    virtual ~mailbox_scheduler() {}
+
+public:
+    /**
+     * @brief 提交信箱到线程池
+     */
+    void schedule(mailbox_base *v_pMailbox);
+
+    /**
+     * @brief 等待所有已投递的消息处理完
+     */
+    void wait() { m_pool.wait(); }
+
+    size_t throughput() const { return m_nThroughput; }
+
+private:
+    mailbox_scheduler(const mailbox_scheduler &);
+    mailbox_scheduler &operator=(const mailbox_scheduler &);
+
+private:
+    thread_pool &m_pool;  // 执行信箱的线程池
+    size_t m_nThroughput; // 每次调度最多处理的消息数
+};
+
+/**
+ * @brief 信箱基类，负责调度状态，与消息类型无关
+ */
+class mailbox_base
+{
+    friend class mailbox_scheduler;
+
+public:
+    mailbox_base(mailbox_scheduler &v_scheduler) : m_scheduler(v_scheduler), m_nScheduled(0) {}
+    virtual ~mailbox_base() {}
+
+protected:
+    /**
+     * @brief 处理至多v_nMax个消息
+     * @return size_t 处理的消息数
+     */
+    virtual size_t drain(size_t v_nMax) = 0;
+
+    /**
+     * @brief 是否还有未处理的消息，只在处理消息的线程中调用
+     */
+    virtual BOOL has_message() const = 0;
+
+    /**
+     * @brief 投递消息之后调用，信箱空闲时提交到线程池
+     */
+    void notify()
+    {
+        // 原子交换带完整屏障，与run()中清除标志后的检查配对，消息不会无人处理
+        if (m_nScheduled.exchange(1) == 0)
+        {
+            m_scheduler.schedule(this);
+        }
+    }
+
+private:
+    static void run(void *v_param)
+    {
+        mailbox_base *pMailbox = static_cast<mailbox_base *>(v_param);
+        pMailbox->drain(pMailbox->m_scheduler.throughput());
+
+        // 先清除调度标志再检查消息，此后投递的线程会重新提交；检查到消息时由抢到标志的一方提交
+        pMailbox->m_nScheduled.exchange(0);
+        if (pMailbox->has_message() && pMailbox->m_nScheduled.exchange(1) == 0)
+        {
+            pMailbox->m_scheduler.schedule(pMailbox);
+        }
+    }
+
+private:
+    mailbox_base(const mailbox_base &);
+    mailbox_base &operator=(const mailbox_base &);
+
+private:
+    mailbox_scheduler &m_scheduler; // 所属的调度器
+    atomic<LONG> m_nScheduled;      // 是否已提交到线程池或正在处理
+};
+
+inline void mailbox_scheduler::schedule(mailbox_base *v_pMailbox)
+{
+    m_pool.submit(task_func(&mailbox_base::run, v_pMailbox));
+}
+
+/**
+ * @brief 信箱，投递的消息由线程池串行处理
+ * @details 消息内嵌队列节点，投递不分配内存、不加锁；处理消息的线程不加锁出队。
+ *          派生类实现on_message()，消息的所有权随之转交，由派生类负责释放
+ * @note 销毁信箱前需保证没有线程再投递消息，且已投递的消息都已处理完（如mailbox_scheduler::wait()）
+ * @tparam M 消息类型，需从mpsc_node派生
+ */
+template <typename M> class mailbox : public mailbox_base
+{
+public:
+    mailbox(mailbox_scheduler &v_scheduler) : mailbox_base(v_scheduler) {}
+    virtual ~mailbox() {}
+
+public:
+    /**
+     * @brief 投递消息，任意线程可调用
+     * @param [in] v_pMsg 消息，处理之前不能再次投递
+     */
+    void post(M *v_pMsg)
+    {
+        m_queue.push(v_pMsg);
+        notify();
+    }
+
+protected:
+    /**
+     * @brief 处理一个消息，同一信箱的调用不会并发
+     */
+    virtual void on_message(M *v_pMsg) = 0;
+
+private:
+    virtual size_t drain(size_t v_nMax)
+    {
+        size_t nCount = 0;
+        M *pMsg = NULL;
+        while (nCount < v_nMax && (pMsg = m_queue.pop()) != NULL)
+        {
+            on_message(pMsg);
+            ++nCount;
+        }
+        return nCount;
+    }
+
+    virtual BOOL has_message() const { return !m_queue.empty(); }
+
+private:
+    mpsc_queue<M> m_queue; // 消息队列
+};
+
+#endif // MAILBOX_HPP
\ No newline at end of file
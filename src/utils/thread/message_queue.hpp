@@ -8,6 +8,7 @@
 #ifndef MESSAGE_QUEUE_HPP
 #define MESSAGE_QUEUE_HPP
 
+#include <algorithm>
 #include <deque>
 #include "mutex.hpp"
 #include "condition_variable.hpp"
@@ -48,6 +49,103 @@ public:
         m_cvGet.notify_one();
     }
 
+    /**
+     * @brief 向队列尾部批量添加消息，一次加锁添加尽可能多的消息，队列满时等待
+     * @tparam InputIt 输入迭代器，元素可转换为T
+     * @param [in] v_itFirst 第一个消息
+     * @param [in] v_nCount 消息个数
+     */
+    template <typename InputIt>
+    void push_back_bulk(InputIt v_itFirst, size_t v_nCount)
+    {
+        unique_lock_ lock(m_mutexPut);
+        while (v_nCount > 0)
+        {
+            while (put_deque_full())
+            {
+                m_cvGet.notify_one();
+                m_cvPut.wait(lock);
+            }
+
+            size_t nPush = v_nCount;
+            if (m_nCapacity > 0 && m_nCapacity - m_dequePut.size() < nPush)
+            {
+                nPush = m_nCapacity - m_dequePut.size();
+            }
+
+            for (size_t i = 0; i < nPush; ++i, ++v_itFirst)
+            {
+                m_dequePut.push_back(T(*v_itFirst));
+            }
+            v_nCount -= nPush;
+
+            if (nPush > 1)
+            {
+                m_cvGet.notify_all();
+            }
+            else
+            {
+                m_cvGet.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief 向队列尾部添加[v_itFirst, v_itLast)中的消息，一次加锁添加尽可能多的消息，队列满时等待
+     * @tparam InputIt 输入迭代器，元素可转换为T
+     * @param [in] v_itFirst 第一个消息
+     * @param [in] v_itLast 最后一个消息的下一个位置
+     */
+    template <typename InputIt>
+    void push_back_range(InputIt v_itFirst, InputIt v_itLast)
+    {
+        unique_lock_ lock(m_mutexPut);
+        while (v_itFirst != v_itLast)
+        {
+            while (put_deque_full())
+            {
+                m_cvGet.notify_one();
+                m_cvPut.wait(lock);
+            }
+
+            size_t nPush = 0;
+            for (; v_itFirst != v_itLast && !put_deque_full(); ++v_itFirst, ++nPush)
+            {
+                m_dequePut.push_back(T(*v_itFirst));
+            }
+
+            if (nPush > 1)
+            {
+                m_cvGet.notify_all();
+            }
+            else
+            {
+                m_cvGet.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief 把v_deque中的全部消息添加到队列尾部，返回时v_deque为空
+     * @note 生产者队列为空且容量足够时直接交换，不复制消息；否则按push_back_range()逐个复制
+     * @param [in,out] v_deque 要添加的消息
+     */
+    void push_back_all(deque_& v_deque)
+    {
+        {
+            unique_lock_ lock(m_mutexPut);
+            if (m_dequePut.empty() && (m_nCapacity == 0 || v_deque.size() <= m_nCapacity))
+            {
+                m_dequePut.swap(v_deque);
+                m_cvGet.notify_all();
+                return;
+            }
+        }
+
+        push_back_range(v_deque.begin(), v_deque.end());
+        v_deque.clear();
+    }
+
     /**
      * @brief 尝试向队列尾部添加消息
      * @param [in] v_tMsg 消息内容
@@ -99,39 +197,121 @@ public:
     void pop(T& v_tMsg)
     {
         unique_lock_ lockGet(m_mutexGet);
-        if (m_dequeGet.empty())
+        wait_not_empty(lockGet);
+
+        v_tMsg = m_dequeGet.front();
+        m_dequeGet.pop_front();
+
+        if (all_deque_empty())
         {
-            unique_lock_ lockPut(m_mutexPut);
+            m_cvPut.notify_all();
+        }
+    }
 
-            unsigned int nTimeOuts = 0;
-            while (all_deque_empty())
-            {
-                // 避免死锁，设置超时时间
-                if (nTimeOuts < 1000)
-                {
-                    nTimeOuts += 50;
-                }
+    /**
+     * @brief 批量弹出队列头部消息，一次加锁弹出多个
+     * @note 若队列为空，则等待直到队列不为空；
+     * @param [out] v_pMsgs 弹出的消息，至少能容纳v_nMax个
+     * @param [in] v_nMax 最多弹出的消息个数
+     * @param [in] v_nShare 共同消费的线程数，最多只取走已有消息的1/v_nShare（向上取整），避免一个消费者取走全部消息
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return size_t 实际弹出的消息个数，超时返回0
+     */
+    size_t pop_bulk(T* v_pMsgs, size_t v_nMax, size_t v_nShare = 1, DWORD v_dwMilliseconds = INFINITE)
+    {
+        unique_lock_ lockGet(m_mutexGet);
+        if (!wait_not_empty(lockGet, v_dwMilliseconds))
+        {
+            return 0;
+        }
 
-                m_cvPut.notify_all();
+        size_t nPop = (m_dequeGet.size() + v_nShare - 1) / (v_nShare > 0 ? v_nShare : 1);
+        if (nPop > v_nMax)
+        {
+            nPop = v_nMax;
+        }
+        if (nPop == 0)
+        {
+            nPop = 1;
+        }
 
-                lockPut.unlock();
-                m_cvGet.wait_for(lockGet, nTimeOuts);
-                lockPut.lock();
-            }
+        for (size_t i = 0; i < nPop; ++i)
+        {
+            v_pMsgs[i] = m_dequeGet.front();
+            m_dequeGet.pop_front();
+        }
 
-            if (m_dequeGet.empty())
+        if (all_deque_empty())
+        {
+            m_cvPut.notify_all();
+        }
+        return nPop;
+    }
+
+    /**
+     * @brief 弹出队列中的全部消息，一次加锁完成
+     * @note 若队列为空，则等待直到队列不为空；消费者队列直接交换给调用方，不复制消息，
+     *       只有消费者队列中已有消息（之前用pop()等取走过一部分）时，生产者队列中的消息才被复制追加
+     * @param [out] v_deque 弹出的消息，原有内容被清除
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return size_t 弹出的消息个数，超时返回0
+     */
+    size_t pop_all(deque_& v_deque, DWORD v_dwMilliseconds = INFINITE)
+    {
+        v_deque.clear();
+
+        unique_lock_ lockGet(m_mutexGet);
+        if (!wait_not_empty(lockGet, v_dwMilliseconds))
+        {
+            return 0;
+        }
+
+        v_deque.swap(m_dequeGet);
+        {
+            lock_guard_ lockPut(m_mutexPut);
+            if (!m_dequePut.empty())
             {
-                m_dequeGet.swap(m_dequePut);
+                v_deque.insert(v_deque.end(), m_dequePut.begin(), m_dequePut.end());
+                m_dequePut.clear();
             }
+            m_cvPut.notify_all();
         }
+        return v_deque.size();
+    }
 
-        v_tMsg = m_dequeGet.front();
-        m_dequeGet.pop_front();
+    /**
+     * @brief 弹出队列头部至多v_nMax个消息，一次加锁完成
+     * @note 若队列为空，则等待直到队列不为空；只取消费者队列中的消息，为空时先与生产者队列交换
+     * @tparam OutputIt 输出迭代器，可写入T
+     * @param [out] v_itOut 弹出的消息依次写入的位置
+     * @param [in] v_nMax 最多弹出的消息个数
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return size_t 实际弹出的消息个数，超时返回0
+     */
+    template <typename OutputIt>
+    size_t pop_n(OutputIt v_itOut, size_t v_nMax, DWORD v_dwMilliseconds = INFINITE)
+    {
+        if (v_nMax == 0)
+        {
+            return 0;
+        }
+
+        unique_lock_ lockGet(m_mutexGet);
+        if (!wait_not_empty(lockGet, v_dwMilliseconds))
+        {
+            return 0;
+        }
+
+        size_t nPop = m_dequeGet.size() < v_nMax ? m_dequeGet.size() : v_nMax;
+        typename deque_::iterator itEnd = m_dequeGet.begin() + static_cast<typename deque_::difference_type>(nPop);
+        std::copy(m_dequeGet.begin(), itEnd, v_itOut);
+        m_dequeGet.erase(m_dequeGet.begin(), itEnd);
 
         if (all_deque_empty())
         {
             m_cvPut.notify_all();
         }
+        return nPop;
     }
 
     /**
@@ -188,6 +368,47 @@ public:
     }
 
 private:
+    /**
+     * @brief 等待直到消费者队列不为空，消费者队列为空时与生产者队列交换
+     * @note 需在持有消费者队列锁的状态下调用
+     * @param [in] v_lockGet 消费者队列锁
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return BOOL TRUE 队列不为空，FALSE 超时
+     */
+    BOOL wait_not_empty(unique_lock_& v_lockGet, DWORD v_dwMilliseconds = INFINITE)
+    {
+        if (m_dequeGet.empty())
+        {
+            unique_lock_ lockPut(m_mutexPut);
+
+            DWORD dwStart = tick_count();
+            while (all_deque_empty())
+            {
+                DWORD dwWait = INFINITE;
+                if (v_dwMilliseconds != INFINITE)
+                {
+                    DWORD dwElapsed = tick_count() - dwStart;
+                    if (dwElapsed >= v_dwMilliseconds)
+                    {
+                        return FALSE;
+                    }
+                    dwWait = v_dwMilliseconds - dwElapsed;
+                }
+
+                m_cvPut.notify_all();
+
+                // 持有生产者队列锁时登记等待，生产者入队后的通知不会丢失，无需定时醒来检查
+                m_cvGet.wait_for(v_lockGet, lockPut, dwWait);
+            }
+
+            if (m_dequeGet.empty())
+            {
+                m_dequeGet.swap(m_dequePut);
+            }
+        }
+        return TRUE;
+    }
+
     /**
      * @brief 尝试交换生产者队列和消费者队列
      * @note 需在锁定状态下调用
@@ -239,6 +460,8 @@ private:
     mutex m_mutexGet;           // 消费者队列锁
     condition_variable m_cvGet; // 消费者条件变量
 
+    char m_pad[CACHE_LINE_SIZE]; // 隔开消费者和生产者两部分，避免两边的锁和队列落在同一缓存行
+
     deque_ m_dequePut;          // 生产者队列
     mutex m_mutexPut;           // 生产者队列锁
     condition_variable m_cvPut; // 生产者条件变量
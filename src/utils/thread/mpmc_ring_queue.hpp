@@ -0,0 +1,318 @@
+﻿/**
+ * @file mpmc_ring_queue.hpp
+ * @brief 无锁有界多生产者多消费者环形队列
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef MPMC_RING_QUEUE_HPP
+#define MPMC_RING_QUEUE_HPP
+
+#include <new>
+
+#include "atomic.hpp"
+#include "event_count.hpp"
+
+/**
+ * @brief 无锁有界多生产者多消费者环形队列，接口与message_queue一致
+ * @details 采用Vyukov的算法：槽位数为2的幂，每个槽位带序列号，生产者和消费者各自用一次CAS抢占下标，
+ *          通过槽位序列号判断槽位是否可写/可读；每个槽位独占缓存行，相邻槽位的读写互不干扰
+ * @note 只有队列确实满/空时才通过事件计数器阻塞，不会超时轮询
+ * @note 环形队列无法在头部插入，push_front()等同于push_back()
+ * @tparam T 消息类型，需可默认构造和复制
+ */
+template <typename T> class mpmc_ring_queue
+{
+    struct slot
+    {
+        atomic<LONG> m_nSeq; // 序列号，等于下标时可写，等于下标+1时可读
+        T m_tData;           // 消息内容
+    };
+
+    /**
+     * @brief 填充到缓存行整数倍的槽位
+     */
+    struct padded_slot : public slot
+    {
+        char m_pad[CACHE_LINE_SIZE - sizeof(slot) % CACHE_LINE_SIZE];
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nCapacity 队列容量，会向上取整为2的幂，0表示使用默认容量
+     */
+    mpmc_ring_queue(size_t v_nCapacity = 10000) : m_nEnqueuePos(0), m_nDequeuePos(0)
+    {
+        size_t nCapacity = 2;
+        while (nCapacity < (v_nCapacity == 0 ? static_cast<size_t>(DEFAULT_CAPACITY) : v_nCapacity))
+        {
+            nCapacity <<= 1;
+        }
+        m_nMask = nCapacity - 1;
+
+        // 按缓存行对齐分配槽位
+        m_pBuffer = new char[sizeof(padded_slot) * nCapacity + CACHE_LINE_SIZE];
+        size_t nOffset = reinterpret_cast<size_t>(m_pBuffer) % CACHE_LINE_SIZE;
+        m_pSlots = reinterpret_cast<padded_slot *>(m_pBuffer + (nOffset ? CACHE_LINE_SIZE - nOffset : 0));
+        for (size_t i = 0; i < nCapacity; ++i)
+        {
+            new (&m_pSlots[i]) padded_slot();
+            m_pSlots[i].m_nSeq = static_cast<LONG>(i);
+        }
+    }
+    virtual ~mpmc_ring_queue()
+    {
+        for (size_t i = 0; i <= m_nMask; ++i)
+        {
+            m_pSlots[i].~padded_slot();
+        }
+        delete[] m_pBuffer;
+    }
+
+public:
+    /**
+     * @brief 向队列尾部添加消息，队列满时阻塞
+     * @param [in] v_tMsg 消息内容
+     */
+    void push_back(const T &v_tMsg)
+    {
+        while (!try_push_back(v_tMsg))
+        {
+            LONG nKey = m_ecNotFull.prepare_wait();
+            if (try_push_back(v_tMsg))
+            {
+                m_ecNotFull.cancel_wait();
+                return;
+            }
+            m_ecNotFull.commit_wait(nKey);
+        }
+    }
+
+    /**
+     * @brief 尝试向队列尾部添加消息
+     * @param [in] v_tMsg 消息内容
+     * @return BOOL 是否成功添加，只有队列满时失败
+     */
+    BOOL try_push_back(const T &v_tMsg)
+    {
+        LONG nPos = m_nEnqueuePos;
+        padded_slot *pSlot = NULL;
+        while (TRUE)
+        {
+            pSlot = &m_pSlots[static_cast<size_t>(nPos) & m_nMask];
+            LONG nDiff = distance(nPos, pSlot->m_nSeq);
+            if (nDiff == 0)
+            {
+                if (m_nEnqueuePos.compare_exchange_strong(nPos, advance(nPos, 1)))
+                {
+                    break;
+                }
+            }
+            else if (nDiff < 0)
+            {
+                return FALSE; // 槽位尚未被消费，队列已满
+            }
+            else
+            {
+                nPos = m_nEnqueuePos; // 被其他生产者抢先，重新读取
+            }
+        }
+
+        pSlot->m_tData = v_tMsg;
+        pSlot->m_nSeq = advance(nPos, 1);
+        m_ecNotEmpty.notify_one();
+        return TRUE;
+    }
+
+    /**
+     * @brief 向队列尾部批量添加消息，队列满时等待
+     * @tparam InputIt 输入迭代器，元素可转换为T
+     * @param [in] v_itFirst 第一个消息
+     * @param [in] v_nCount 消息个数
+     */
+    template <typename InputIt>
+    void push_back_bulk(InputIt v_itFirst, size_t v_nCount)
+    {
+        for (size_t i = 0; i < v_nCount; ++i, ++v_itFirst)
+        {
+            push_back(T(*v_itFirst));
+        }
+    }
+
+    /**
+     * @brief 向队列头部添加消息，环形队列不支持头部插入，等同于push_back()
+     * @param [in] v_tMsg 消息内容
+     */
+    void push_front(const T &v_tMsg) { push_back(v_tMsg); }
+
+    /**
+     * @brief 将队列头部消息弹出，队列为空时阻塞
+     * @param [out] v_tMsg 弹出的消息内容
+     */
+    void pop(T &v_tMsg)
+    {
+        while (!try_pop(v_tMsg))
+        {
+            LONG nKey = m_ecNotEmpty.prepare_wait();
+            if (try_pop(v_tMsg))
+            {
+                m_ecNotEmpty.cancel_wait();
+                return;
+            }
+            m_ecNotEmpty.commit_wait(nKey);
+        }
+    }
+
+    /**
+     * @brief 将队列头部消息弹出，队列为空时最多等待v_dwMilliseconds毫秒
+     * @param [out] v_tMsg 弹出的消息内容
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL 是否成功弹出
+     */
+    BOOL pop(T &v_tMsg, DWORD v_dwMilliseconds)
+    {
+        DWORD dwStart = tick_count();
+        while (!try_pop(v_tMsg))
+        {
+            DWORD dwElapsed = tick_count() - dwStart;
+            if (dwElapsed >= v_dwMilliseconds)
+            {
+                return FALSE;
+            }
+
+            LONG nKey = m_ecNotEmpty.prepare_wait();
+            if (try_pop(v_tMsg))
+            {
+                m_ecNotEmpty.cancel_wait();
+                return TRUE;
+            }
+            m_ecNotEmpty.commit_wait(nKey, v_dwMilliseconds - dwElapsed);
+        }
+        return TRUE;
+    }
+
+    /**
+     * @brief 批量弹出队列头部消息，队列为空时阻塞
+     * @param [out] v_pMsgs 弹出的消息，至少能容纳v_nMax个
+     * @param [in] v_nMax 最多弹出的消息个数
+     * @param [in] v_nShare 共同消费的线程数，最多只取走已有消息的1/v_nShare（向上取整）
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return size_t 实际弹出的消息个数，超时返回0
+     */
+    size_t pop_bulk(T *v_pMsgs, size_t v_nMax, size_t v_nShare = 1, DWORD v_dwMilliseconds = INFINITE)
+    {
+        if (v_dwMilliseconds == INFINITE)
+        {
+            pop(v_pMsgs[0]);
+        }
+        else if (!pop(v_pMsgs[0], v_dwMilliseconds))
+        {
+            return 0;
+        }
+
+        size_t nMax = (size() + v_nShare) / (v_nShare > 0 ? v_nShare : 1);
+        if (nMax > v_nMax)
+        {
+            nMax = v_nMax;
+        }
+
+        size_t nPop = 1;
+        while (nPop < nMax && try_pop(v_pMsgs[nPop]))
+        {
+            ++nPop;
+        }
+        return nPop;
+    }
+
+    /**
+     * @brief 尝试将队列头部消息弹出
+     * @param [out] v_tMsg 弹出的消息内容
+     * @return BOOL 是否成功弹出，只有队列空时失败
+     */
+    BOOL try_pop(T &v_tMsg)
+    {
+        LONG nPos = m_nDequeuePos;
+        padded_slot *pSlot = NULL;
+        while (TRUE)
+        {
+            pSlot = &m_pSlots[static_cast<size_t>(nPos) & m_nMask];
+            LONG nDiff = distance(advance(nPos, 1), pSlot->m_nSeq);
+            if (nDiff == 0)
+            {
+                if (m_nDequeuePos.compare_exchange_strong(nPos, advance(nPos, 1)))
+                {
+                    break;
+                }
+            }
+            else if (nDiff < 0)
+            {
+                return FALSE; // 槽位尚未写入，队列为空
+            }
+            else
+            {
+                nPos = m_nDequeuePos;
+            }
+        }
+
+        v_tMsg = pSlot->m_tData;
+        pSlot->m_tData = T(); // 不在槽位中保留副本，消息持有的资源随取出方释放，不必等到槽位被覆盖
+        pSlot->m_nSeq = advance(nPos, static_cast<LONG>(m_nMask + 1));
+        m_ecNotFull.notify_one();
+        return TRUE;
+    }
+
+public:
+    /**
+     * @brief 消息个数，并发修改时只是近似值
+     */
+    size_t size() const
+    {
+        LONG nSize = distance(m_nDequeuePos, m_nEnqueuePos);
+        return nSize > 0 ? static_cast<size_t>(nSize) : 0;
+    }
+    BOOL empty() const { return size() == 0; }
+    size_t capacity() const { return m_nMask + 1; }
+    void clear()
+    {
+        T tMsg;
+        while (try_pop(tMsg))
+        {
+        }
+    }
+
+private:
+    static LONG advance(LONG v_nPos, LONG v_nStep)
+    {
+        return static_cast<LONG>(static_cast<DWORD>(v_nPos) + static_cast<DWORD>(v_nStep));
+    }
+    static LONG distance(LONG v_nFrom, LONG v_nTo)
+    {
+        return static_cast<LONG>(static_cast<DWORD>(v_nTo) - static_cast<DWORD>(v_nFrom));
+    }
+
+private:
+    mpmc_ring_queue(const mpmc_ring_queue &);
+    mpmc_ring_queue &operator=(const mpmc_ring_queue &);
+
+private:
+    enum
+    {
+        DEFAULT_CAPACITY = 65536 // 容量为0时使用的默认容量
+    };
+
+    char m_pad0[CACHE_LINE_SIZE];
+    atomic<LONG> m_nEnqueuePos; // 生产者下标
+    char m_pad1[CACHE_LINE_SIZE - sizeof(atomic<LONG>)];
+    atomic<LONG> m_nDequeuePos; // 消费者下标
+    char m_pad2[CACHE_LINE_SIZE - sizeof(atomic<LONG>)];
+
+    padded_slot *m_pSlots; // 槽位数组，按缓存行对齐
+    char *m_pBuffer;       // 槽位数组的原始内存
+    size_t m_nMask;        // 下标掩码，容量-1
+
+    event_count m_ecNotEmpty; // 消费者在队列空时等待
+    event_count m_ecNotFull;  // 生产者在队列满时等待
+};
+
+#endif // MPMC_RING_QUEUE_HPP
\ No newline at end of file
@@ -0,0 +1,114 @@
+﻿/**
+ * @file mpsc_queue.hpp
+ * @brief 侵入式无锁多生产者单消费者队列，节点内嵌在消息中
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef MPSC_QUEUE_HPP
+#define MPSC_QUEUE_HPP
+
+#include "atomic.hpp"
+
+/**
+ * @brief 侵入式队列的节点，消息类型从它派生
+ */
+struct mpsc_node
+{
+    mpsc_node() : m_pNext(NULL) {}
+
+    atomic<mpsc_node *> m_pNext; // 下一个节点，只由队列使用
+};
+
+/**
+ * @brief 侵入式多生产者单消费者队列，无容量限制
+ * @details 采用Vyukov的算法：生产者用一次原子交换把节点设为新的头节点，再把前一个头节点的后继指向它，
+ *          入队不分配内存、不加锁、不重试；消费者从尾部沿后继指针取节点，只读写自己的尾指针，
+ *          队列中始终保留一个内嵌的哨兵节点，最后一个消息节点出队时把哨兵重新入队
+ * @note 生产者交换头节点之后、链接后继之前被挂起时，消费者看不到之后入队的节点，
+ *       pop()暂时返回NULL而empty()返回FALSE，稍后重试即可
+ * @note 队列不拥有节点，同一个节点在出队之前不能再次入队
+ * @tparam T 消息类型，需从mpsc_node派生
+ */
+template <typename T = mpsc_node> class mpsc_queue
+{
+public:
+    mpsc_queue() : m_pHead(&m_stub), m_pTail(&m_stub) {}
+    virtual ~mpsc_queue() {}
+
+public:
+    /**
+     * @brief 入队，任意线程可调用
+     * @param [in] v_pMsg 消息，出队前不能修改其中的节点
+     */
+    void push(T *v_pMsg) { push_node(static_cast<mpsc_node *>(v_pMsg)); }
+
+    /**
+     * @brief 出队，只能由消费者调用
+     * @return T* 队首消息，队列为空或有生产者正在入队时返回NULL
+     */
+    T *pop()
+    {
+        mpsc_node *pTail = m_pTail;
+        mpsc_node *pNext = pTail->m_pNext.load(memory_order_acquire);
+        if (pTail == &m_stub)
+        {
+            if (pNext == NULL)
+            {
+                return NULL;
+            }
+            // 跳过哨兵
+            m_pTail = pNext;
+            pTail = pNext;
+            pNext = pNext->m_pNext.load(memory_order_acquire);
+        }
+
+        if (pNext)
+        {
+            m_pTail = pNext;
+            return static_cast<T *>(pTail);
+        }
+
+        // 尾节点是最后一个已链接的节点，头节点不同说明有生产者尚未完成链接
+        if (pTail != m_pHead.load(memory_order_acquire))
+        {
+            return NULL;
+        }
+
+        // 重新放入哨兵，尾节点有了后继之后才能出队
+        push_node(&m_stub);
+        pNext = pTail->m_pNext.load(memory_order_acquire);
+        if (pNext)
+        {
+            m_pTail = pNext;
+            return static_cast<T *>(pTail);
+        }
+        return NULL;
+    }
+
+    /**
+     * @brief 是否为空，只能由消费者调用
+     * @note 有生产者正在入队时返回FALSE
+     */
+    BOOL empty() const { return m_pTail == &m_stub && m_pHead.load() == &m_stub; }
+
+private:
+    void push_node(mpsc_node *v_pNode)
+    {
+        v_pNode->m_pNext.store(NULL, memory_order_relaxed);
+        mpsc_node *pPrev = m_pHead.exchange(v_pNode, memory_order_acq_rel);
+        pPrev->m_pNext.store(v_pNode, memory_order_release);
+    }
+
+private:
+    mpsc_queue(const mpsc_queue &);
+    mpsc_queue &operator=(const mpsc_queue &);
+
+private:
+    atomic<mpsc_node *> m_pHead; // 头节点，生产者交换
+    char m_pad[CACHE_LINE_SIZE - sizeof(atomic<mpsc_node *>)];
+    mpsc_node *m_pTail; // 尾节点，只由消费者读写
+    mpsc_node m_stub;   // 哨兵节点
+};
+
+#endif // MPSC_QUEUE_HPP
\ No newline at end of file
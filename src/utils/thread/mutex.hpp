@@ -1,6 +1,6 @@
 ﻿/**
  * @file mutex.hpp
- * @brief C++98 windows下的互斥量实现
+ * @brief C++98 互斥量实现，windows下基于临界区，linux下基于futex
  * @author zhengw
  * @date 2024-05-28
  */
@@ -8,7 +8,12 @@
 #ifndef MUTEX_HPP
 #define MUTEX_HPP
 
-#include <windows.h>
+#include "platform.hpp"
+#if !defined(_WIN32)
+#include "futex.hpp"
+#endif
+
+class condition_variable;
 
 /**
  * @brief 局部锁的模板实现
@@ -16,6 +21,8 @@
 template <class T>
 struct unique_lock
 {
+    friend class condition_variable; // 条件变量等待后以竞争状态重新加锁，需直接更新加锁标志
+
 public:
     unique_lock(T& mutex) : m_mutex(mutex), m_bLocked(FALSE) { lock(); }
     ~unique_lock() { unlock(); }
@@ -43,6 +50,7 @@ private:
     BOOL m_bLocked;
 };
 
+#if defined(_WIN32)
 /**
  * @brief 互斥量
  */
@@ -61,5 +69,75 @@ public:
 private:
     CRITICAL_SECTION m_crit; // 临界区
 };
+#else
+/**
+ * @brief 互斥量，基于futex实现
+ * @note 状态字：0 未锁定，1 已锁定且无等待者，2 已锁定且可能有等待者；
+ *       无竞争时加锁、解锁各只需一次原子操作，不进入内核
+ */
+class mutex
+{
+public:
+    mutex() : m_iState(0) {}
+    ~mutex() {}
+
+public:
+    void lock()
+    {
+        int iState = 0;
+        if (__atomic_compare_exchange_n(&m_iState, &iState, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+
+        // 临界区通常很短，先短暂自旋，持有者很可能马上释放
+        for (int i = 0, nSpin = default_spin_count(); i < nSpin; ++i)
+        {
+            cpu_relax();
+            iState = 0;
+            if (__atomic_load_n(&m_iState, __ATOMIC_RELAXED) == 0 &&
+                __atomic_compare_exchange_n(&m_iState, &iState, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            {
+                return;
+            }
+        }
+
+        lock_contended();
+    }
+
+    void unlock()
+    {
+        if (__atomic_exchange_n(&m_iState, 0, __ATOMIC_RELEASE) == 2)
+        {
+            futex::wake(&m_iState, 1);
+        }
+    }
+
+    BOOL try_lock()
+    {
+        int iState = 0;
+        return __atomic_compare_exchange_n(&m_iState, &iState, 1, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED);
+    }
+
+private:
+    friend class condition_variable;
+
+    /**
+     * @brief 以"可能有等待者"状态加锁
+     * @note 标记为有等待者后挂起，被唤醒后同样以2抢锁，保证解锁方不会漏掉其他等待者；
+     *       条件变量把等待线程转移到本锁上之后，被唤醒的线程也必须这样加锁，否则其余被转移的线程无人唤醒
+     */
+    void lock_contended()
+    {
+        while (__atomic_exchange_n(&m_iState, 2, __ATOMIC_ACQUIRE) != 0)
+        {
+            futex::wait(&m_iState, 2);
+        }
+    }
+
+private:
+    volatile int m_iState; // 锁状态
+};
+#endif // _WIN32
 
 #endif // MUTEX_HPP
\ No newline at end of file
@@ -0,0 +1,121 @@
+﻿/**
+ * @file numa_thread_pool.hpp
+ * @brief 按NUMA节点分组的线程池
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef NUMA_THREAD_POOL_HPP
+#define NUMA_THREAD_POOL_HPP
+
+#include <vector>
+
+#include "thread_pool.hpp"
+#include "topology.hpp"
+
+/**
+ * @brief 按NUMA节点分组的线程池
+ * @details 每个NUMA节点一组工作线程，各自绑定在本节点的CPU上并拥有独立的任务队列；
+ *          submit()把任务放入提交线程当前所在节点的分组，任务访问的数据由同节点的线程首次写入时，
+ *          数据分配在本节点内存上，避免跨节点访问内存和跨节点的缓存一致性流量
+ * @note 分组之间不互相窃取任务，需要把任务交给指定节点时使用submit_to()
+ * @tparam Q 任务队列模板，同basic_thread_pool
+ */
+template <template <typename> class Q = message_queue>
+class basic_numa_thread_pool
+{
+public:
+    typedef basic_thread_pool<Q> group_pool; // 节点分组的线程池类型
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nThreadsPerNode 每个节点的线程数，0表示与节点的CPU数相同
+     * @param [in] v_nQueueSize 每个节点的任务队列容量，0表示无限容量
+     * @param [in] v_bPinPerCpu TRUE 每个工作线程绑定一个CPU，FALSE 工作线程可运行在本节点任意CPU
+     */
+    basic_numa_thread_pool(size_t v_nThreadsPerNode = 0, size_t v_nQueueSize = 1000, BOOL v_bPinPerCpu = TRUE)
+    {
+        for (size_t i = 0; i < m_topology.node_count(); ++i)
+        {
+            const cpu_set &cpus = m_topology.node_cpus(i);
+            group_pool *pPool = new group_pool(v_nThreadsPerNode ? v_nThreadsPerNode : cpus.count(), v_nQueueSize);
+            pPool->pin_workers(cpus, v_bPinPerCpu);
+            m_vecGroups.push_back(pPool);
+        }
+    }
+    virtual ~basic_numa_thread_pool()
+    {
+        for (size_t i = 0; i < m_vecGroups.size(); ++i)
+        {
+            delete m_vecGroups[i];
+        }
+    }
+
+public:
+    /**
+     * @brief 提交任务到调用线程当前所在节点的分组
+     */
+    void submit(const task &v_task) { local_group().submit(v_task); }
+
+    /**
+     * @brief 提交任务到指定节点的分组
+     * @param [in] v_nNode 节点序号，超过节点数时取模
+     * @param [in] v_task 任务
+     */
+    void submit_to(size_t v_nNode, const task &v_task) { group(v_nNode).submit(v_task); }
+
+    void submit_bulk(const task_func *v_pFirst, size_t v_nCount) { local_group().submit_bulk(v_pFirst, v_nCount); }
+    void submit(const task &v_task, int v_nPriority) { local_group().submit(v_task, v_nPriority); }
+    void submit_high(const task &v_task) { local_group().submit_high(v_task); }
+
+    template <typename R, typename A>
+    future<R> async(R (*v_func)(A), A v_arg)
+    {
+        return local_group().async(v_func, v_arg);
+    }
+
+    void stop()
+    {
+        for (size_t i = 0; i < m_vecGroups.size(); ++i)
+        {
+            m_vecGroups[i]->stop();
+        }
+    }
+
+    void wait()
+    {
+        for (size_t i = 0; i < m_vecGroups.size(); ++i)
+        {
+            m_vecGroups[i]->wait();
+        }
+    }
+
+public:
+    size_t node_count() const { return m_vecGroups.size(); }
+
+    /**
+     * @brief 调用线程当前所在的节点
+     */
+    size_t local_node() const { return m_topology.current_node(); }
+
+    /**
+     * @brief 指定节点的分组，可用于单独设置弹性线程数等
+     */
+    group_pool &group(size_t v_nNode) { return *m_vecGroups[v_nNode % m_vecGroups.size()]; }
+    group_pool &local_group() { return group(local_node()); }
+
+    const numa_topology &topology() const { return m_topology; }
+
+private:
+    basic_numa_thread_pool(const basic_numa_thread_pool &);
+    basic_numa_thread_pool &operator=(const basic_numa_thread_pool &);
+
+private:
+    numa_topology m_topology;              // NUMA拓扑
+    std::vector<group_pool *> m_vecGroups; // 每个节点一个分组
+};
+
+typedef basic_numa_thread_pool<> numa_thread_pool;
+
+#endif // NUMA_THREAD_POOL_HPP
\ No newline at end of file
@@ -0,0 +1,289 @@
+﻿/**
+ * @file object_pool.hpp
+ * @brief 定长内存块池，用于频繁分配释放的小对象
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef OBJECT_POOL_HPP
+#define OBJECT_POOL_HPP
+
+#include <new>
+
+#include "platform.hpp"
+#include "thread_exit.hpp"
+
+/**
+ * @brief 定长内存块池
+ * @details 每个线程缓存一条空闲链表，分配和释放通常只操作本线程的链表，不加锁；
+ *          本线程链表为空时从全局链表批量取回，过长时批量归还全局链表，全局链表由自旋锁保护
+ * @note 内存块不会归还给系统；线程缓存的内存块不超过2*BATCH个，线程退出时经thread_exit归还全局链表
+ * @note 全局状态都是POD，静态零初始化，不存在静态初始化顺序问题
+ * @tparam N 内存块大小，单位字节
+ */
+template <size_t N>
+class fixed_block_pool
+{
+    union block
+    {
+        block *m_pNext;
+        char m_data[N];
+        double m_align; // 保证按double对齐
+    };
+
+    struct free_list
+    {
+        block *m_pHead;
+        size_t m_nCount;
+        BOOL m_bHooked; // 是否已登记线程退出时归还
+    };
+
+    struct global_list
+    {
+        volatile LONG m_nLock;
+        block *m_pHead;
+        size_t m_nCount;
+    };
+
+    enum
+    {
+        BATCH = 32,      // 本线程与全局链表之间每次转移的内存块数
+        CHUNK_SIZE = 256 // 全局链表为空时每次向系统申请的内存块数
+    };
+
+public:
+    /**
+     * @brief 分配一个内存块
+     * @return void* 内存块，失败时抛出std::bad_alloc
+     */
+    static void *allocate()
+    {
+        free_list &local = local_list();
+        if (!local.m_pHead)
+        {
+            refill(local);
+        }
+        if (!local.m_bHooked)
+        {
+            hook(local);
+        }
+
+        block *pBlock = local.m_pHead;
+        local.m_pHead = pBlock->m_pNext;
+        --local.m_nCount;
+        return pBlock;
+    }
+
+    /**
+     * @brief 释放内存块，可以在与分配不同的线程中释放
+     * @param [in] v_p allocate()返回的内存块
+     */
+    static void deallocate(void *v_p)
+    {
+        if (!v_p)
+        {
+            return;
+        }
+
+        free_list &local = local_list();
+        block *pBlock = static_cast<block *>(v_p);
+        pBlock->m_pNext = local.m_pHead;
+        local.m_pHead = pBlock;
+        if (++local.m_nCount > 2 * BATCH)
+        {
+            flush(local);
+        }
+        if (!local.m_bHooked)
+        {
+            hook(local);
+        }
+    }
+
+private:
+    static free_list &local_list()
+    {
+        static THREAD_LOCAL free_list s_list = {NULL, 0, FALSE};
+        return s_list;
+    }
+
+    /**
+     * @brief 登记线程退出时把本线程缓存的内存块归还全局链表
+     */
+    static void hook(free_list &v_local)
+    {
+        thread_exit::at_exit(&fixed_block_pool::release_local); // 登记失败时不再重试，只是退出时不归还
+        v_local.m_bHooked = TRUE;
+    }
+
+    /**
+     * @brief 线程退出时调用，本线程缓存的内存块全部归还全局链表
+     */
+    static void release_local()
+    {
+        free_list &local = local_list();
+        local.m_bHooked = FALSE; // 之后的退出回调中再次释放时重新登记
+        if (!local.m_pHead)
+        {
+            return;
+        }
+
+        block *pLast = local.m_pHead;
+        while (pLast->m_pNext)
+        {
+            pLast = pLast->m_pNext;
+        }
+
+        lock();
+        pLast->m_pNext = s_global.m_pHead;
+        s_global.m_pHead = local.m_pHead;
+        s_global.m_nCount += local.m_nCount;
+        unlock();
+
+        local.m_pHead = NULL;
+        local.m_nCount = 0;
+    }
+
+    /**
+     * @brief 从全局链表取回BATCH个内存块，全局链表为空时向系统申请一块，多出的部分放入全局链表
+     */
+    static void refill(free_list &v_local)
+    {
+        lock();
+        for (size_t i = 0; i < BATCH && s_global.m_pHead; ++i)
+        {
+            block *pBlock = s_global.m_pHead;
+            s_global.m_pHead = pBlock->m_pNext;
+            --s_global.m_nCount;
+
+            pBlock->m_pNext = v_local.m_pHead;
+            v_local.m_pHead = pBlock;
+            ++v_local.m_nCount;
+        }
+        unlock();
+
+        if (!v_local.m_pHead)
+        {
+            block *pChunk = static_cast<block *>(::operator new(sizeof(block) * CHUNK_SIZE));
+            for (size_t i = 0; i < BATCH; ++i)
+            {
+                pChunk[i].m_pNext = v_local.m_pHead;
+                v_local.m_pHead = &pChunk[i];
+            }
+            v_local.m_nCount += BATCH;
+
+            for (size_t i = BATCH; i + 1 < CHUNK_SIZE; ++i)
+            {
+                pChunk[i].m_pNext = &pChunk[i + 1];
+            }
+            lock();
+            pChunk[CHUNK_SIZE - 1].m_pNext = s_global.m_pHead;
+            s_global.m_pHead = &pChunk[BATCH];
+            s_global.m_nCount += CHUNK_SIZE - BATCH;
+            unlock();
+        }
+    }
+
+    /**
+     * @brief 把本线程多余的内存块归还全局链表，本线程保留BATCH个
+     */
+    static void flush(free_list &v_local)
+    {
+        block *pFirst = v_local.m_pHead;
+        block *pLast = pFirst;
+        size_t nCount = v_local.m_nCount - BATCH;
+        for (size_t i = 1; i < nCount; ++i)
+        {
+            pLast = pLast->m_pNext;
+        }
+        v_local.m_pHead = pLast->m_pNext;
+        v_local.m_nCount = BATCH;
+
+        lock();
+        pLast->m_pNext = s_global.m_pHead;
+        s_global.m_pHead = pFirst;
+        s_global.m_nCount += nCount;
+        unlock();
+    }
+
+    static void lock()
+    {
+        while (InterlockedExchange(&s_global.m_nLock, 1) != 0)
+        {
+            while (s_global.m_nLock != 0)
+            {
+                cpu_relax();
+            }
+        }
+    }
+    static void unlock() { InterlockedExchange(&s_global.m_nLock, 0); }
+
+private:
+    static global_list s_global; // 全局空闲链表
+};
+
+template <size_t N>
+typename fixed_block_pool<N>::global_list fixed_block_pool<N>::s_global = {0, NULL, 0};
+
+/**
+ * @brief 对象池，按对象大小使用对应的定长内存块池
+ * @tparam T 对象类型
+ */
+template <typename T>
+class object_pool
+{
+public:
+    static T *create()
+    {
+        void *p = fixed_block_pool<sizeof(T)>::allocate();
+        try
+        {
+            return new (p) T();
+        }
+        catch (...)
+        {
+            fixed_block_pool<sizeof(T)>::deallocate(p);
+            throw;
+        }
+    }
+
+    template <typename A>
+    static T *create(const A &v_arg)
+    {
+        void *p = fixed_block_pool<sizeof(T)>::allocate();
+        try
+        {
+            return new (p) T(v_arg);
+        }
+        catch (...)
+        {
+            fixed_block_pool<sizeof(T)>::deallocate(p);
+            throw;
+        }
+    }
+
+    template <typename A1, typename A2>
+    static T *create(const A1 &v_arg1, const A2 &v_arg2)
+    {
+        void *p = fixed_block_pool<sizeof(T)>::allocate();
+        try
+        {
+            return new (p) T(v_arg1, v_arg2);
+        }
+        catch (...)
+        {
+            fixed_block_pool<sizeof(T)>::deallocate(p);
+            throw;
+        }
+    }
+
+    static void destroy(T *v_p)
+    {
+        if (v_p)
+        {
+            v_p->~T();
+            fixed_block_pool<sizeof(T)>::deallocate(v_p);
+        }
+    }
+};
+
+#endif // OBJECT_POOL_HPP
\ No newline at end of file
@@ -0,0 +1,561 @@
+﻿/**
+ * @file parallel_algorithm.hpp
+ * @brief 基于线程池的数据并行算法：parallel_for、parallel_reduce、parallel_transform、parallel_scan、parallel_sort
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef PARALLEL_ALGORITHM_HPP
+#define PARALLEL_ALGORITHM_HPP
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+#include "spinlock.hpp"
+#include "thread_pool.hpp"
+
+namespace parallel_detail
+{
+enum
+{
+    CHUNKS_PER_THREAD = 8, // 自动粒度时每个线程（含调用线程）平均分到的块数，块数多于线程数以平衡负载
+    MIN_SORT_GRAIN = 4096  // 排序的最小块大小，块太小时合并轮数多
+};
+
+/**
+ * @brief 自动粒度，v_nGrain为0时按线程数把v_nCount个元素分为若干块
+ */
+inline size_t grain_size(thread_pool &v_pool, size_t v_nCount, size_t v_nGrain)
+{
+    if (v_nGrain > 0)
+    {
+        return v_nGrain;
+    }
+    size_t nChunks = CHUNKS_PER_THREAD * (v_pool.thread_count() + 1);
+    return v_nCount > nChunks ? (v_nCount + nChunks - 1) / nChunks : 1;
+}
+
+/**
+ * @brief 按块划分的并行任务
+ * @details 块区间[0, 块数)递归二分：右半部分放入待执行区间队列，并向线程池提交一个协助任务，自己继续处理左半部分，
+ *          只剩一个块时执行。调用线程执行根区间，做完后继续从待执行区间队列取区间，直到所有块都被取走，
+ *          之后才等待其他线程执行中的块；线程池繁忙或在工作线程中嵌套调用时，调用线程可能独自做完全部工作，不会死锁
+ * @note 对象在堆上分配并引用计数，协助任务可能在所有块执行完之后才被线程池执行，此时只访问对象本身，不执行块
+ */
+class chunk_job
+{
+public:
+    chunk_job(thread_pool &v_pool, size_t v_nChunks) : m_pool(v_pool), m_nChunks(v_nChunks), m_nRefs(1) {}
+
+    /**
+     * @brief 在调用线程中执行，返回时所有块都已执行完
+     */
+    void run()
+    {
+        if (m_nChunks == 0)
+        {
+            return;
+        }
+
+        m_wgRanges.add();
+        process(0, m_nChunks);
+        drain();
+        m_wgRanges.wait();
+    }
+
+    /**
+     * @brief 释放引用，最后一个引用释放时删除对象
+     */
+    void release()
+    {
+        if (--m_nRefs == 0)
+        {
+            delete this;
+        }
+    }
+
+protected:
+    virtual ~chunk_job() {}
+
+    /**
+     * @brief 执行一个块
+     */
+    virtual void execute(size_t v_nChunk) = 0;
+
+private:
+    struct range
+    {
+        size_t m_nFirst;
+        size_t m_nLast;
+    };
+
+    static void help(void *v_pParam)
+    {
+        chunk_job *pJob = static_cast<chunk_job *>(v_pParam);
+        pJob->drain();
+        pJob->release();
+    }
+
+    void process(size_t v_nFirst, size_t v_nLast)
+    {
+        while (v_nLast - v_nFirst > 1)
+        {
+            size_t nMid = v_nFirst + (v_nLast - v_nFirst) / 2;
+            push(nMid, v_nLast);
+            v_nLast = nMid;
+        }
+        execute(v_nFirst);
+        m_wgRanges.done();
+    }
+
+    void drain()
+    {
+        range r;
+        while (pop(r))
+        {
+            process(r.m_nFirst, r.m_nLast);
+        }
+    }
+
+    void push(size_t v_nFirst, size_t v_nLast)
+    {
+        range r = {v_nFirst, v_nLast};
+        m_wgRanges.add();
+        {
+            unique_lock<spinlock> lock(m_lock);
+            m_deqRanges.push_back(r);
+        }
+        ++m_nRefs;
+        m_pool.submit(task_func(help, this));
+    }
+
+    /**
+     * @brief 取最早放入的区间，也是最大的区间
+     */
+    BOOL pop(range &v_range)
+    {
+        unique_lock<spinlock> lock(m_lock);
+        if (m_deqRanges.empty())
+        {
+            return FALSE;
+        }
+        v_range = m_deqRanges.front();
+        m_deqRanges.pop_front();
+        return TRUE;
+    }
+
+private:
+    chunk_job(const chunk_job &);
+    chunk_job &operator=(const chunk_job &);
+
+private:
+    thread_pool &m_pool;           // 执行协助任务的线程池
+    size_t m_nChunks;              // 块数
+    atomic<LONG> m_nRefs;          // 引用计数，调用线程和每个未执行的协助任务各一个
+    wait_group m_wgRanges;         // 尚未执行完的区间
+    spinlock m_lock;               // 保护待执行区间队列
+    std::deque<range> m_deqRanges; // 待执行区间
+};
+
+/**
+ * @brief 执行chunk_job，结束后释放调用线程的引用
+ */
+inline void run_job(chunk_job *v_pJob)
+{
+    v_pJob->run();
+    v_pJob->release();
+}
+
+/**
+ * @brief 对每个块调用v_body(块首, 块尾)
+ */
+template <typename It, typename Body>
+class for_job : public chunk_job
+{
+public:
+    for_job(thread_pool &v_pool, It v_first, size_t v_nCount, size_t v_nGrain, Body &v_body)
+        : chunk_job(v_pool, (v_nCount + v_nGrain - 1) / v_nGrain), m_first(v_first), m_nCount(v_nCount),
+          m_nGrain(v_nGrain), m_body(v_body)
+    {
+    }
+
+protected:
+    void execute(size_t v_nChunk)
+    {
+        size_t nBegin = v_nChunk * m_nGrain;
+        size_t nEnd = std::min(nBegin + m_nGrain, m_nCount);
+        m_body(m_first + nBegin, m_first + nEnd);
+    }
+
+private:
+    It m_first;
+    size_t m_nCount;
+    size_t m_nGrain;
+    Body &m_body;
+};
+
+/**
+ * @brief 按块归约，每块的结果写入v_vecPartials
+ */
+template <typename It, typename T, typename Op>
+class reduce_job : public chunk_job
+{
+public:
+    reduce_job(thread_pool &v_pool, It v_first, size_t v_nCount, size_t v_nGrain, Op &v_op,
+               std::vector<T> &v_vecPartials)
+        : chunk_job(v_pool, v_vecPartials.size()), m_first(v_first), m_nCount(v_nCount), m_nGrain(v_nGrain),
+          m_op(v_op), m_vecPartials(v_vecPartials)
+    {
+    }
+
+protected:
+    void execute(size_t v_nChunk)
+    {
+        It it = m_first + v_nChunk * m_nGrain;
+        It itEnd = m_first + std::min((v_nChunk + 1) * m_nGrain, m_nCount);
+        T acc = *it;
+        for (++it; it != itEnd; ++it)
+        {
+            acc = m_op(acc, *it);
+        }
+        m_vecPartials[v_nChunk] = acc;
+    }
+
+private:
+    It m_first;
+    size_t m_nCount;
+    size_t m_nGrain;
+    Op &m_op;
+    std::vector<T> &m_vecPartials;
+};
+
+/**
+ * @brief 前缀和的第二遍，每块以前面所有块的归约结果为初值做前缀和
+ */
+template <typename InputIt, typename OutputIt, typename T, typename Op>
+class scan_job : public chunk_job
+{
+public:
+    scan_job(thread_pool &v_pool, InputIt v_first, OutputIt v_out, size_t v_nCount, size_t v_nGrain, Op &v_op,
+             const std::vector<T> &v_vecOffsets)
+        : chunk_job(v_pool, v_vecOffsets.size()), m_first(v_first), m_out(v_out), m_nCount(v_nCount),
+          m_nGrain(v_nGrain), m_op(v_op), m_vecOffsets(v_vecOffsets)
+    {
+    }
+
+protected:
+    void execute(size_t v_nChunk)
+    {
+        size_t nBegin = v_nChunk * m_nGrain;
+        size_t nEnd = std::min(nBegin + m_nGrain, m_nCount);
+        InputIt it = m_first + nBegin;
+        OutputIt out = m_out + nBegin;
+        T acc = v_nChunk == 0 ? *it : m_op(m_vecOffsets[v_nChunk], *it);
+        *out = acc;
+        for (size_t i = nBegin + 1; i < nEnd; ++i)
+        {
+            acc = m_op(acc, *++it);
+            *++out = acc;
+        }
+    }
+
+private:
+    InputIt m_first;
+    OutputIt m_out;
+    size_t m_nCount;
+    size_t m_nGrain;
+    Op &m_op;
+    const std::vector<T> &m_vecOffsets;
+};
+
+/**
+ * @brief 在稳定合并A、B的结果中，前v_nDiagonal个元素包含A的元素个数（合并路径的二分查找）
+ */
+template <typename It, typename Compare>
+size_t merge_split(It v_a, size_t v_nA, It v_b, size_t v_nB, size_t v_nDiagonal, Compare &v_comp)
+{
+    size_t nLow = v_nDiagonal > v_nB ? v_nDiagonal - v_nB : 0;
+    size_t nHigh = std::min(v_nDiagonal, v_nA);
+    while (nLow < nHigh)
+    {
+        size_t i = nLow + (nHigh - nLow) / 2;
+        if (v_comp(*(v_b + (v_nDiagonal - i - 1)), *(v_a + i)))
+        {
+            nHigh = i;
+        }
+        else
+        {
+            nLow = i + 1;
+        }
+    }
+    return nLow;
+}
+
+/**
+ * @brief 归并排序的一轮：相邻两个长度为v_nWidth的有序段合并为一段，每对的输出再按粒度切分为多块并行合并
+ */
+template <typename Src, typename Dst, typename Compare>
+class merge_job : public chunk_job
+{
+public:
+    merge_job(thread_pool &v_pool, Src v_src, Dst v_dst, size_t v_nCount, size_t v_nWidth, size_t v_nPieces,
+              Compare &v_comp)
+        : chunk_job(v_pool, (v_nCount + 2 * v_nWidth - 1) / (2 * v_nWidth) * v_nPieces), m_src(v_src), m_dst(v_dst),
+          m_nCount(v_nCount), m_nWidth(v_nWidth), m_nPieces(v_nPieces), m_comp(v_comp)
+    {
+    }
+
+protected:
+    void execute(size_t v_nChunk)
+    {
+        size_t nStart = v_nChunk / m_nPieces * 2 * m_nWidth;
+        size_t nMid = std::min(nStart + m_nWidth, m_nCount);
+        size_t nEnd = std::min(nStart + 2 * m_nWidth, m_nCount);
+        size_t nPiece = v_nChunk % m_nPieces;
+
+        size_t nLength = nEnd - nStart;
+        size_t nFirst = piece_start(nLength, nPiece);
+        size_t nLast = piece_start(nLength, nPiece + 1);
+        if (nFirst == nLast)
+        {
+            return;
+        }
+
+        Src a = m_src + nStart;
+        Src b = m_src + nMid;
+        size_t nA = nMid - nStart;
+        size_t nB = nEnd - nMid;
+        size_t iFirst = merge_split(a, nA, b, nB, nFirst, m_comp);
+        size_t iLast = merge_split(a, nA, b, nB, nLast, m_comp);
+        std::merge(a + iFirst, a + iLast, b + (nFirst - iFirst), b + (nLast - iLast), m_dst + (nStart + nFirst),
+                   m_comp);
+    }
+
+private:
+    size_t piece_start(size_t v_nLength, size_t v_nPiece) const
+    {
+        return v_nPiece * (v_nLength / m_nPieces) + std::min(v_nPiece, v_nLength % m_nPieces);
+    }
+
+private:
+    Src m_src;
+    Dst m_dst;
+    size_t m_nCount;
+    size_t m_nWidth;
+    size_t m_nPieces;
+    Compare &m_comp;
+};
+
+template <typename Compare>
+struct sort_body
+{
+    sort_body(Compare &v_comp) : m_comp(v_comp) {}
+    template <typename It>
+    void operator()(It v_first, It v_last)
+    {
+        std::sort(v_first, v_last, m_comp);
+    }
+    Compare &m_comp;
+};
+
+template <typename It, typename OutputIt, typename Op>
+struct transform_body
+{
+    transform_body(It v_first, OutputIt v_out, Op &v_op) : m_first(v_first), m_out(v_out), m_op(v_op) {}
+    void operator()(It v_begin, It v_end) { std::transform(v_begin, v_end, m_out + (v_begin - m_first), m_op); }
+
+    It m_first;
+    OutputIt m_out;
+    Op &m_op;
+};
+
+template <typename It, typename OutputIt>
+struct copy_body
+{
+    copy_body(It v_first, OutputIt v_out) : m_first(v_first), m_out(v_out) {}
+    void operator()(It v_begin, It v_end) { std::copy(v_begin, v_end, m_out + (v_begin - m_first)); }
+
+    It m_first;
+    OutputIt m_out;
+};
+
+template <typename Src, typename Dst, typename Compare>
+void merge_round(thread_pool &v_pool, Src v_src, Dst v_dst, size_t v_nCount, size_t v_nWidth, size_t v_nGrain,
+                 Compare &v_comp)
+{
+    size_t nPieces = (2 * v_nWidth + v_nGrain - 1) / v_nGrain;
+    run_job(new merge_job<Src, Dst, Compare>(v_pool, v_src, v_dst, v_nCount, v_nWidth, nPieces, v_comp));
+}
+} // namespace parallel_detail
+
+/**
+ * @brief 并行执行v_body(块首, 块尾)，块之间互不重叠，覆盖[v_first, v_last)
+ * @details 区间按粒度分块后递归二分，分出的一半交给线程池，调用线程也参与执行，所有块执行完才返回；
+ *          可以在线程池的工作线程中嵌套调用
+ * @param [in] v_pool 线程池
+ * @param [in] v_first 区间开始，随机访问迭代器或整数
+ * @param [in] v_last 区间结束
+ * @param [in] v_nGrain 每块的元素数，0表示按线程数自动选择
+ * @param [in] v_body 函数对象，可能被多个线程同时调用
+ */
+template <typename It, typename Body>
+void parallel_for(thread_pool &v_pool, It v_first, It v_last, size_t v_nGrain, Body v_body)
+{
+    if (!(v_first < v_last))
+    {
+        return;
+    }
+    size_t nCount = static_cast<size_t>(v_last - v_first);
+    size_t nGrain = parallel_detail::grain_size(v_pool, nCount, v_nGrain);
+    parallel_detail::run_job(new parallel_detail::for_job<It, Body>(v_pool, v_first, nCount, nGrain, v_body));
+}
+
+template <typename It, typename Body>
+void parallel_for(thread_pool &v_pool, It v_first, It v_last, Body v_body)
+{
+    parallel_for(v_pool, v_first, v_last, 0, v_body);
+}
+
+/**
+ * @brief 并行归约，v_op需满足结合律，各块的结果按块的顺序合并，不要求交换律
+ * @return T v_init与所有元素依次归约的结果
+ */
+template <typename It, typename T, typename Op>
+T parallel_reduce(thread_pool &v_pool, It v_first, It v_last, T v_init, Op v_op, size_t v_nGrain = 0)
+{
+    if (!(v_first < v_last))
+    {
+        return v_init;
+    }
+
+    size_t nCount = static_cast<size_t>(v_last - v_first);
+    size_t nGrain = parallel_detail::grain_size(v_pool, nCount, v_nGrain);
+    std::vector<T> vecPartials((nCount + nGrain - 1) / nGrain, v_init);
+    parallel_detail::run_job(
+        new parallel_detail::reduce_job<It, T, Op>(v_pool, v_first, nCount, nGrain, v_op, vecPartials));
+
+    T result = v_init;
+    for (size_t i = 0; i < vecPartials.size(); ++i)
+    {
+        result = v_op(result, vecPartials[i]);
+    }
+    return result;
+}
+
+template <typename It, typename T>
+T parallel_reduce(thread_pool &v_pool, It v_first, It v_last, T v_init)
+{
+    return parallel_reduce(v_pool, v_first, v_last, v_init, std::plus<T>());
+}
+
+/**
+ * @brief 并行变换，*(v_out + i) = v_op(*(v_first + i))，输出可以与输入是同一区间
+ * @return OutputIt 输出区间的结尾
+ */
+template <typename It, typename OutputIt, typename Op>
+OutputIt parallel_transform(thread_pool &v_pool, It v_first, It v_last, OutputIt v_out, Op v_op, size_t v_nGrain = 0)
+{
+    parallel_for(v_pool, v_first, v_last, v_nGrain,
+                 parallel_detail::transform_body<It, OutputIt, Op>(v_first, v_out, v_op));
+    return v_out + (v_last - v_first);
+}
+
+/**
+ * @brief 并行前缀归约（包含当前元素），v_op需满足结合律，输出可以与输入是同一区间
+ * @details 两遍：第一遍并行求各块的归约结果，串行求各块的初值，第二遍各块并行做前缀归约
+ * @return OutputIt 输出区间的结尾
+ */
+template <typename It, typename OutputIt, typename Op>
+OutputIt parallel_scan(thread_pool &v_pool, It v_first, It v_last, OutputIt v_out, Op v_op, size_t v_nGrain = 0)
+{
+    typedef typename std::iterator_traits<It>::value_type value_type;
+    if (!(v_first < v_last))
+    {
+        return v_out;
+    }
+
+    size_t nCount = static_cast<size_t>(v_last - v_first);
+    size_t nGrain = parallel_detail::grain_size(v_pool, nCount, v_nGrain);
+    std::vector<value_type> vecPartials((nCount + nGrain - 1) / nGrain, *v_first);
+    parallel_detail::run_job(
+        new parallel_detail::reduce_job<It, value_type, Op>(v_pool, v_first, nCount, nGrain, v_op, vecPartials));
+
+    // 各块的初值原地覆盖各块的归约结果，第0块不使用初值
+    value_type offset = vecPartials[0];
+    for (size_t i = 1; i < vecPartials.size(); ++i)
+    {
+        value_type partial = vecPartials[i];
+        vecPartials[i] = offset;
+        offset = v_op(offset, partial);
+    }
+    parallel_detail::run_job(new parallel_detail::scan_job<It, OutputIt, value_type, Op>(
+        v_pool, v_first, v_out, nCount, nGrain, v_op, vecPartials));
+    return v_out + (v_last - v_first);
+}
+
+template <typename It, typename OutputIt>
+OutputIt parallel_scan(thread_pool &v_pool, It v_first, It v_last, OutputIt v_out)
+{
+    return parallel_scan(v_pool, v_first, v_last, v_out, std::plus<typename std::iterator_traits<It>::value_type>());
+}
+
+/**
+ * @brief 并行归并排序，不稳定
+ * @details 先把区间分块并行std::sort，再逐轮两两合并；每轮按合并路径把每对有序段的输出切分为多块，
+ *          用二分查找确定每块对应的输入位置后并行合并，最后一轮也能用上所有线程
+ * @note 需要与区间等长的临时缓冲区
+ * @param [in] v_nGrain 每块的元素数，0表示按线程数自动选择，不小于MIN_SORT_GRAIN
+ */
+template <typename It, typename Compare>
+void parallel_sort(thread_pool &v_pool, It v_first, It v_last, Compare v_comp, size_t v_nGrain = 0)
+{
+    typedef typename std::iterator_traits<It>::value_type value_type;
+    if (!(v_first < v_last))
+    {
+        return;
+    }
+
+    size_t nCount = static_cast<size_t>(v_last - v_first);
+    size_t nGrain = std::max(parallel_detail::grain_size(v_pool, nCount, v_nGrain),
+                             static_cast<size_t>(parallel_detail::MIN_SORT_GRAIN));
+    if (nCount <= nGrain)
+    {
+        std::sort(v_first, v_last, v_comp);
+        return;
+    }
+
+    parallel_for(v_pool, v_first, v_last, nGrain, parallel_detail::sort_body<Compare>(v_comp));
+
+    std::vector<value_type> vecBuffer(nCount);
+    BOOL bInBuffer = FALSE;
+    for (size_t nWidth = nGrain; nWidth < nCount; nWidth *= 2)
+    {
+        if (bInBuffer)
+        {
+            parallel_detail::merge_round(v_pool, vecBuffer.begin(), v_first, nCount, nWidth, nGrain, v_comp);
+        }
+        else
+        {
+            parallel_detail::merge_round(v_pool, v_first, vecBuffer.begin(), nCount, nWidth, nGrain, v_comp);
+        }
+        bInBuffer = !bInBuffer;
+    }
+
+    if (bInBuffer)
+    {
+        typedef typename std::vector<value_type>::iterator buffer_iterator;
+        parallel_for(v_pool, vecBuffer.begin(), vecBuffer.end(), nGrain,
+                     parallel_detail::copy_body<buffer_iterator, It>(vecBuffer.begin(), v_first));
+    }
+}
+
+template <typename It>
+void parallel_sort(thread_pool &v_pool, It v_first, It v_last)
+{
+    parallel_sort(v_pool, v_first, v_last, std::less<typename std::iterator_traits<It>::value_type>());
+}
+
+#endif // PARALLEL_ALGORITHM_HPP
\ No newline at end of file
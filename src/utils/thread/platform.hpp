@@ -0,0 +1,165 @@
+﻿/**
+ * @file platform.hpp
+ * @brief 线程模块的平台适配层
+ * @details windows下直接包含<windows.h>；linux下提供线程模块用到的windows类型、常量及Interlocked系列函数，
+ *          使上层代码（message_queue、thread_pool等）无需修改即可在两个平台编译
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef PLATFORM_HPP
+#define PLATFORM_HPP
+
+#if defined(_WIN32)
+
+#include <windows.h>
+
+#else
+
+#include <stdint.h>
+#include <stddef.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef int BOOL;
+typedef int32_t LONG;
+typedef uint32_t DWORD;
+typedef unsigned int UINT;
+typedef uint32_t UINT32;
+typedef int64_t LONGLONG;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+#ifndef FALSE
+#define FALSE 0
+#endif
+#ifndef INFINITE
+#define INFINITE 0xFFFFFFFF
+#endif
+
+inline LONG InterlockedIncrement(volatile LONG *v_pAddend) { return __sync_add_and_fetch(v_pAddend, 1); }
+inline LONG InterlockedDecrement(volatile LONG *v_pAddend) { return __sync_sub_and_fetch(v_pAddend, 1); }
+inline LONG InterlockedExchangeAdd(volatile LONG *v_pAddend, LONG v_value)
+{
+    return __sync_fetch_and_add(v_pAddend, v_value);
+}
+inline LONG InterlockedExchange(volatile LONG *v_pTarget, LONG v_value)
+{
+    __sync_synchronize(); // __sync_lock_test_and_set只是acquire屏障，补齐为全屏障，与windows语义一致
+    return __sync_lock_test_and_set(v_pTarget, v_value);
+}
+inline LONG InterlockedCompareExchange(volatile LONG *v_pDest, LONG v_exchange, LONG v_comparand)
+{
+    return __sync_val_compare_and_swap(v_pDest, v_comparand, v_exchange);
+}
+inline void *InterlockedExchangePointer(void *volatile *v_ppTarget, void *v_pValue)
+{
+    __sync_synchronize();
+    return __sync_lock_test_and_set(v_ppTarget, v_pValue);
+}
+inline void *InterlockedCompareExchangePointer(void *volatile *v_ppDest, void *v_pExchange, void *v_pComparand)
+{
+    return __sync_val_compare_and_swap(v_ppDest, v_pComparand, v_pExchange);
+}
+
+#endif // _WIN32
+
+/**
+ * @brief 缓存行大小，用于隔离被不同线程频繁修改的数据，避免伪共享
+ */
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief 线程局部存储修饰符，C++98没有thread_local关键字
+ * @note 只能修饰POD类型的静态或全局变量
+ */
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+/**
+ * @brief 完整内存屏障，屏障前后的读写不会被CPU或编译器重排
+ */
+inline void memory_barrier()
+{
+#if defined(_WIN32)
+    MemoryBarrier();
+#else
+    __sync_synchronize();
+#endif
+}
+
+/**
+ * @brief 自旋等待时的CPU提示指令，降低自旋对超线程兄弟核及总线的影响
+ */
+inline void cpu_relax()
+{
+#if defined(_MSC_VER)
+    YieldProcessor();
+#elif defined(__i386__) || defined(__x86_64__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield" ::: "memory");
+#else
+    __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
+/**
+ * @brief 逻辑处理器个数
+ */
+inline DWORD processor_count()
+{
+#if defined(_WIN32)
+    SYSTEM_INFO sys_info;
+    ::GetSystemInfo(&sys_info);
+    return sys_info.dwNumberOfProcessors;
+#else
+    long lNum = ::sysconf(_SC_NPROCESSORS_ONLN);
+    return lNum > 0 ? static_cast<DWORD>(lNum) : 1;
+#endif
+}
+
+/**
+ * @brief 自旋等待的默认次数，单核机器上持有者无法在自旋期间运行，不自旋
+ */
+inline int default_spin_count()
+{
+    static const int s_nSpin = processor_count() > 1 ? 100 : 0;
+    return s_nSpin;
+}
+
+/**
+ * @brief 当前线程的序号，首次调用时分配，从1开始依次递增，用于把线程分散到不同的分片
+ */
+inline size_t current_thread_index()
+{
+    static volatile LONG s_nNext = 0;
+    static THREAD_LOCAL size_t s_nIndex = 0; // 0表示未分配
+    if (s_nIndex == 0)
+    {
+        s_nIndex = static_cast<size_t>(InterlockedIncrement(&s_nNext));
+    }
+    return s_nIndex;
+}
+
+/**
+ * @brief 单调递增的毫秒计数，约49.7天回绕一次，只用于计算时间差
+ */
+inline DWORD tick_count()
+{
+#if defined(_WIN32)
+    return ::GetTickCount();
+#else
+    timespec ts;
+    ::clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<DWORD>(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+#endif
+}
+
+#endif // PLATFORM_HPP
\ No newline at end of file
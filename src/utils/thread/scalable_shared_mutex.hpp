@@ -0,0 +1,220 @@
+﻿/**
+ * @file scalable_shared_mutex.hpp
+ * @brief 读者可扩展的共享互斥量（big reader lock），读多写少的场景
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef SCALABLE_SHARED_MUTEX_HPP
+#define SCALABLE_SHARED_MUTEX_HPP
+
+#include <limits.h>
+
+#include "atomic.hpp"
+#include "futex.hpp"
+#include "mutex.hpp"
+
+/**
+ * @brief 读者可扩展的共享互斥量，接口与shared_mutex一致，可与shared_lock<T>、unique_lock<T>配合使用
+ * @details 读者计数分散在多个独占缓存行的分片上，每个线程固定使用一个分片，读者加锁、解锁只修改本线程的分片，
+ *          只读取写者标志，不同读者之间没有缓存行争用；写者之间用互斥量排队，获得后置写者标志，
+ *          再等待所有分片的读者计数归零。读者看到写者标志后退出并等待写者解锁，写者不会被持续到来的读者饿死
+ * @note 写者需要遍历所有分片，加锁代价随分片数增长，只适合写很少的场景
+ */
+class scalable_shared_mutex
+{
+    typedef atomic_detail::ops<LONG> ops;
+
+    struct slot
+    {
+        volatile LONG m_nReaders; // 使用该分片的线程中持有共享锁的个数
+        char m_pad[CACHE_LINE_SIZE - sizeof(LONG)];
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nSlots 读者分片数，会向上取整为2的幂，0表示逻辑处理器个数的2倍
+     */
+    scalable_shared_mutex(size_t v_nSlots = 0) : m_nWriter(0), m_nDrainWaiting(0), m_nDrainSeq(0)
+    {
+        if (v_nSlots == 0)
+        {
+            v_nSlots = processor_count() * 2;
+        }
+        size_t nSlots = 1;
+        while (nSlots < v_nSlots)
+        {
+            nSlots <<= 1;
+        }
+        m_nMask = nSlots - 1;
+
+        // 按缓存行对齐分配分片，每个分片恰好占一个缓存行
+        m_pBuffer = new char[sizeof(slot) * nSlots + CACHE_LINE_SIZE];
+        size_t nOffset = reinterpret_cast<size_t>(m_pBuffer) % CACHE_LINE_SIZE;
+        m_pSlots = reinterpret_cast<slot *>(m_pBuffer + (nOffset ? CACHE_LINE_SIZE - nOffset : 0));
+        for (size_t i = 0; i < nSlots; ++i)
+        {
+            m_pSlots[i].m_nReaders = 0;
+        }
+    }
+    ~scalable_shared_mutex() { delete[] m_pBuffer; }
+
+public:
+    void lock()
+    {
+        m_mutexWriter.lock();
+        ops::store(&m_nWriter, 1, memory_order_seq_cst);
+        for (size_t i = 0; i <= m_nMask; ++i)
+        {
+            wait_drained(m_pSlots[i].m_nReaders);
+        }
+    }
+
+    void unlock()
+    {
+        if (ops::exchange(&m_nWriter, 0, memory_order_release) == 2)
+        {
+            futex::wake(&m_nWriter, INT_MAX);
+        }
+        m_mutexWriter.unlock();
+    }
+
+    BOOL try_lock()
+    {
+        if (!m_mutexWriter.try_lock())
+        {
+            return FALSE;
+        }
+
+        ops::store(&m_nWriter, 1, memory_order_seq_cst);
+        for (size_t i = 0; i <= m_nMask; ++i)
+        {
+            if (ops::load(&m_pSlots[i].m_nReaders, memory_order_seq_cst) != 0)
+            {
+                unlock();
+                return FALSE;
+            }
+        }
+        return TRUE;
+    }
+
+    void lock_shared()
+    {
+        volatile LONG &nReaders = local_readers();
+        while (!try_enter(nReaders))
+        {
+            wait_writer();
+        }
+    }
+
+    void unlock_shared() { leave(local_readers()); }
+
+    BOOL try_lock_shared() { return try_enter(local_readers()); }
+
+    size_t slots() const { return m_nMask + 1; }
+
+private:
+    volatile LONG &local_readers() { return m_pSlots[current_thread_index() & m_nMask].m_nReaders; }
+
+    /**
+     * @brief 读者登记，登记后发现有写者则撤销登记
+     * @note 登记和检查写者标志都是顺序一致的，与写者的置标志、检查读者计数构成Dekker式互斥：
+     *       要么读者看到写者标志，要么写者看到读者计数
+     */
+    BOOL try_enter(volatile LONG &v_nReaders)
+    {
+        ops::fetch_add(&v_nReaders, 1, memory_order_seq_cst);
+        if (ops::load(&m_nWriter, memory_order_seq_cst) == 0)
+        {
+            return TRUE;
+        }
+        leave(v_nReaders);
+        return FALSE;
+    }
+
+    /**
+     * @brief 读者退出，写者正在挂起等待读者退出时唤醒写者
+     */
+    void leave(volatile LONG &v_nReaders)
+    {
+        ops::fetch_sub(&v_nReaders, 1, memory_order_seq_cst);
+        if (ops::load(&m_nDrainWaiting, memory_order_seq_cst) != 0)
+        {
+            ops::fetch_add(&m_nDrainSeq, 1, memory_order_seq_cst);
+            futex::wake(&m_nDrainSeq, 1);
+        }
+    }
+
+    /**
+     * @brief 读者等待写者解锁，先短暂自旋，再把写者标志改为2后挂起，由写者解锁时唤醒
+     */
+    void wait_writer()
+    {
+        for (int i = default_spin_count(); i > 0; --i)
+        {
+            if (ops::load(&m_nWriter, memory_order_relaxed) == 0)
+            {
+                return;
+            }
+            cpu_relax();
+        }
+
+        LONG nState = ops::load(&m_nWriter, memory_order_relaxed);
+        while (nState != 0)
+        {
+            if (nState == 2 || ops::compare_exchange(&m_nWriter, nState, 2, false, memory_order_relaxed))
+            {
+                futex::wait(&m_nWriter, 2);
+            }
+            nState = ops::load(&m_nWriter, memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief 写者等待一个分片的读者全部退出
+     * @note 只有持有写者互斥量的线程调用，同一时刻最多一个线程挂起在m_nDrainSeq上
+     */
+    void wait_drained(volatile LONG &v_nReaders)
+    {
+        for (int i = default_spin_count(); i > 0; --i)
+        {
+            if (ops::load(&v_nReaders, memory_order_seq_cst) == 0)
+            {
+                return;
+            }
+            cpu_relax();
+        }
+
+        while (ops::load(&v_nReaders, memory_order_seq_cst) != 0)
+        {
+            // 先取序号再置等待标志并复查，读者在复查之后退出时必然看到等待标志并改变序号，不会漏掉唤醒
+            LONG nSeq = ops::load(&m_nDrainSeq, memory_order_seq_cst);
+            ops::store(&m_nDrainWaiting, 1, memory_order_seq_cst);
+            if (ops::load(&v_nReaders, memory_order_seq_cst) != 0)
+            {
+                futex::wait(&m_nDrainSeq, nSeq);
+            }
+        }
+        ops::store(&m_nDrainWaiting, 0, memory_order_relaxed);
+    }
+
+private:
+    scalable_shared_mutex(const scalable_shared_mutex &);
+    scalable_shared_mutex &operator=(const scalable_shared_mutex &);
+
+private:
+    // 读者每次加锁、解锁都要读取，写很少时保持在各读者的缓存中
+    slot *m_pSlots;                // 读者分片数组，按缓存行对齐
+    char *m_pBuffer;               // 读者分片数组的原始内存
+    size_t m_nMask;                // 分片下标掩码，分片数-1
+    volatile LONG m_nWriter;       // 写者标志：0 无写者，1 有写者，2 有写者且有读者挂起等待
+    volatile LONG m_nDrainWaiting; // 写者是否挂起等待读者退出
+
+    char m_pad[CACHE_LINE_SIZE]; // 隔开读者只读的部分和写者修改的部分
+
+    volatile LONG m_nDrainSeq; // 读者退出的序号，写者挂起等待的地址
+    mutex m_mutexWriter;       // 写者之间排队
+};
+
+#endif // SCALABLE_SHARED_MUTEX_HPP
\ No newline at end of file
@@ -0,0 +1,119 @@
+﻿/**
+ * @file semaphore.hpp
+ * @brief 计数信号量，无竞争时只有一次原子操作，需要阻塞时才按地址挂起
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef SEMAPHORE_HPP
+#define SEMAPHORE_HPP
+
+#include "atomic.hpp"
+#include "futex.hpp"
+
+/**
+ * @brief 计数信号量，接口与C++20的std::counting_semaphore一致
+ * @details 计数本身作为futex等待地址：获取时计数大于0则CAS减1，等于0时登记等待者后在计数上挂起；
+ *          释放时原子加上释放的数量，只有存在等待者时才进入内核唤醒
+ */
+class counting_semaphore
+{
+    typedef atomic_detail::ops<LONG> ops;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nDesired 初始计数
+     */
+    explicit counting_semaphore(LONG v_nDesired = 0) : m_nCount(v_nDesired), m_nWaiters(0) {}
+    ~counting_semaphore() {}
+
+public:
+    /**
+     * @brief 计数加v_nUpdate，唤醒至多v_nUpdate个等待线程
+     */
+    void release(LONG v_nUpdate = 1)
+    {
+        ops::fetch_add(&m_nCount, v_nUpdate, memory_order_seq_cst); // 与等待方登记后的检查配对，不会丢失唤醒
+        if (m_nWaiters.load() > 0)
+        {
+            futex::wake(&m_nCount, static_cast<int>(v_nUpdate));
+        }
+    }
+
+    /**
+     * @brief 计数减1，计数为0时等待
+     */
+    void acquire()
+    {
+        if (!try_acquire())
+        {
+            acquire_slow(INFINITE);
+        }
+    }
+
+    /**
+     * @brief 计数大于0时减1，不等待
+     * @return BOOL 是否成功
+     */
+    BOOL try_acquire()
+    {
+        LONG nCount = ops::load(&m_nCount, memory_order_relaxed);
+        while (nCount > 0)
+        {
+            if (ops::compare_exchange(&m_nCount, nCount, nCount - 1, true, memory_order_acquire))
+            {
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+
+    /**
+     * @brief 计数减1，计数为0时等待，直到成功或超时
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 成功，FALSE 超时
+     */
+    BOOL try_acquire_for(DWORD v_dwMilliseconds) { return try_acquire() || acquire_slow(v_dwMilliseconds); }
+
+    /**
+     * @brief 当前计数，只作为参考
+     */
+    LONG count() const { return ops::load(&m_nCount, memory_order_relaxed); }
+
+private:
+    BOOL acquire_slow(DWORD v_dwMilliseconds)
+    {
+        DWORD dwStart = tick_count();
+        BOOL bRet = FALSE;
+
+        ++m_nWaiters; // 原子操作带完整屏障，之后读到的计数不会早于登记
+        while (!(bRet = try_acquire()))
+        {
+            DWORD dwWait = INFINITE;
+            if (v_dwMilliseconds != INFINITE)
+            {
+                DWORD dwElapsed = tick_count() - dwStart;
+                if (dwElapsed >= v_dwMilliseconds)
+                {
+                    break;
+                }
+                dwWait = v_dwMilliseconds - dwElapsed;
+            }
+            futex::wait(&m_nCount, 0, dwWait);
+        }
+        --m_nWaiters;
+
+        return bRet;
+    }
+
+private:
+    counting_semaphore(const counting_semaphore &);
+    counting_semaphore &operator=(const counting_semaphore &);
+
+private:
+    volatile LONG m_nCount;  // 计数，同时作为futex等待地址
+    atomic<LONG> m_nWaiters; // 挂起或即将挂起的线程数
+};
+
+#endif // SEMAPHORE_HPP
\ No newline at end of file
@@ -0,0 +1,107 @@
+﻿/**
+ * @file seqlock.hpp
+ * @brief 顺序锁，读者不写任何共享数据，适合被大量线程频繁读取、偶尔更新的小结构
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef SEQLOCK_HPP
+#define SEQLOCK_HPP
+
+#include <string.h>
+
+#include "atomic.hpp"
+#include "mutex.hpp"
+#include "spinlock.hpp"
+
+/**
+ * @brief 顺序锁
+ * @details 写者之间用互斥量排队，写之前把版本号加1变为奇数，写完再加1变为偶数；
+ *          读者先读版本号，为奇数说明正在写，等待后重试；否则复制数据后再读一次版本号，两次相同说明复制期间没有写，
+ *          不同则重试。读者只读不写，读者再多也不会争用缓存行
+ * @note T必须是POD类型，读者复制时可能读到写了一半的数据，会被版本号检查丢弃，复制本身不能有副作用；
+ *       写很频繁时读者可能反复重试
+ * @tparam T 受保护的数据类型
+ */
+template <typename T> class seqlock
+{
+public:
+    seqlock() : m_nSeq(0), m_value() {}
+    seqlock(const T &v_value) : m_nSeq(0), m_value(v_value) {}
+
+public:
+    /**
+     * @brief 读取一致的快照
+     */
+    T load() const
+    {
+        T value;
+        load(value);
+        return value;
+    }
+
+    void load(T &v_value) const
+    {
+        spin_backoff backoff;
+        while (TRUE)
+        {
+            DWORD nSeq = m_nSeq.load(memory_order_acquire);
+            if ((nSeq & 1) == 0)
+            {
+                ::memcpy(&v_value, &m_value, sizeof(T));
+                atomic_thread_fence(memory_order_acquire); // 复制数据的读不会重排到再次读取版本号之后
+                if (m_nSeq.load(memory_order_relaxed) == nSeq)
+                {
+                    return;
+                }
+            }
+            backoff.pause();
+        }
+    }
+
+    void store(const T &v_value)
+    {
+        unique_lock<mutex> lock(m_mutex);
+        begin_write();
+        ::memcpy(&m_value, &v_value, sizeof(T));
+        end_write();
+    }
+
+    /**
+     * @brief 原地修改，v_func(T&)在持有写锁期间执行，适合只改部分字段
+     * @param [in] v_func 函数或函数对象
+     */
+    template <typename F>
+    void update(F v_func)
+    {
+        unique_lock<mutex> lock(m_mutex);
+        begin_write();
+        v_func(m_value);
+        end_write();
+    }
+
+    /**
+     * @brief 当前版本号，每次写入加2
+     */
+    DWORD sequence() const { return m_nSeq.load(memory_order_acquire); }
+
+private:
+    void begin_write()
+    {
+        m_nSeq.store(m_nSeq.load(memory_order_relaxed) + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release); // 版本号变为奇数先于数据的写入被看到
+    }
+
+    void end_write() { m_nSeq.store(m_nSeq.load(memory_order_relaxed) + 1, memory_order_release); }
+
+private:
+    seqlock(const seqlock &);
+    seqlock &operator=(const seqlock &);
+
+private:
+    atomic<DWORD> m_nSeq; // 版本号，奇数表示正在写
+    T m_value;            // 受保护的数据
+    mutex m_mutex;        // 写者之间排队
+};
+
+#endif // SEQLOCK_HPP
\ No newline at end of file
@@ -0,0 +1,117 @@
+﻿/**
+ * @file sharded_counter.hpp
+ * @brief 分片计数器，多线程频繁累加、偶尔读取的场景
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef SHARDED_COUNTER_HPP
+#define SHARDED_COUNTER_HPP
+
+#include <new>
+
+#include "atomic.hpp"
+
+/**
+ * @brief 分片计数器
+ * @details 每个线程固定使用一个分片，分片各自独占缓存行，累加时只修改本线程的分片，不同线程之间没有缓存行争用；
+ *          读取时累加所有分片，线程数超过分片数时多个线程共用分片，仍然是原子累加
+ * @note 并发修改时读到的只是某一时刻附近的近似值，适合统计计数，不适合作为同步条件
+ * @tparam T 计数类型，整数
+ */
+template <typename T = LONG> class sharded_counter
+{
+    struct slot
+    {
+        atomic<T> m_value;
+        char m_pad[CACHE_LINE_SIZE - sizeof(atomic<T>)];
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nShards 分片数，会向上取整为2的幂，0表示逻辑处理器个数的2倍
+     */
+    sharded_counter(size_t v_nShards = 0)
+    {
+        if (v_nShards == 0)
+        {
+            v_nShards = processor_count() * 2;
+        }
+        size_t nShards = 1;
+        while (nShards < v_nShards)
+        {
+            nShards <<= 1;
+        }
+        m_nMask = nShards - 1;
+
+        // 按缓存行对齐分配分片，每个分片恰好占一个缓存行
+        m_pBuffer = new char[sizeof(slot) * nShards + CACHE_LINE_SIZE];
+        size_t nOffset = reinterpret_cast<size_t>(m_pBuffer) % CACHE_LINE_SIZE;
+        m_pSlots = reinterpret_cast<slot *>(m_pBuffer + (nOffset ? CACHE_LINE_SIZE - nOffset : 0));
+        for (size_t i = 0; i < nShards; ++i)
+        {
+            new (&m_pSlots[i]) slot();
+        }
+    }
+    virtual ~sharded_counter()
+    {
+        for (size_t i = 0; i <= m_nMask; ++i)
+        {
+            m_pSlots[i].~slot();
+        }
+        delete[] m_pBuffer;
+    }
+
+public:
+    void add(T v_value) { local_slot().m_value.fetch_add(v_value, memory_order_relaxed); }
+    void sub(T v_value) { local_slot().m_value.fetch_sub(v_value, memory_order_relaxed); }
+    void operator++() { add(1); }
+    void operator--() { sub(1); }
+    void operator+=(T v_value) { add(v_value); }
+    void operator-=(T v_value) { sub(v_value); }
+
+    /**
+     * @brief 累加所有分片
+     */
+    T load() const
+    {
+        T sum = 0;
+        for (size_t i = 0; i <= m_nMask; ++i)
+        {
+            sum += m_pSlots[i].m_value.load(memory_order_relaxed);
+        }
+        return sum;
+    }
+    operator T() const { return load(); }
+
+    /**
+     * @brief 清零，与累加并发时可能丢失部分累加
+     */
+    void reset()
+    {
+        for (size_t i = 0; i <= m_nMask; ++i)
+        {
+            m_pSlots[i].m_value.store(0, memory_order_relaxed);
+        }
+    }
+
+    size_t shards() const { return m_nMask + 1; }
+
+private:
+    /**
+     * @brief 当前线程使用的分片，相邻创建的线程使用相邻的分片
+     */
+    slot &local_slot() { return m_pSlots[current_thread_index() & m_nMask]; }
+
+private:
+    sharded_counter(const sharded_counter &);
+    sharded_counter &operator=(const sharded_counter &);
+
+private:
+    slot *m_pSlots;  // 分片数组，按缓存行对齐
+    char *m_pBuffer; // 分片数组的原始内存
+    size_t m_nMask;  // 分片下标掩码，分片数-1
+};
+
+#endif // SHARDED_COUNTER_HPP
\ No newline at end of file
@@ -37,87 +37,354 @@ private:
     BOOL m_bLocked;
 };
 
+/**
+ * @brief 局部可升级锁的模板实现，构造时获得可升级锁，upgrade()后转为独占锁
+ */
+template <class T>
+class upgrade_lock
+{
+public:
+    upgrade_lock(T &mutex) : m_mutex(mutex), m_bUpgraded(FALSE) { m_mutex.lock_upgrade(); }
+    ~upgrade_lock()
+    {
+        if (m_bUpgraded)
+        {
+            m_mutex.unlock();
+        }
+        else
+        {
+            m_mutex.unlock_upgrade();
+        }
+    }
+
+    /**
+     * @brief 升级为独占锁，等待其他读者退出，期间不释放锁
+     */
+    void upgrade()
+    {
+        if (!m_bUpgraded)
+        {
+            m_mutex.unlock_upgrade_and_lock();
+            m_bUpgraded = TRUE;
+        }
+    }
+
+private:
+    T &m_mutex;
+    BOOL m_bUpgraded;
+};
+
 /**
  * @brief 共享/读写互斥量
+ * @details 写者分两步加锁：先在第一道门取得写标志，阻止新的读者进入，再在第二道门等待已有读者退出。
+ *          可升级锁与普通读者共存，但与写者及其他可升级锁互斥，升级时不释放锁，不必重新校验读到的数据
+ * @note 公平策略决定读者和写者同时等待时谁先进入：
+ *       reader_preferring 读者优先，只要没有写者持有锁读者即可进入，写者等到没有读者时才进入，读者不断时写者会饿死；
+ *       writer_preferring 写者优先，有写者等待时新读者不再进入，写者不断时读者会饿死；
+ *       phase_fair 读写交替，有写者等待时新读者等待，写者解锁后，解锁前已在等待的读者先于下一个写者进入，双方都不会饿死
  */
 class shared_mutex
 {
 public:
-    shared_mutex() : m_bWriteEntered(false), m_nReaders(0) {}
+    enum policy
+    {
+        reader_preferring,
+        writer_preferring,
+        phase_fair
+    };
 
 public:
-    void lock()
+    shared_mutex(policy v_policy = phase_fair)
+        : m_policy(v_policy), m_bWriteEntered(false), m_bUpgrade(false), m_nReaders(0), m_nWritersWaiting(0),
+          m_nReadersWaiting(0), m_nReadersAdmitted(0), m_nWriteGen(0)
+    {
+    }
+
+public:
+    void lock() { lock_for(INFINITE); }
+
+    void unlock()
     {
         unique_lock<mutex> lock(m_mutex);
-        while (m_bWriteEntered)
+        m_bWriteEntered = false;
+        if (m_policy == phase_fair)
         {
-            m_cvGate1.wait(lock);
+            // 解锁前已在等待的读者都放行，下一个写者等它们进入后才能取得写标志
+            ++m_nWriteGen;
+            m_nReadersAdmitted = m_nReadersWaiting;
         }
+        m_cvGate1.notify_all();
+    }
 
+    bool try_lock()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        if (!can_enter_write() || m_nReaders > 0)
+        {
+            return false;
+        }
         m_bWriteEntered = true;
+        return true;
+    }
+
+    /**
+     * @brief 限时获得独占锁
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return bool 是否获得锁
+     */
+    bool try_lock_for(DWORD v_dwMilliseconds) { return lock_for(v_dwMilliseconds); }
+
+    void lock_shared() { lock_shared_for(FALSE, INFINITE); }
+
+    void unlock_shared()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        --m_nReaders;
+        release_reader();
+    }
+
+    bool try_lock_shared()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        if (!can_enter_read(FALSE, m_nWriteGen))
+        {
+            return false;
+        }
+        ++m_nReaders;
+        return true;
+    }
+
+    /**
+     * @brief 限时获得共享锁
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return bool 是否获得锁
+     */
+    bool try_lock_shared_for(DWORD v_dwMilliseconds) { return lock_shared_for(FALSE, v_dwMilliseconds); }
+
+    /**
+     * @brief 获得可升级锁，与普通读者共存，同一时刻只有一个可升级锁
+     */
+    void lock_upgrade() { lock_shared_for(TRUE, INFINITE); }
+
+    bool try_lock_upgrade()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        if (!can_enter_read(TRUE, m_nWriteGen))
+        {
+            return false;
+        }
+        m_bUpgrade = true;
+        return true;
+    }
 
+    bool try_lock_upgrade_for(DWORD v_dwMilliseconds) { return lock_shared_for(TRUE, v_dwMilliseconds); }
+
+    void unlock_upgrade()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_bUpgrade = false;
+        m_cvGate1.notify_all();
+    }
+
+    /**
+     * @brief 可升级锁升级为独占锁，先取得写标志阻止新读者，再等待已有读者退出
+     * @note 持有可升级锁时没有写者能取得写标志，升级总能成功，不会死锁
+     */
+    void unlock_upgrade_and_lock()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        m_bWriteEntered = true;
+        m_bUpgrade = false;
         while (m_nReaders > 0)
         {
             m_cvGate2.wait(lock);
         }
     }
 
-    void unlock()
+    /**
+     * @brief 可升级锁降级为共享锁，放行其他可升级锁和写者
+     */
+    void unlock_upgrade_and_lock_shared()
     {
         unique_lock<mutex> lock(m_mutex);
-        m_bWriteEntered = false;
+        m_bUpgrade = false;
+        ++m_nReaders;
         m_cvGate1.notify_all();
     }
 
-    bool try_lock()
+private:
+    /**
+     * @brief 是否可以取得写标志
+     */
+    bool can_enter_write() const
     {
-        unique_lock<mutex> lock(m_mutex);
-        if (m_bWriteEntered || m_nReaders > 0)
+        if (m_bWriteEntered || m_bUpgrade)
         {
             return false;
         }
-        m_bWriteEntered = true;
-        return true;
+
+        switch (m_policy)
+        {
+        case reader_preferring:
+            return m_nReaders == 0;
+        case writer_preferring:
+            return true;
+        default:
+            return m_nReadersAdmitted == 0;
+        }
     }
 
-    void lock_shared()
+    /**
+     * @brief 读者是否可以进入
+     * @param [in] v_bUpgrade 是否获得可升级锁
+     * @param [in] v_nGen 读者开始等待时的写者代数
+     */
+    bool can_enter_read(BOOL v_bUpgrade, DWORD v_nGen) const
     {
-        unique_lock<mutex> lock(m_mutex);
-        while (m_bWriteEntered)
+        if (m_bWriteEntered || (v_bUpgrade && m_bUpgrade))
         {
-            m_cvGate1.wait(lock);
+            return false;
+        }
+
+        switch (m_policy)
+        {
+        case reader_preferring:
+            return true;
+        case writer_preferring:
+            return m_nWritersWaiting == 0;
+        default:
+            return m_nWritersWaiting == 0 || v_nGen != m_nWriteGen;
         }
-        ++m_nReaders;
     }
 
-    void unlock_shared()
+    /**
+     * @brief 等待条件变量，调用方醒来后重新检查条件
+     * @param [in] v_dwStart 开始等待时的tick_count()
+     * @param [in] v_dwMilliseconds 总的超时时间，INFINITE表示无限等待
+     * @return BOOL FALSE 已超时
+     */
+    static BOOL wait_gate(condition_variable &v_cv, unique_lock<mutex> &v_lock, DWORD v_dwStart,
+                          DWORD v_dwMilliseconds)
     {
+        if (v_dwMilliseconds == INFINITE)
+        {
+            v_cv.wait(v_lock);
+            return TRUE;
+        }
+
+        DWORD dwElapsed = tick_count() - v_dwStart;
+        if (dwElapsed >= v_dwMilliseconds)
+        {
+            return FALSE;
+        }
+        v_cv.wait_for(v_lock, v_dwMilliseconds - dwElapsed);
+        return TRUE;
+    }
+
+    bool lock_for(DWORD v_dwMilliseconds)
+    {
+        DWORD dwStart = tick_count();
         unique_lock<mutex> lock(m_mutex);
-        --m_nReaders;
 
-        if (0 == m_nReaders && m_bWriteEntered)
+        ++m_nWritersWaiting;
+        while (!can_enter_write())
         {
-            m_cvGate2.notify_one();
+            if (!wait_gate(m_cvGate1, lock, dwStart, v_dwMilliseconds))
+            {
+                --m_nWritersWaiting;
+                m_cvGate1.notify_all(); // 因等待的写者而阻塞的读者可以进入了
+                return false;
+            }
         }
+        --m_nWritersWaiting;
+
+        m_bWriteEntered = true;
+        while (m_nReaders > 0)
+        {
+            if (!wait_gate(m_cvGate2, lock, dwStart, v_dwMilliseconds))
+            {
+                m_bWriteEntered = false;
+                m_cvGate1.notify_all();
+                return false;
+            }
+        }
+        return true;
     }
 
-    bool try_lock_shared()
+    bool lock_shared_for(BOOL v_bUpgrade, DWORD v_dwMilliseconds)
     {
+        DWORD dwStart = tick_count();
         unique_lock<mutex> lock(m_mutex);
-        if (!m_bWriteEntered)
+
+        DWORD nGen = m_nWriteGen;
+        if (!can_enter_read(v_bUpgrade, nGen))
+        {
+            bool bEntered = true;
+            ++m_nReadersWaiting;
+            while (!can_enter_read(v_bUpgrade, nGen))
+            {
+                if (!wait_gate(m_cvGate1, lock, dwStart, v_dwMilliseconds))
+                {
+                    bEntered = false;
+                    break;
+                }
+            }
+            --m_nReadersWaiting;
+
+            // 写者解锁时放行的读者，全部离开等待后下一个写者才能取得写标志
+            if (m_policy == phase_fair && nGen != m_nWriteGen && --m_nReadersAdmitted == 0 && m_nWritersWaiting > 0)
+            {
+                m_cvGate1.notify_all();
+            }
+            if (!bEntered)
+            {
+                return false;
+            }
+        }
+
+        if (v_bUpgrade)
+        {
+            m_bUpgrade = true;
+        }
+        else
         {
             ++m_nReaders;
-            return true;
         }
-        return false;
+        return true;
+    }
+
+    /**
+     * @brief 读者退出后唤醒等待读者退出的写者
+     */
+    void release_reader()
+    {
+        if (m_nReaders > 0)
+        {
+            return;
+        }
+
+        if (m_bWriteEntered)
+        {
+            m_cvGate2.notify_one();
+        }
+        else if (m_nWritersWaiting > 0)
+        {
+            m_cvGate1.notify_all();
+        }
     }
 
 private:
     mutex m_mutex;
-    condition_variable m_cvGate1;
-    condition_variable m_cvGate2;
-    bool m_bWriteEntered;
-    unsigned int m_nReaders;
+    condition_variable m_cvGate1;    // 第一道门：等待取得写标志的写者、被阻止的读者和可升级锁
+    condition_variable m_cvGate2;    // 第二道门：已取得写标志、等待读者退出的写者
+    policy m_policy;                 // 公平策略
+    bool m_bWriteEntered;            // 写者已取得写标志
+    bool m_bUpgrade;                 // 可升级锁已被持有
+    unsigned int m_nReaders;         // 持有共享锁的读者数，不含可升级锁
+    unsigned int m_nWritersWaiting;  // 等待取得写标志的写者数
+    unsigned int m_nReadersWaiting;  // 等待进入的读者数，含可升级锁
+    unsigned int m_nReadersAdmitted; // phase_fair下写者解锁时放行、尚未离开等待的读者数
+    DWORD m_nWriteGen;               // 写者代数，phase_fair下每次写者解锁加1
 };
 
 #endif // SHARED_MUTEX_HPP
\ No newline at end of file
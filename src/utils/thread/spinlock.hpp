@@ -0,0 +1,125 @@
+﻿/**
+ * @file spinlock.hpp
+ * @brief 自旋锁和排队自旋锁，用于只有几条指令的极短临界区
+ * @note 持有锁期间不能阻塞，临界区较长或可能挂起时使用mutex或adaptive_mutex
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef SPINLOCK_HPP
+#define SPINLOCK_HPP
+
+#include "atomic.hpp"
+#include "thread.hpp"
+
+/**
+ * @brief 指数退避，每次等待的pause指令数翻倍，超过上限后改为让出CPU
+ * @note 单核机器上持有者无法在自旋期间运行，直接让出CPU
+ */
+class spin_backoff
+{
+public:
+    enum
+    {
+        MAX_PAUSE = 64 // 单次等待的最大pause指令数
+    };
+
+public:
+    spin_backoff() : m_nPause(1) {}
+
+public:
+    void pause()
+    {
+        if (m_nPause > MAX_PAUSE || default_spin_count() == 0)
+        {
+            this_thread::yield();
+            return;
+        }
+
+        for (int i = 0; i < m_nPause; ++i)
+        {
+            cpu_relax();
+        }
+        m_nPause <<= 1;
+    }
+
+    void reset() { m_nPause = 1; }
+
+private:
+    int m_nPause; // 下次等待的pause指令数
+};
+
+/**
+ * @brief 自旋锁，先读后抢（test-and-test-and-set），等待期间只读本地缓存，不反复争抢缓存行
+ * @note 不保证公平，释放后由最先看到的线程抢到
+ */
+class spinlock
+{
+public:
+    spinlock() {}
+
+public:
+    void lock()
+    {
+        while (m_flag.test_and_set(memory_order_acquire))
+        {
+            spin_backoff backoff;
+            do
+            {
+                backoff.pause();
+            } while (m_flag.test(memory_order_relaxed));
+        }
+    }
+
+    void unlock() { m_flag.clear(memory_order_release); }
+
+    BOOL try_lock() { return !m_flag.test(memory_order_relaxed) && !m_flag.test_and_set(memory_order_acquire); }
+
+private:
+    spinlock(const spinlock &);
+    spinlock &operator=(const spinlock &);
+
+private:
+    atomic_flag m_flag; // 锁标志
+};
+
+/**
+ * @brief 排队自旋锁，按到达顺序获得锁，避免争用激烈时个别线程长期抢不到
+ * @details 加锁时领取票号，等待叫号等于票号；解锁时叫下一个号。票号为无符号数，回绕后仍能正确比较
+ * @note 严格按顺序交接，轮到的线程若被调度出去，后面的线程都要等它，线程数多于CPU数时不宜使用
+ */
+class ticket_lock
+{
+public:
+    ticket_lock() : m_nNext(0), m_nServing(0) {}
+
+public:
+    void lock()
+    {
+        DWORD nTicket = m_nNext.fetch_add(1, memory_order_relaxed);
+        spin_backoff backoff;
+        while (m_nServing.load(memory_order_acquire) != nTicket)
+        {
+            backoff.pause();
+        }
+    }
+
+    void unlock() { m_nServing.store(m_nServing.load(memory_order_relaxed) + 1, memory_order_release); }
+
+    BOOL try_lock()
+    {
+        DWORD nServing = m_nServing.load(memory_order_acquire);
+        DWORD nTicket = nServing;
+        return m_nNext.compare_exchange_strong(nTicket, nServing + 1, memory_order_acquire);
+    }
+
+private:
+    ticket_lock(const ticket_lock &);
+    ticket_lock &operator=(const ticket_lock &);
+
+private:
+    atomic<DWORD> m_nNext;    // 下一个票号
+    atomic<DWORD> m_nServing; // 当前叫号，等于持有者的票号
+};
+
+#endif // SPINLOCK_HPP
\ No newline at end of file
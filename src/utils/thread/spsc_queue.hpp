@@ -0,0 +1,333 @@
+﻿/**
+ * @file spsc_queue.hpp
+ * @brief 无等待有界单生产者单消费者环形队列
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include "atomic.hpp"
+#include "event_count.hpp"
+#include "spinlock.hpp"
+
+/**
+ * @brief 无等待有界单生产者单消费者环形队列，只允许一个线程写入、一个线程读取
+ * @details 生产者只写尾下标，消费者只写头下标，两个下标各自独占缓存行，读写都不需要原子读改写指令；
+ *          双方各自缓存对方下标的副本，只有按副本判断为满/空时才去读对方的缓存行，
+ *          连续读写时大部分操作只访问本方的缓存行和槽位；批量读写时整批只发布一次下标
+ * @note 构造时指定是否支持阻塞等待：支持时每次发布下标后需要一次完整屏障检查事件计数器上的等待者，
+ *       不支持时不做任何通知，push_back()/pop()在队列满/空时退避自旋，适合双方都在忙碌轮询的流水线
+ * @tparam T 消息类型，需可默认构造和复制
+ */
+template <typename T> class spsc_queue
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nCapacity 队列容量，会向上取整为2的幂，0表示使用默认容量
+     * @param [in] v_bBlocking 队列满/空时是否挂起等待，FALSE时退避自旋
+     */
+    spsc_queue(size_t v_nCapacity = 10000, BOOL v_bBlocking = TRUE)
+        : m_nTail(0), m_nHeadCache(0), m_nHead(0), m_nTailCache(0), m_bBlocking(v_bBlocking)
+    {
+        size_t nCapacity = 2;
+        while (nCapacity < (v_nCapacity == 0 ? static_cast<size_t>(DEFAULT_CAPACITY) : v_nCapacity))
+        {
+            nCapacity <<= 1;
+        }
+        m_nMask = nCapacity - 1;
+        m_pSlots = new T[nCapacity];
+    }
+    virtual ~spsc_queue() { delete[] m_pSlots; }
+
+public:
+    /**
+     * @brief 向队列尾部添加消息，队列满时等待，只能由生产者调用
+     * @param [in] v_tMsg 消息内容
+     */
+    void push_back(const T &v_tMsg)
+    {
+        if (try_push_back(v_tMsg))
+        {
+            return;
+        }
+
+        spin_backoff backoff;
+        while (!try_push_back(v_tMsg))
+        {
+            if (!m_bBlocking)
+            {
+                backoff.pause();
+                continue;
+            }
+
+            LONG nKey = m_ecNotFull.prepare_wait();
+            if (try_push_back(v_tMsg))
+            {
+                m_ecNotFull.cancel_wait();
+                return;
+            }
+            m_ecNotFull.commit_wait(nKey);
+        }
+    }
+
+    /**
+     * @brief 尝试向队列尾部添加消息，只能由生产者调用
+     * @param [in] v_tMsg 消息内容
+     * @return BOOL 是否成功添加，只有队列满时失败
+     */
+    BOOL try_push_back(const T &v_tMsg)
+    {
+        size_t nTail = m_nTail.load(memory_order_relaxed);
+        if (nTail - m_nHeadCache > m_nMask)
+        {
+            m_nHeadCache = m_nHead.load(memory_order_acquire);
+            if (nTail - m_nHeadCache > m_nMask)
+            {
+                return FALSE;
+            }
+        }
+
+        m_pSlots[nTail & m_nMask] = v_tMsg;
+        publish_tail(nTail + 1);
+        return TRUE;
+    }
+
+    /**
+     * @brief 尝试向队列尾部批量添加消息，只能由生产者调用
+     * @param [in] v_pMsgs 消息数组
+     * @param [in] v_nCount 消息个数
+     * @return size_t 实际添加的消息个数，队列剩余空间不足时只添加一部分
+     */
+    size_t try_push_back_bulk(const T *v_pMsgs, size_t v_nCount)
+    {
+        size_t nTail = m_nTail.load(memory_order_relaxed);
+        size_t nFree = m_nMask + 1 - (nTail - m_nHeadCache);
+        if (nFree < v_nCount)
+        {
+            m_nHeadCache = m_nHead.load(memory_order_acquire);
+            nFree = m_nMask + 1 - (nTail - m_nHeadCache);
+        }
+        if (nFree > v_nCount)
+        {
+            nFree = v_nCount;
+        }
+        if (nFree == 0)
+        {
+            return 0;
+        }
+
+        for (size_t i = 0; i < nFree; ++i)
+        {
+            m_pSlots[(nTail + i) & m_nMask] = v_pMsgs[i];
+        }
+        publish_tail(nTail + nFree);
+        return nFree;
+    }
+
+    /**
+     * @brief 向队列尾部批量添加消息，队列满时等待，只能由生产者调用
+     * @param [in] v_pMsgs 消息数组
+     * @param [in] v_nCount 消息个数
+     */
+    void push_back_bulk(const T *v_pMsgs, size_t v_nCount)
+    {
+        spin_backoff backoff;
+        while (v_nCount > 0)
+        {
+            size_t nPush = try_push_back_bulk(v_pMsgs, v_nCount);
+            v_pMsgs += nPush;
+            v_nCount -= nPush;
+            if (nPush > 0)
+            {
+                backoff.reset();
+                continue;
+            }
+
+            if (!m_bBlocking)
+            {
+                backoff.pause();
+                continue;
+            }
+
+            LONG nKey = m_ecNotFull.prepare_wait();
+            if (!full())
+            {
+                m_ecNotFull.cancel_wait();
+                continue;
+            }
+            m_ecNotFull.commit_wait(nKey);
+        }
+    }
+
+    /**
+     * @brief 将队列头部消息弹出，队列为空时等待，只能由消费者调用
+     * @param [out] v_tMsg 弹出的消息内容
+     */
+    void pop(T &v_tMsg) { pop_bulk(&v_tMsg, 1); }
+
+    /**
+     * @brief 尝试将队列头部消息弹出，只能由消费者调用
+     * @param [out] v_tMsg 弹出的消息内容
+     * @return BOOL 是否成功弹出，只有队列空时失败
+     */
+    BOOL try_pop(T &v_tMsg)
+    {
+        size_t nHead = m_nHead.load(memory_order_relaxed);
+        if (nHead == m_nTailCache)
+        {
+            m_nTailCache = m_nTail.load(memory_order_acquire);
+            if (nHead == m_nTailCache)
+            {
+                return FALSE;
+            }
+        }
+
+        v_tMsg = m_pSlots[nHead & m_nMask];
+        publish_head(nHead + 1);
+        return TRUE;
+    }
+
+    /**
+     * @brief 尝试批量弹出队列头部消息，只能由消费者调用
+     * @param [out] v_pMsgs 弹出的消息，至少能容纳v_nMax个
+     * @param [in] v_nMax 最多弹出的消息个数
+     * @return size_t 实际弹出的消息个数，队列为空时返回0
+     */
+    size_t try_pop_bulk(T *v_pMsgs, size_t v_nMax)
+    {
+        size_t nHead = m_nHead.load(memory_order_relaxed);
+        size_t nReady = m_nTailCache - nHead;
+        if (nReady < v_nMax)
+        {
+            m_nTailCache = m_nTail.load(memory_order_acquire);
+            nReady = m_nTailCache - nHead;
+        }
+        if (nReady > v_nMax)
+        {
+            nReady = v_nMax;
+        }
+        if (nReady == 0)
+        {
+            return 0;
+        }
+
+        for (size_t i = 0; i < nReady; ++i)
+        {
+            v_pMsgs[i] = m_pSlots[(nHead + i) & m_nMask];
+        }
+        publish_head(nHead + nReady);
+        return nReady;
+    }
+
+    /**
+     * @brief 批量弹出队列头部消息，队列为空时等待，只能由消费者调用
+     * @param [out] v_pMsgs 弹出的消息，至少能容纳v_nMax个
+     * @param [in] v_nMax 最多弹出的消息个数
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒，INFINITE表示无限等待
+     * @return size_t 实际弹出的消息个数，超时返回0
+     */
+    size_t pop_bulk(T *v_pMsgs, size_t v_nMax, DWORD v_dwMilliseconds = INFINITE)
+    {
+        size_t nPop = try_pop_bulk(v_pMsgs, v_nMax);
+        if (nPop > 0)
+        {
+            return nPop;
+        }
+
+        DWORD dwStart = tick_count();
+        spin_backoff backoff;
+        while ((nPop = try_pop_bulk(v_pMsgs, v_nMax)) == 0)
+        {
+            DWORD dwWait = INFINITE;
+            if (v_dwMilliseconds != INFINITE)
+            {
+                DWORD dwElapsed = tick_count() - dwStart;
+                if (dwElapsed >= v_dwMilliseconds)
+                {
+                    return 0;
+                }
+                dwWait = v_dwMilliseconds - dwElapsed;
+            }
+
+            if (!m_bBlocking)
+            {
+                backoff.pause();
+                continue;
+            }
+
+            LONG nKey = m_ecNotEmpty.prepare_wait();
+            if (!empty())
+            {
+                m_ecNotEmpty.cancel_wait();
+                continue;
+            }
+            m_ecNotEmpty.commit_wait(nKey, dwWait);
+        }
+        return nPop;
+    }
+
+public:
+    /**
+     * @brief 消息个数，由生产者或消费者以外的线程调用时只是近似值
+     */
+    size_t size() const { return m_nTail.load(memory_order_acquire) - m_nHead.load(memory_order_acquire); }
+    BOOL empty() const { return size() == 0; }
+    BOOL full() const { return size() > m_nMask; }
+    size_t capacity() const { return m_nMask + 1; }
+    BOOL blocking() const { return m_bBlocking; }
+
+private:
+    /**
+     * @brief 发布新的尾下标，之前写入的槽位对消费者可见
+     */
+    void publish_tail(size_t v_nTail)
+    {
+        m_nTail.store(v_nTail, memory_order_release);
+        if (m_bBlocking)
+        {
+            m_ecNotEmpty.notify_one();
+        }
+    }
+
+    /**
+     * @brief 发布新的头下标，之前读取的槽位可被生产者覆盖
+     */
+    void publish_head(size_t v_nHead)
+    {
+        m_nHead.store(v_nHead, memory_order_release);
+        if (m_bBlocking)
+        {
+            m_ecNotFull.notify_one();
+        }
+    }
+
+private:
+    spsc_queue(const spsc_queue &);
+    spsc_queue &operator=(const spsc_queue &);
+
+private:
+    enum
+    {
+        DEFAULT_CAPACITY = 65536 // 容量为0时使用的默认容量
+    };
+
+    char m_pad0[CACHE_LINE_SIZE];
+    atomic<size_t> m_nTail; // 尾下标，只由生产者修改
+    size_t m_nHeadCache;    // 生产者缓存的头下标
+    char m_pad1[CACHE_LINE_SIZE - sizeof(atomic<size_t>) - sizeof(size_t)];
+    atomic<size_t> m_nHead; // 头下标，只由消费者修改
+    size_t m_nTailCache;    // 消费者缓存的尾下标
+    char m_pad2[CACHE_LINE_SIZE - sizeof(atomic<size_t>) - sizeof(size_t)];
+
+    T *m_pSlots;      // 槽位数组
+    size_t m_nMask;   // 下标掩码，容量-1
+    BOOL m_bBlocking; // 队列满/空时是否挂起等待
+
+    event_count m_ecNotEmpty; // 消费者在队列空时等待
+    event_count m_ecNotFull;  // 生产者在队列满时等待
+};
+
+#endif // SPSC_QUEUE_HPP
\ No newline at end of file
@@ -0,0 +1,204 @@
+﻿/**
+ * @file task.hpp
+ * @brief 类型擦除的任务，小函数对象直接存放在对象内部，不分配内存
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <new>
+
+#include "atomic.hpp"
+#include "object_pool.hpp"
+
+#if defined(_MSC_VER)
+#define TASK_ALIGNOF(T) __alignof(T)
+#else
+#define TASK_ALIGNOF(T) __alignof__(T)
+#endif
+
+/**
+ * @brief 类型擦除的任务，可保存任意无参数调用的函数对象
+ * @details 不超过INLINE_SIZE字节的函数对象直接构造在内部缓冲区中（小对象优化），创建和拷贝都不分配内存；
+ *          更大的函数对象从object_pool分配，拷贝task时共享同一个对象并增加引用计数，不重复拷贝函数对象。
+ *          支持函数指针、C++98函数对象和C++11的lambda，lambda捕获的内容不超过INLINE_SIZE字节时同样不分配内存
+ * @note 函数对象按内部缓冲区的对齐方式存放，需要比double和指针更严格对齐的类型无法通过编译
+ */
+class task
+{
+public:
+    enum
+    {
+        INLINE_SIZE = 48 // 内部缓冲区大小，单位字节
+    };
+
+public:
+    task() : m_pOps(NULL) {}
+    task(void (*v_pfnFunc)()) : m_pOps(NULL)
+    {
+        if (v_pfnFunc)
+        {
+            construct(v_pfnFunc);
+        }
+    }
+    template <typename F>
+    task(const F &v_func) : m_pOps(NULL)
+    {
+        construct(v_func);
+    }
+    task(const task &v_other) : m_pOps(v_other.m_pOps)
+    {
+        if (m_pOps)
+        {
+            m_pOps->m_pfnCopy(&m_storage, &v_other.m_storage);
+        }
+    }
+    ~task() { reset(); }
+
+    task &operator=(const task &v_other)
+    {
+        if (this != &v_other)
+        {
+            reset();
+            if (v_other.m_pOps)
+            {
+                v_other.m_pOps->m_pfnCopy(&m_storage, &v_other.m_storage);
+                m_pOps = v_other.m_pOps;
+            }
+        }
+        return *this;
+    }
+
+public:
+    /**
+     * @brief 执行任务，空任务什么也不做
+     */
+    void operator()() const
+    {
+        if (m_pOps)
+        {
+            m_pOps->m_pfnInvoke(const_cast<storage *>(&m_storage));
+        }
+    }
+
+    BOOL empty() const { return m_pOps == NULL; }
+
+    /**
+     * @brief 函数对象是否存放在内部缓冲区中，空任务返回TRUE
+     */
+    BOOL is_inline() const { return m_pOps == NULL || m_pOps->m_bInline; }
+
+    /**
+     * @brief 释放函数对象，变为空任务
+     */
+    void reset()
+    {
+        if (m_pOps)
+        {
+            m_pOps->m_pfnDestroy(&m_storage);
+            m_pOps = NULL;
+        }
+    }
+
+private:
+    union storage // 内部缓冲区，成员只用于对齐
+    {
+        char m_buffer[INLINE_SIZE];
+        double m_dAlign;
+        void *m_pAlign;
+        LONGLONG m_llAlign;
+    };
+
+    struct operations // 按函数对象类型生成的操作表
+    {
+        void (*m_pfnInvoke)(storage *);
+        void (*m_pfnCopy)(storage *, const storage *);
+        void (*m_pfnDestroy)(storage *);
+        BOOL m_bInline;
+    };
+
+    /**
+     * @brief 函数对象存放在内部缓冲区
+     */
+    template <typename F, bool bInline = (sizeof(F) <= INLINE_SIZE)>
+    struct manager
+    {
+        // 对齐要求超过内部缓冲区时数组长度为-1，编译报错
+        typedef char functor_over_aligned[TASK_ALIGNOF(F) <= TASK_ALIGNOF(storage) ? 1 : -1];
+
+        static void create(storage *v_pStorage, const F &v_func) { new (v_pStorage->m_buffer) F(v_func); }
+        static F *get(storage *v_pStorage) { return reinterpret_cast<F *>(v_pStorage->m_buffer); }
+
+        static void invoke(storage *v_pStorage) { (*get(v_pStorage))(); }
+        static void copy(storage *v_pDst, const storage *v_pSrc)
+        {
+            create(v_pDst, *reinterpret_cast<const F *>(v_pSrc->m_buffer));
+        }
+        static void destroy(storage *v_pStorage) { get(v_pStorage)->~F(); }
+
+        static const operations s_ops;
+    };
+
+    /**
+     * @brief 函数对象从对象池分配，多个task共享，引用计数为0时释放
+     */
+    template <typename F>
+    struct manager<F, false>
+    {
+        struct holder
+        {
+            holder(const F &v_func) : m_nRefs(1), m_func(v_func) {}
+
+            atomic<LONG> m_nRefs; // 引用计数
+            F m_func;             // 函数对象
+        };
+
+        static void create(storage *v_pStorage, const F &v_func)
+        {
+            v_pStorage->m_pAlign = object_pool<holder>::create(v_func);
+        }
+        static holder *get(const storage *v_pStorage) { return static_cast<holder *>(v_pStorage->m_pAlign); }
+
+        static void invoke(storage *v_pStorage) { get(v_pStorage)->m_func(); }
+        static void copy(storage *v_pDst, const storage *v_pSrc)
+        {
+            ++get(v_pSrc)->m_nRefs;
+            v_pDst->m_pAlign = v_pSrc->m_pAlign;
+        }
+        static void destroy(storage *v_pStorage)
+        {
+            holder *pHolder = get(v_pStorage);
+            if (--pHolder->m_nRefs == 0)
+            {
+                object_pool<holder>::destroy(pHolder);
+            }
+        }
+
+        static const operations s_ops;
+    };
+
+    template <typename F>
+    void construct(const F &v_func)
+    {
+        manager<F>::create(&m_storage, v_func);
+        m_pOps = &manager<F>::s_ops;
+    }
+
+private:
+    const operations *m_pOps; // 操作表，空任务为NULL
+    storage m_storage;        // 内部缓冲区
+};
+
+template <typename F, bool bInline>
+const task::operations task::manager<F, bInline>::s_ops = {&task::manager<F, bInline>::invoke,
+                                                          &task::manager<F, bInline>::copy,
+                                                          &task::manager<F, bInline>::destroy, TRUE};
+
+template <typename F>
+const task::operations task::manager<F, false>::s_ops = {&task::manager<F, false>::invoke,
+                                                         &task::manager<F, false>::copy,
+                                                         &task::manager<F, false>::destroy, FALSE};
+
+#endif // TASK_HPP
\ No newline at end of file
@@ -0,0 +1,223 @@
+﻿/**
+ * @file task_graph.hpp
+ * @brief 任务依赖图（有向无环图），在线程池上按依赖关系并行执行
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef TASK_GRAPH_HPP
+#define TASK_GRAPH_HPP
+
+#include <vector>
+
+#include "thread_pool.hpp"
+
+/**
+ * @brief 任务依赖图
+ * @details 节点和依赖边只声明一次，之后可以反复执行。每个节点有一个原子计数，执行前重置为前驱个数，
+ *          前驱执行完时减1，减到0的后继即可执行：第一个就绪的后继由刚执行完的工作线程直接执行，
+ *          不经过任务队列，其余就绪的后继批量提交到线程池，窃取模式下进入该工作线程的本地队列
+ * @note 执行期间不能修改图，同一个图不能同时执行多次
+ * @note run()阻塞等待整个图执行完，不应在同一线程池的工作线程中调用，否则工作线程都阻塞时会死锁
+ */
+class task_graph
+{
+public:
+    typedef size_t node_id; // 节点编号，按添加顺序从0开始
+
+public:
+    task_graph() : m_pPool(NULL), m_bChecked(FALSE), m_bAcyclic(TRUE) {}
+    virtual ~task_graph()
+    {
+        for (size_t i = 0; i < m_vecNodes.size(); ++i)
+        {
+            delete m_vecNodes[i];
+        }
+    }
+
+public:
+    /**
+     * @brief 添加节点
+     * @param [in] v_task 节点的任务
+     * @return node_id 节点编号
+     */
+    node_id add_node(const task_func &v_task)
+    {
+        node *pNode = new node(this, m_vecNodes.size(), v_task);
+        m_vecNodes.push_back(pNode);
+        m_bChecked = FALSE;
+        return m_vecNodes.size() - 1;
+    }
+
+    /**
+     * @brief 添加依赖边，v_to在v_from执行完之后才执行
+     * @param [in] v_from 前驱节点
+     * @param [in] v_to 后继节点
+     */
+    void precede(node_id v_from, node_id v_to)
+    {
+        m_vecNodes[v_from]->m_vecSuccessors.push_back(m_vecNodes[v_to]);
+        ++m_vecNodes[v_to]->m_nDependencies;
+        m_bChecked = FALSE;
+    }
+
+    /**
+     * @brief 在线程池上执行整个图，等待所有节点执行完
+     * @param [in] v_pool 执行节点的线程池
+     * @return BOOL 是否执行，图中有环时不执行，返回FALSE
+     */
+    BOOL run(thread_pool &v_pool)
+    {
+        if (!check())
+        {
+            return FALSE;
+        }
+        if (m_vecNodes.empty())
+        {
+            return TRUE;
+        }
+
+        m_pPool = &v_pool;
+        for (size_t i = 0; i < m_vecNodes.size(); ++i)
+        {
+            m_vecNodes[i]->m_nPending.store(m_vecNodes[i]->m_nDependencies, memory_order_relaxed);
+        }
+        m_wgNodes.add(static_cast<LONG>(m_vecNodes.size())); // 提交带完整屏障，工作线程能看到重置的计数
+        v_pool.submit_bulk(&m_vecRoots[0], m_vecRoots.size());
+        m_wgNodes.wait();
+        return TRUE;
+    }
+
+    /**
+     * @brief 图中是否没有环，结果缓存到图被修改为止
+     */
+    BOOL acyclic() { return check(); }
+
+    size_t size() const { return m_vecNodes.size(); }
+    BOOL empty() const { return m_vecNodes.empty(); }
+
+private:
+    enum
+    {
+        READY_BATCH = 32 // 一个节点执行完后，每批提交的就绪后继数
+    };
+
+    struct node
+    {
+        node(task_graph *v_pGraph, size_t v_nIndex, const task_func &v_task)
+            : m_pGraph(v_pGraph), m_nIndex(v_nIndex), m_task(v_task), m_nDependencies(0), m_nPending(0)
+        {
+        }
+
+        task_graph *m_pGraph;                // 所属的图
+        size_t m_nIndex;                     // 节点编号
+        task_func m_task;                    // 节点的任务
+        std::vector<node *> m_vecSuccessors; // 后继节点
+        LONG m_nDependencies;                // 前驱个数
+        atomic<LONG> m_nPending;             // 本次执行中尚未执行完的前驱个数
+    };
+
+    /**
+     * @brief 执行节点，之后沿就绪的后继继续执行
+     */
+    static void run_node(void *v_pParam)
+    {
+        node *pNode = static_cast<node *>(v_pParam);
+        task_graph *pGraph = pNode->m_pGraph;
+        task_func ready[READY_BATCH];
+        while (pNode)
+        {
+            pNode->m_task();
+
+            node *pNext = NULL;
+            size_t nReady = 0;
+            for (size_t i = 0; i < pNode->m_vecSuccessors.size(); ++i)
+            {
+                node *pSuccessor = pNode->m_vecSuccessors[i];
+                if (--pSuccessor->m_nPending != 0)
+                {
+                    continue;
+                }
+                if (!pNext)
+                {
+                    pNext = pSuccessor;
+                    continue;
+                }
+
+                ready[nReady++] = task_func(run_node, pSuccessor);
+                if (nReady == READY_BATCH)
+                {
+                    pGraph->m_pPool->submit_bulk(ready, nReady);
+                    nReady = 0;
+                }
+            }
+            if (nReady > 0)
+            {
+                pGraph->m_pPool->submit_bulk(ready, nReady);
+            }
+
+            // 最后一个节点计数后run()随即返回，图可能被析构：done()减到0只有一次原子操作，之后只按地址唤醒、
+            // 不再访问图（见latch），这里之后也只能访问计数尚未完成的pNext
+            pGraph->m_wgNodes.done();
+            pNode = pNext;
+        }
+    }
+
+    /**
+     * @brief 拓扑排序检查是否有环，同时记录没有前驱的节点
+     */
+    BOOL check()
+    {
+        if (m_bChecked)
+        {
+            return m_bAcyclic;
+        }
+
+        m_vecRoots.clear();
+        std::vector<LONG> vecDegrees(m_vecNodes.size());
+        std::vector<node *> vecReady;
+        for (size_t i = 0; i < m_vecNodes.size(); ++i)
+        {
+            vecDegrees[i] = m_vecNodes[i]->m_nDependencies;
+            if (vecDegrees[i] == 0)
+            {
+                vecReady.push_back(m_vecNodes[i]);
+                m_vecRoots.push_back(task_func(run_node, m_vecNodes[i]));
+            }
+        }
+
+        size_t nVisited = 0;
+        while (!vecReady.empty())
+        {
+            node *pNode = vecReady.back();
+            vecReady.pop_back();
+            ++nVisited;
+            for (size_t i = 0; i < pNode->m_vecSuccessors.size(); ++i)
+            {
+                node *pSuccessor = pNode->m_vecSuccessors[i];
+                if (--vecDegrees[pSuccessor->m_nIndex] == 0)
+                {
+                    vecReady.push_back(pSuccessor);
+                }
+            }
+        }
+
+        m_bAcyclic = nVisited == m_vecNodes.size();
+        m_bChecked = TRUE;
+        return m_bAcyclic;
+    }
+
+private:
+    task_graph(const task_graph &);
+    task_graph &operator=(const task_graph &);
+
+private:
+    std::vector<node *> m_vecNodes;    // 所有节点，下标即编号
+    std::vector<task_func> m_vecRoots; // 没有前驱的节点，执行时首先提交
+    thread_pool *m_pPool;              // 本次执行使用的线程池
+    wait_group m_wgNodes;              // 本次执行中尚未执行完的节点
+    BOOL m_bChecked;                   // 是否已检查过环
+    BOOL m_bAcyclic;                   // 检查结果，是否没有环
+};
+
+#endif // TASK_GRAPH_HPP
\ No newline at end of file
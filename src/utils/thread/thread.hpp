@@ -1,6 +1,6 @@
 ﻿/**
  * @file thread.hpp
- * @brief C++98 windows线程类
+ * @brief C++98 线程类，windows下基于_beginthreadex，linux下基于pthread
  * @author zhengw
  * @date 2024-07-03
  */
@@ -8,12 +8,17 @@
 #ifndef THREAD_WIN_HPP
 #define THREAD_WIN_HPP
 
+#include "platform.hpp"
+#include "topology.hpp"
+
+#if defined(_WIN32)
 #include <process.h>
-#include <windows.h>
 
 namespace this_thread
 {
 inline DWORD get_id() { return ::GetCurrentThreadId(); }
+inline void sleep_for(DWORD v_dwMilliseconds) { ::Sleep(v_dwMilliseconds); }
+inline void yield() { ::SwitchToThread(); }
 } // namespace this_thread
 
 class thread
@@ -144,11 +149,37 @@ public:
         }
     }
 
+    /**
+     * @brief 设置线程可运行的CPU
+     * @note windows下只支持当前处理器组的前sizeof(DWORD_PTR)*8个逻辑处理器，超出的CPU被忽略
+     * @param [in] v_cpus CPU集合
+     * @return BOOL 是否设置成功
+     */
+    BOOL set_affinity(const cpu_set &v_cpus)
+    {
+        DWORD_PTR dwMask = 0;
+        for (size_t nCpu = 0; nCpu < sizeof(DWORD_PTR) * 8; ++nCpu)
+        {
+            if (v_cpus.test(nCpu))
+            {
+                dwMask |= static_cast<DWORD_PTR>(1) << nCpu;
+            }
+        }
+
+        if (!valid() || dwMask == 0 || ::SetThreadAffinityMask(m_hThread, dwMask) == 0)
+        {
+            return FALSE;
+        }
+        m_affinity = v_cpus;
+        return TRUE;
+    }
+
     BOOL joinable() const { return (valid() && m_bRunning); }
     BOOL valid() const { return (m_hThread && m_hThread != INVALID_HANDLE_VALUE); }
     BOOL running() const { return m_bRunning; }
     UINT32 id() const { return m_uiThreadId; }
     int priority() const { return m_iPriority; }
+    const cpu_set &affinity() const { return m_affinity; }
 
     static DWORD hardware_concurrency()
     {
@@ -180,7 +211,293 @@ private:
     HANDLE m_hThread;    // 线程句柄
     UINT32 m_uiThreadId; // 线程ID
     int m_iPriority;     // 线程优先级
+    cpu_set m_affinity;  // 线程可运行的CPU，空集合表示未设置
     BOOL m_bRunning;     // 线程是否正在运行
 };
 
+#else
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+#ifndef THREAD_PRIORITY_NORMAL
+#define THREAD_PRIORITY_NORMAL 0
+#endif
+
+namespace this_thread
+{
+inline DWORD get_id() { return static_cast<DWORD>(::syscall(SYS_gettid)); }
+inline void sleep_for(DWORD v_dwMilliseconds)
+{
+    timespec ts;
+    ts.tv_sec = v_dwMilliseconds / 1000;
+    ts.tv_nsec = (v_dwMilliseconds % 1000) * 1000000L;
+    while (::nanosleep(&ts, &ts) == -1 && errno == EINTR)
+    {
+    }
+}
+inline void yield() { ::sched_yield(); }
+} // namespace this_thread
+
+/**
+ * @brief 线程类，接口与windows版本一致
+ * @note pthread不支持创建挂起的线程，create()只做标记，start()时才真正创建线程；
+ *       linux下也无法挂起其他线程，interrupt()不生效，sleep_for()只睡眠调用线程
+ * @note 线程在基类构造函数中启动时派生类尚未构造完成，派生类应以挂起方式构造，构造完成后再调用start()
+ */
+class thread
+{
+public:
+    virtual void run() = 0;
+
+public:
+    thread(BOOL v_bSuspend = FALSE)
+        : m_hThread(), m_bValid(FALSE), m_bStarted(FALSE), m_uiThreadId(0), m_iPriority(THREAD_PRIORITY_NORMAL),
+          m_bRunning(FALSE)
+    {
+        if (create() && !v_bSuspend)
+        {
+            start();
+        }
+    }
+    virtual ~thread() { join_for(0); }
+
+public:
+    /**
+     * @brief 创建线程
+     */
+    BOOL create()
+    {
+        if (valid())
+        {
+            return FALSE;
+        }
+
+        m_bValid = TRUE;
+        return valid();
+    }
+
+    /**
+     * @brief 启动线程
+     */
+    void start()
+    {
+        if (valid() && !running() && !m_bStarted)
+        {
+            // 启动前已设置的CPU亲和性在创建时生效，线程从一开始就运行在指定CPU上
+            pthread_attr_t attr;
+            ::pthread_attr_init(&attr);
+            if (!m_affinity.empty())
+            {
+                cpu_set_t mask;
+                to_cpu_set_t(m_affinity, mask);
+                ::pthread_attr_setaffinity_np(&attr, sizeof(mask), &mask);
+            }
+
+            m_bRunning = TRUE;
+            int iRet = ::pthread_create(&m_hThread, &attr, thread_func, this);
+            ::pthread_attr_destroy(&attr);
+            if (0 != iRet)
+            {
+                m_bRunning = FALSE;
+                m_bValid = FALSE;
+                return;
+            }
+            m_bStarted = TRUE;
+        }
+    }
+
+    /**
+     * @brief 等待线程结束
+     */
+    void join() { join_for(INFINITE); }
+
+    /**
+     * @brief 等待线程结束，超时直接终止线程
+     * @param [in] v_dwTimeout 超时时间，单位毫秒
+     */
+    void join_for(DWORD v_dwTimeout)
+    {
+        if (joinable())
+        {
+            int iRet = 0;
+            if (v_dwTimeout == INFINITE)
+            {
+                iRet = ::pthread_join(m_hThread, NULL);
+            }
+            else
+            {
+                timespec ts;
+                ::clock_gettime(CLOCK_REALTIME, &ts);
+                ts.tv_sec += v_dwTimeout / 1000;
+                ts.tv_nsec += (v_dwTimeout % 1000) * 1000000L;
+                if (ts.tv_nsec >= 1000000000L)
+                {
+                    ++ts.tv_sec;
+                    ts.tv_nsec -= 1000000000L;
+                }
+                iRet = ::pthread_timedjoin_np(m_hThread, NULL, &ts);
+            }
+
+            if (0 != iRet)
+            {
+                terminate();
+            }
+            else
+            {
+                m_bStarted = FALSE; // 已回收，detach时无需再分离
+            }
+        }
+        detach();
+    }
+
+    /**
+     * @brief 暂停线程
+     * @note linux下无法挂起其他线程，此函数不生效
+     */
+    void interrupt() {}
+
+    /**
+     * @brief 睡眠线程
+     * @note linux下只睡眠调用线程
+     * @param [in] v_dwMilliseconds 睡眠时间，单位毫秒
+     */
+    void sleep_for(DWORD v_dwMilliseconds) { this_thread::sleep_for(v_dwMilliseconds); }
+
+    /**
+     * @brief 分离线程
+     */
+    void detach()
+    {
+        if (valid())
+        {
+            if (m_bStarted)
+            {
+                ::pthread_detach(m_hThread);
+            }
+            m_bValid = FALSE;
+            m_bStarted = FALSE;
+            m_uiThreadId = 0;
+            m_bRunning = FALSE;
+        }
+    }
+
+    /**
+     * @brief 终止线程
+     */
+    void terminate()
+    {
+        if (valid())
+        {
+            if (m_bStarted)
+            {
+                ::pthread_cancel(m_hThread);
+            }
+            detach();
+        }
+    }
+
+    /**
+     * @brief 设置线程优先级
+     * @note linux下映射为线程的nice值，优先级越高nice值越小，提高优先级需要相应权限
+     * @param [in] v_iPriority 优先级
+     */
+    void set_priority(int v_iPriority)
+    {
+        if (valid())
+        {
+            m_iPriority = v_iPriority;
+            if (m_uiThreadId)
+            {
+                ::setpriority(PRIO_PROCESS, m_uiThreadId, -m_iPriority);
+            }
+        }
+    }
+
+    /**
+     * @brief 设置线程可运行的CPU
+     * @note 线程启动前设置时在启动时生效
+     * @param [in] v_cpus CPU集合
+     * @return BOOL 是否设置成功
+     */
+    BOOL set_affinity(const cpu_set &v_cpus)
+    {
+        if (!valid() || v_cpus.empty())
+        {
+            return FALSE;
+        }
+
+        if (m_bStarted)
+        {
+            cpu_set_t mask;
+            to_cpu_set_t(v_cpus, mask);
+            if (0 != ::pthread_setaffinity_np(m_hThread, sizeof(mask), &mask))
+            {
+                return FALSE;
+            }
+        }
+        m_affinity = v_cpus;
+        return TRUE;
+    }
+
+    BOOL joinable() const { return (valid() && m_bRunning); }
+    BOOL valid() const { return m_bValid; }
+    BOOL running() const { return m_bRunning; }
+    UINT32 id() const { return m_uiThreadId; }
+    int priority() const { return m_iPriority; }
+    const cpu_set &affinity() const { return m_affinity; }
+
+    static DWORD hardware_concurrency() { return processor_count(); }
+
+private:
+    static void to_cpu_set_t(const cpu_set &v_cpus, cpu_set_t &v_mask)
+    {
+        CPU_ZERO(&v_mask);
+        for (size_t nCpu = 0; nCpu < v_cpus.size() && nCpu < CPU_SETSIZE; ++nCpu)
+        {
+            if (v_cpus.test(nCpu))
+            {
+                CPU_SET(nCpu, &v_mask);
+            }
+        }
+    }
+
+    /**
+     * @brief 线程函数
+     * @param [in] v_lpParam 线程参数，指向线程对象
+     * @return
+     */
+    static void *thread_func(void *v_lpParam)
+    {
+        thread *pThread = static_cast<thread *>(v_lpParam);
+        if (pThread)
+        {
+            pThread->m_uiThreadId = this_thread::get_id();
+            if (pThread->m_iPriority != THREAD_PRIORITY_NORMAL)
+            {
+                ::setpriority(PRIO_PROCESS, pThread->m_uiThreadId, -pThread->m_iPriority);
+            }
+
+            pThread->run();
+            __atomic_store_n(&pThread->m_bRunning, FALSE, __ATOMIC_RELEASE);
+        }
+
+        return NULL;
+    }
+
+private:
+    pthread_t m_hThread;          // 线程句柄
+    BOOL m_bValid;                // 线程是否已创建
+    BOOL m_bStarted;              // pthread线程是否已创建且未被回收
+    UINT32 m_uiThreadId;          // 线程ID
+    int m_iPriority;              // 线程优先级
+    cpu_set m_affinity;           // 线程可运行的CPU，空集合表示未设置
+    volatile BOOL m_bRunning;     // 线程是否正在运行
+};
+#endif // _WIN32
+
 #endif // THREAD_WIN_HPP
\ No newline at end of file
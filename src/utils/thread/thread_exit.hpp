@@ -0,0 +1,129 @@
+﻿/**
+ * @file thread_exit.hpp
+ * @brief 线程退出回调，windows下基于FLS，linux下基于pthread_key
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef THREAD_EXIT_HPP
+#define THREAD_EXIT_HPP
+
+#include "platform.hpp"
+
+#if !defined(_WIN32)
+#include <pthread.h>
+#endif
+
+/**
+ * @brief 线程退出回调
+ * @details 线程调用at_exit()登记回调，该线程退出时按登记的逆序调用；不论线程是否由thread类创建都会触发，
+ *          用于ebr、风险指针等按线程登记资源的模块在线程退出时自动注销
+ * @note 回调在退出线程上执行，此时线程局部变量仍然有效；回调中可以再次登记，登记的回调同样会被调用
+ */
+class thread_exit
+{
+public:
+    typedef void (*callback)();
+
+    enum
+    {
+        MAX_CALLBACKS = 64 // 每个线程最多登记的回调数，每种大小的object_pool各占一个
+    };
+
+public:
+    /**
+     * @brief 为当前线程登记退出回调，同一回调在未被调用前重复登记只保留一份
+     * @param [in] v_func 回调函数
+     * @return BOOL 是否登记成功，超过MAX_CALLBACKS时返回FALSE
+     */
+    static BOOL at_exit(callback v_func)
+    {
+        local &l = get_local();
+        for (int i = 0; i < l.m_nCount; ++i)
+        {
+            if (l.m_funcs[i] == v_func)
+            {
+                return TRUE;
+            }
+        }
+        if (l.m_nCount >= MAX_CALLBACKS)
+        {
+            return FALSE;
+        }
+
+        l.m_funcs[l.m_nCount++] = v_func;
+        arm(&l); // 每次都重新设置，线程退出过程中再次登记时系统会再调用一轮
+        return TRUE;
+    }
+
+private:
+    /**
+     * @brief 线程已登记的回调，POD以便用THREAD_LOCAL修饰
+     */
+    struct local
+    {
+        callback m_funcs[MAX_CALLBACKS];
+        int m_nCount;
+    };
+
+    static local &get_local()
+    {
+        static THREAD_LOCAL local s_local = {{NULL}, 0};
+        return s_local;
+    }
+
+    /**
+     * @brief 线程退出时由系统调用，逆序执行并清空已登记的回调
+     */
+    static void run(void *v_lpParam)
+    {
+        local *pLocal = static_cast<local *>(v_lpParam);
+        while (pLocal && pLocal->m_nCount > 0)
+        {
+            callback func = pLocal->m_funcs[--pLocal->m_nCount];
+            func();
+        }
+    }
+
+#if defined(_WIN32)
+    static void WINAPI fls_callback(PVOID v_lpParam) { run(v_lpParam); }
+
+    static void arm(local *v_pLocal)
+    {
+        static volatile LONG s_nState = 0; // 0 未初始化，1 初始化中，2 已初始化
+        static DWORD s_dwIndex = FLS_OUT_OF_INDEXES;
+        if (InterlockedCompareExchange(&s_nState, 1, 0) == 0)
+        {
+            s_dwIndex = ::FlsAlloc(&thread_exit::fls_callback);
+            InterlockedExchange(&s_nState, 2);
+        }
+        while (s_nState != 2)
+        {
+            ::SwitchToThread();
+        }
+        if (s_dwIndex != FLS_OUT_OF_INDEXES)
+        {
+            ::FlsSetValue(s_dwIndex, v_pLocal);
+        }
+    }
+#else
+    static void key_destructor(void *v_lpParam) { run(v_lpParam); }
+
+    static void create_key() { pthread_key_create(&key(), &thread_exit::key_destructor); }
+
+    static pthread_key_t &key()
+    {
+        static pthread_key_t s_key;
+        return s_key;
+    }
+
+    static void arm(local *v_pLocal)
+    {
+        static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+        pthread_once(&s_once, &thread_exit::create_key);
+        pthread_setspecific(key(), v_pLocal);
+    }
+#endif
+};
+
+#endif // THREAD_EXIT_HPP
\ No newline at end of file
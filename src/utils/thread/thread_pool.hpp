@@ -9,8 +9,16 @@
 #define THREAD_POOL_HPP
 
 #include <list>
+#include <vector>
 
 #include "message_queue.hpp"
+#include "mpmc_ring_queue.hpp"
+#include "work_stealing_deque.hpp"
+#include "future.hpp"
+#include "latch.hpp"
+#include "lock_free_queue.hpp"
+#include "sharded_counter.hpp"
+#include "task.hpp"
 #include "../smart_ptr/shared_ptr.hpp"
 #include "thread.hpp"
 
@@ -33,33 +41,127 @@ struct task_func
     }
 };
 
-class thread_pool
+/**
+ * @brief 线程池
+ * @details 任务分为PRIORITY_LEVELS个优先级，默认优先级的任务放入共享任务队列，其他优先级各有一条无锁通道；
+ *          工作线程每执行一个任务前先比较各优先级的有效优先级，取最高者的任务。有效优先级为优先级加上
+ *          该优先级最近一次被执行以来经过的AGING_MS毫秒数，长时间得不到执行的低优先级任务逐渐提升，不会被饿死
+ * @note 任务以task按值保存，内联大小以内的函数对象提交时不分配内存；窃取模式的本地队列只保存指针，
+ *       任务本身从object_pool分配，窃取时不会复制正在被覆盖的task；message_queue内部的std::deque仍按块分配，
+ *       需要提交完全不分配内存时使用环形队列或在窃取模式的工作线程内提交
+ * @note 任务执行完、计数减少之前即析构函数对象，wait()返回后任务捕获的资源都已释放
+ * @tparam Q 任务队列模板，message_queue为双队列加锁实现，mpmc_ring_queue为无锁有界环形队列；
+ *         环形队列不支持头部插入，stop()的停止标志按先进先出处理
+ */
+template <template <typename> class Q = message_queue>
+class basic_thread_pool
 {
+public:
+    /**
+     * @brief 调度模式
+     */
+    enum schedule_mode
+    {
+        GLOBAL_QUEUE,  // 所有工作线程共享一个任务队列
+        WORK_STEALING  // 每个工作线程有自己的双端队列，空闲时从其他线程窃取任务
+    };
+
+    /**
+     * @brief 任务优先级，数值越大越优先
+     */
+    enum
+    {
+        PRIORITY_LEVELS = 8,  // 优先级个数，取值范围[0, PRIORITY_LEVELS)
+        DEFAULT_PRIORITY = 2, // submit()使用的优先级，低于它的用于后台任务
+        HIGH_PRIORITY = 7     // submit_high()使用的优先级
+    };
+
+    /**
+     * @brief 一个优先级的统计
+     */
+    struct priority_stats
+    {
+        size_t m_nQueued;      // 排队中的任务数
+        LONGLONG m_llExecuted; // 已执行的任务数
+        LONGLONG m_llWaitMs;   // 已执行任务的累计排队时间，单位毫秒
+        DWORD m_dwMaxWaitMs;   // 最长的排队时间，单位毫秒
+    };
+
+private:
     struct task_wrapper // 任务包装器
     {
-        task_func m_task; // 任务函数
-        BOOL m_bStop;     // 停止标志
+        task m_task;          // 任务
+        BOOL m_bStop;         // 停止标志
+        BOOL m_bToken;        // 唤醒标志，表示优先级通道中有新任务，只在共享队列模式下使用
+        int m_nPriority;      // 优先级
+        DWORD m_dwSubmitTick; // 提交时刻，用于统计排队时间
 
-        task_wrapper(BOOL v_bStop = FALSE) : m_bStop(v_bStop) {}
-        task_wrapper(const task_func &v_task) : m_task(v_task), m_bStop(FALSE) {}
+        task_wrapper(BOOL v_bStop = FALSE)
+            : m_bStop(v_bStop), m_bToken(FALSE), m_nPriority(DEFAULT_PRIORITY), m_dwSubmitTick(0)
+        {
+        }
+        task_wrapper(const task &v_task, int v_nPriority = DEFAULT_PRIORITY)
+            : m_task(v_task), m_bStop(FALSE), m_bToken(FALSE), m_nPriority(v_nPriority), m_dwSubmitTick(tick_count())
+        {
+        }
+        task_wrapper(const task_func &v_task, int v_nPriority = DEFAULT_PRIORITY)
+            : m_task(v_task), m_bStop(FALSE), m_bToken(FALSE), m_nPriority(v_nPriority), m_dwSubmitTick(tick_count())
+        {
+        }
         void operator()() const
         {
-            if (!m_bStop)
+            if (!m_bStop && !m_bToken)
             {
                 m_task();
             }
         }
+
+        static task_wrapper token()
+        {
+            task_wrapper wrapper;
+            wrapper.m_bToken = TRUE;
+            return wrapper;
+        }
+    };
+
+    /**
+     * @brief 一个优先级的任务通道和统计，默认优先级的任务在共享队列中，不使用通道
+     */
+    struct priority_lane
+    {
+        priority_lane() : m_nPending(0), m_dwLastServed(0), m_nMaxWaitMs(0) {}
+
+        lock_free_queue<task_wrapper> m_queue; // 该优先级的任务
+        atomic<LONG> m_nPending;               // 通道中的任务数
+        volatile DWORD m_dwLastServed;         // 最近一次执行该优先级任务的时刻，用于计算老化
+        sharded_counter<LONGLONG> m_executed;  // 已执行的任务数
+        sharded_counter<LONGLONG> m_waitMs;    // 已执行任务的累计排队时间
+        atomic<LONG> m_nMaxWaitMs;             // 最长的排队时间
     };
-    typedef message_queue<task_wrapper> task_queue; // 任务队列类型
-    typedef shared_ptr<thread> thread_ptr;          // 线程指针类型
-    typedef std::list<thread_ptr> threads;          // 线程集合类型
+    struct exec_task_thread;
+
+    typedef Q<task_wrapper> task_queue;                     // 任务队列类型
+    typedef work_stealing_deque<task_wrapper *> task_deque; // 工作线程本地任务队列类型，元素从object_pool分配
+    typedef shared_ptr<thread> thread_ptr;                  // 线程指针类型
+    typedef std::list<thread_ptr> threads;                  // 线程集合类型
+    typedef std::vector<exec_task_thread *> workers;        // 工作线程集合类型，用于随机选择窃取对象
 
 public:
-    thread_pool(size_t v_nThreadNum = 4, size_t v_nQueueSize = 1000) : m_taskQueue(v_nQueueSize)
+    /**
+     * @brief 构造函数
+     * @param [in] v_nThreadNum 线程数，0表示使用逻辑处理器个数
+     * @param [in] v_nQueueSize 任务队列容量，0表示无限容量
+     * @param [in] v_eMode 调度模式
+     */
+    basic_thread_pool(size_t v_nThreadNum = 4, size_t v_nQueueSize = 1000, schedule_mode v_eMode = GLOBAL_QUEUE)
+        : m_taskQueue(v_nQueueSize), m_eMode(v_eMode), m_nPopBatch(DEFAULT_POP_BATCH), m_nLaneTasks(0), m_nTokens(0),
+          m_bAbort(FALSE), m_nIdle(0), m_nWakePending(0), m_bElastic(FALSE), m_bStopping(FALSE), m_nThreads(0),
+          m_nMinThreads(0), m_nMaxThreads(0), m_dwKeepAliveMs(DEFAULT_KEEP_ALIVE_MS), m_nNextIndex(0), m_dwLastCheck(0),
+          m_nOverloadTick(0), m_bPinPerCpu(TRUE)
     {
         create(v_nThreadNum);
     }
-    virtual ~thread_pool() { stop(); }
+    virtual ~basic_thread_pool() { stop(); }
 
 public:
     void create(size_t v_nThreadNum = 4)
@@ -71,26 +173,169 @@ public:
 
         if (v_nThreadNum == 0)
         {
-            v_nThreadNum = 4;
+            v_nThreadNum = thread::hardware_concurrency();
         }
-        if (v_nThreadNum > 16)
+
+        m_bAbort = FALSE;
+        m_bStopping = FALSE;
+        m_nThreads = static_cast<LONG>(v_nThreadNum);
+        m_nNextIndex = 0;
+        m_nOverloadTick = 0;
+
+        // 先挂起创建全部线程，派生类构造完成、窃取对象集合就绪后再统一启动
+        for (size_t i = 0; i < v_nThreadNum; ++i)
         {
-            v_nThreadNum = 16;
+            exec_task_thread *pWorker = new exec_task_thread(this, m_nNextIndex++);
+            m_listThreads.push_back(thread_ptr(pWorker));
+            m_vecWorkers.push_back(pWorker);
+            pin(pWorker);
         }
+        for (threads::iterator it = m_listThreads.begin(); it != m_listThreads.end(); ++it)
+        {
+            (*it)->start();
+        }
+    }
 
-        for (size_t i = 0; i < v_nThreadNum; ++i)
+    /**
+     * @brief 提交任务
+     * @note 窃取模式下，工作线程内提交的任务放入该线程的本地队列，其他线程提交的任务放入共享队列
+     * @param [in] v_task 任务，可以是task_func、函数指针、函数对象或lambda，见task
+     */
+    void submit(const task &v_task)
+    {
+        m_wgTasks.add(); // 先计数再入队，任务执行完之前计数不会减到0
+        if (m_eMode == WORK_STEALING)
+        {
+            exec_task_thread *pWorker = current_worker();
+            if (pWorker && pWorker->m_pool == this)
+            {
+                pWorker->m_deque.push(object_pool<task_wrapper>::create(v_task));
+                notify_idle();
+                return;
+            }
+        }
+
+        m_taskQueue.push_back(task_wrapper(v_task));
+        if (m_eMode == WORK_STEALING)
+        {
+            memory_barrier(); // 与工作线程登记空闲后的检查配对，保证不会丢失唤醒
+            notify_idle();
+        }
+        if (m_bElastic)
+        {
+            check_grow();
+        }
+    }
+
+    /**
+     * @brief 批量提交任务，共享队列一次加锁放入尽可能多的任务
+     * @param [in] v_pFirst 第一个任务，task_func或task数组
+     * @param [in] v_nCount 任务个数
+     */
+    template <typename T>
+    void submit_bulk(const T *v_pFirst, size_t v_nCount)
+    {
+        if (v_nCount == 0)
+        {
+            return;
+        }
+
+        m_wgTasks.add(static_cast<LONG>(v_nCount));
+        if (m_eMode == WORK_STEALING)
+        {
+            exec_task_thread *pWorker = current_worker();
+            if (pWorker && pWorker->m_pool == this)
+            {
+                for (size_t i = 0; i < v_nCount; ++i)
+                {
+                    pWorker->m_deque.push(object_pool<task_wrapper>::create(v_pFirst[i]));
+                }
+                notify_idle(v_nCount > 1);
+                return;
+            }
+        }
+
+        m_taskQueue.push_back_bulk(v_pFirst, v_nCount);
+        if (m_eMode == WORK_STEALING)
+        {
+            memory_barrier();
+            notify_idle(v_nCount > 1);
+        }
+        if (m_bElastic)
+        {
+            check_grow();
+        }
+    }
+
+    /**
+     * @brief 按优先级提交任务
+     * @note 默认优先级等同于submit()；其他优先级放入该优先级的无锁通道，共享队列模式下另向共享队列尾部
+     *       放入一个唤醒标志，只占用生产者一侧的锁，不影响工作线程取任务
+     * @param [in] v_task 任务
+     * @param [in] v_nPriority 优先级，取值范围[0, PRIORITY_LEVELS)，超出时取最近的边界
+     */
+    void submit(const task &v_task, int v_nPriority)
+    {
+        v_nPriority = clamp_priority(v_nPriority);
+        if (v_nPriority == DEFAULT_PRIORITY)
+        {
+            submit(v_task);
+            return;
+        }
+
+        m_wgTasks.add();
+        priority_lane &lane = m_lanes[v_nPriority];
+        task_wrapper wrapper(v_task, v_nPriority);
+        lane.m_queue.push(wrapper);
+        if (lane.m_nPending.fetch_add(1) == 0)
         {
-            m_listThreads.push_back(thread_ptr(new exec_task_thread(this)));
+            lane.m_dwLastServed = wrapper.m_dwSubmitTick; // 通道由空变为非空，从现在开始计算老化
+        }
+        ++m_nLaneTasks; // 原子操作带完整屏障，与工作线程登记空闲后的检查配对
+
+        if (m_eMode == WORK_STEALING)
+        {
+            notify_idle();
+        }
+        else
+        {
+            ++m_nTokens;
+            m_taskQueue.push_back(task_wrapper::token());
+        }
+        if (m_bElastic)
+        {
+            check_grow();
         }
     }
 
-    void submit(const task_func &v_func) { m_taskQueue.push_back(task_wrapper(v_func)); }
+    /**
+     * @brief 提交高优先级任务
+     */
+    void submit_high(const task &v_task) { submit(v_task, HIGH_PRIORITY); }
 
-    void submit_high(const task_func &v_func) { m_taskQueue.push_front(task_wrapper(v_func)); }
+    /**
+     * @brief 提交带返回值的任务，结果通过future获取
+     * @note 参数按值保存，func的参数不应为引用；func抛出异常时future标记为失败
+     * @note 线程池stop()时尚未执行的任务被丢弃，对应的future不会就绪，任务持有的共享状态引用随任务释放
+     * @param [in] v_func 任务函数
+     * @param [in] v_arg 任务参数
+     * @return future<R> 任务结果
+     */
+    template <typename R, typename A>
+    future<R> async(R (*v_func)(A), A v_arg)
+    {
+        async_state<R, A> *pState = object_pool<async_state<R, A> >::create(v_func, v_arg);
+        future<R> f(pState); // 共享状态初始引用由任务持有，future另持有一个
+        pState->add_ref();
+        submit(async_task<R, A>(pState));
+        return f;
+    }
 
     void stop()
     {
-        for (size_t i = 0; i < m_listThreads.size(); ++i)
+        m_bAbort = TRUE;
+        size_t nThreads = begin_stop();
+        for (size_t i = 0; i < nThreads; ++i)
         {
             m_taskQueue.push_front(task_wrapper(TRUE));
         }
@@ -98,41 +343,722 @@ public:
         join();
     }
 
-    void wait()
+    /**
+     * @brief 等待所有已提交的任务执行完，包括执行期间新提交的任务
+     * @note 工作线程不退出，之后可以继续提交任务
+     */
+    void wait() { m_wgTasks.wait(); }
+
+    /**
+     * @brief 等待所有已提交的任务执行完，直到超时
+     * @param [in] v_dwMilliseconds 超时时间，单位毫秒
+     * @return BOOL TRUE 任务已全部执行完，FALSE 超时
+     */
+    BOOL wait_for(DWORD v_dwMilliseconds) { return m_wgTasks.wait_for(v_dwMilliseconds); }
+
+    /**
+     * @brief 已提交但尚未执行完的任务数
+     */
+    size_t pending() const { return static_cast<size_t>(m_wgTasks.pending()); }
+
+    /**
+     * @brief 指定优先级的排队任务数和排队时间统计
+     * @note 默认优先级的排队任务数为共享队列长度，窃取模式下不含工作线程本地队列中的任务
+     * @param [in] v_nPriority 优先级，取值范围[0, PRIORITY_LEVELS)，超出时取最近的边界
+     */
+    priority_stats stats(int v_nPriority)
     {
-        for (size_t i = 0; i < m_listThreads.size(); ++i)
+        v_nPriority = clamp_priority(v_nPriority);
+        priority_lane &lane = m_lanes[v_nPriority];
+        priority_stats result;
+        if (v_nPriority == DEFAULT_PRIORITY)
+        {
+            LONG nQueued = static_cast<LONG>(m_taskQueue.size()) - m_nTokens.load();
+            result.m_nQueued = nQueued > 0 ? static_cast<size_t>(nQueued) : 0;
+        }
+        else
         {
-            m_taskQueue.push_back(task_wrapper(TRUE));
+            LONG nPending = lane.m_nPending.load();
+            result.m_nQueued = nPending > 0 ? static_cast<size_t>(nPending) : 0;
         }
+        result.m_llExecuted = lane.m_executed.load();
+        result.m_llWaitMs = lane.m_waitMs.load();
+        result.m_dwMaxWaitMs = static_cast<DWORD>(lane.m_nMaxWaitMs.load());
+        return result;
+    }
 
-        join();
+    schedule_mode mode() const { return m_eMode; }
+
+    /**
+     * @brief 开启弹性线程数，仅共享队列模式支持
+     * @details 任务队列积压（超过线程数*每次取出的任务数）持续GROW_DELAY_MS毫秒时增加一个线程，直到v_nMaxThreads；
+     *          线程连续v_dwKeepAliveMs毫秒取不到任务时退出，直到只剩v_nMinThreads个
+     * @note 当前线程数超过v_nMaxThreads时不会立即减少，多余的线程空闲后退出
+     * @param [in] v_nMinThreads 最少线程数，0按1处理，当前线程数不足时立即补足
+     * @param [in] v_nMaxThreads 最多线程数，0表示使用逻辑处理器个数
+     * @param [in] v_dwKeepAliveMs 空闲线程的保活时间，单位毫秒
+     * @return BOOL 是否开启，窃取模式下工作线程集合需保持不变，返回FALSE
+     */
+    BOOL set_elastic(size_t v_nMinThreads, size_t v_nMaxThreads = 0, DWORD v_dwKeepAliveMs = DEFAULT_KEEP_ALIVE_MS)
+    {
+        if (m_eMode == WORK_STEALING)
+        {
+            return FALSE;
+        }
+
+        if (v_nMinThreads == 0)
+        {
+            v_nMinThreads = 1;
+        }
+        if (v_nMaxThreads == 0)
+        {
+            v_nMaxThreads = thread::hardware_concurrency();
+        }
+        if (v_nMaxThreads < v_nMinThreads)
+        {
+            v_nMaxThreads = v_nMinThreads;
+        }
+
+        {
+            unique_lock<mutex> lock(m_mutexThreads);
+            m_nMinThreads = v_nMinThreads;
+            m_nMaxThreads = v_nMaxThreads;
+            m_dwKeepAliveMs = v_dwKeepAliveMs;
+            m_bElastic = TRUE;
+        }
+        memory_barrier();
+        wake_forever_waiters();
+
+        while (static_cast<size_t>(m_nThreads) < v_nMinThreads && grow())
+        {
+        }
+        return TRUE;
+    }
+
+    /**
+     * @brief 当前工作线程数，弹性模式下随负载变化
+     */
+    size_t thread_count() const { return static_cast<size_t>(m_nThreads); }
+
+    /**
+     * @brief 工作线程绑核，之后新增的工作线程同样绑定
+     * @param [in] v_cpus 可运行的CPU集合，空集合表示不再绑定新增的工作线程
+     * @param [in] v_bPerCpu TRUE 第i个工作线程绑定集合中的第i个CPU，线程数超过CPU数时循环；
+     *                       FALSE 工作线程可运行在集合内任意CPU
+     * @return BOOL 是否全部设置成功
+     */
+    BOOL pin_workers(const cpu_set &v_cpus, BOOL v_bPerCpu = TRUE)
+    {
+        unique_lock<mutex> lock(m_mutexThreads);
+        m_cpusPinned = v_cpus;
+        m_bPinPerCpu = v_bPerCpu;
+
+        BOOL bRet = TRUE;
+        for (typename workers::iterator it = m_vecWorkers.begin(); it != m_vecWorkers.end(); ++it)
+        {
+            if (!(*it)->m_bRetired && !pin(*it))
+            {
+                bRet = FALSE;
+            }
+        }
+        return bRet;
     }
 
+    /**
+     * @brief 每个工作线程绑定一个CPU，使用当前进程允许运行的全部CPU
+     */
+    BOOL pin_workers() { return pin_workers(numa_topology().all_cpus()); }
+
+    /**
+     * @brief 设置共享队列模式下工作线程每次最多取出的任务数
+     * @note 工作线程最多只取走队列中已有任务的1/线程数，任务很少时不会被一个线程全部取走
+     * @param [in] v_nBatch 任务数，取值范围[1, MAX_POP_BATCH]
+     */
+    void set_pop_batch(size_t v_nBatch)
+    {
+        if (v_nBatch == 0)
+        {
+            v_nBatch = 1;
+        }
+        if (v_nBatch > MAX_POP_BATCH)
+        {
+            v_nBatch = MAX_POP_BATCH;
+        }
+        m_nPopBatch = v_nBatch;
+    }
+    size_t pop_batch() const { return m_nPopBatch; }
+
 private:
     struct exec_task_thread : public thread
     {
-        exec_task_thread(thread_pool *v_pool) : m_pool(v_pool) {}
+        exec_task_thread(basic_thread_pool *v_pool, size_t v_nIndex)
+            : thread(TRUE), m_pool(v_pool), m_nIndex(v_nIndex),
+              m_uiSeed(static_cast<UINT32>(v_nIndex * 2654435761U + 1)), m_bRetired(FALSE), m_bWaitForever(FALSE)
+        {
+        }
+        void run()
+        {
+            if (m_pool) { m_pool->run(this); }
+        }
+
+        /**
+         * @brief xorshift伪随机数，用于选择窃取对象
+         */
+        UINT32 next_random()
+        {
+            m_uiSeed ^= m_uiSeed << 13;
+            m_uiSeed ^= m_uiSeed >> 17;
+            m_uiSeed ^= m_uiSeed << 5;
+            return m_uiSeed;
+        }
+
+        basic_thread_pool *m_pool;    // 所属线程池
+        size_t m_nIndex;              // 在线程池中的序号
+        UINT32 m_uiSeed;              // 随机数种子
+        task_deque m_deque;           // 本地任务队列
+        volatile BOOL m_bRetired;     // 是否因空闲超时退出，退出的线程在下次增加线程时回收
+        volatile BOOL m_bWaitForever; // 是否在共享队列上无限等待，开启弹性模式时需唤醒
+    };
+
+    /**
+     * @brief async()任务的共享状态，同时保存任务函数和参数
+     */
+    template <typename R, typename A>
+    struct async_state : public future_state<R>
+    {
+        async_state(R (*v_func)(A), A v_arg) : m_func(v_func), m_arg(v_arg) {}
+
         void run()
         {
-            if (m_pool) { m_pool->run(); }
+            try
+            {
+                async_invoker<R, A>::invoke(this, m_func, m_arg);
+            }
+            catch (...)
+            {
+                this->set_failed();
+            }
         }
 
+        virtual void destroy() { object_pool<async_state>::destroy(this); }
+
+        R (*m_func)(A); // 任务函数
+        A m_arg;        // 任务参数
+    };
+
+    /**
+     * @brief async()提交的函数对象，持有共享状态的一个引用，任务执行完或被丢弃而析构时释放
+     */
+    template <typename R, typename A>
+    struct async_task
+    {
+        explicit async_task(async_state<R, A> *v_pState) : m_pState(v_pState) {} // 接管已有的引用
+        async_task(const async_task &v_other) : m_pState(v_other.m_pState) { m_pState->add_ref(); }
+        ~async_task() { m_pState->release(); }
+
+        void operator()() const { m_pState->run(); }
+
+        async_state<R, A> *m_pState; // 共享状态
+
     private:
-        thread_pool *m_pool;
+        async_task &operator=(const async_task &);
+    };
+
+    /**
+     * @brief 执行任务函数并设置结果，void返回值单独特化
+     */
+    template <typename R, typename A>
+    struct async_invoker
+    {
+        static void invoke(future_state<R> *v_pState, R (*v_func)(A), A v_arg) { v_pState->set_value(v_func(v_arg)); }
+    };
+    template <typename A>
+    struct async_invoker<void, A>
+    {
+        static void invoke(future_state<void> *v_pState, void (*v_func)(A), A v_arg)
+        {
+            v_func(v_arg);
+            v_pState->set_value();
+        }
     };
 
-    void run()
+    /**
+     * @brief 当前线程对应的工作线程，非工作线程为NULL
+     */
+    static exec_task_thread *&current_worker()
+    {
+        static THREAD_LOCAL exec_task_thread *s_pWorker = NULL;
+        return s_pWorker;
+    }
+
+    void run(exec_task_thread *v_pWorker)
+    {
+        if (m_eMode == WORK_STEALING)
+        {
+            current_worker() = v_pWorker;
+            run_work_stealing(v_pWorker);
+            current_worker() = NULL;
+            return;
+        }
+
+        // 一次从共享队列取出一批任务，减少加锁次数
+        task_wrapper tasks[MAX_POP_BATCH];
+        while (TRUE)
+        {
+            // 先登记再读取弹性标志，与set_elastic()配对：要么这里看到弹性模式，要么set_elastic()看到无限等待
+            v_pWorker->m_bWaitForever = TRUE;
+            memory_barrier();
+            BOOL bElastic = m_bElastic;
+            v_pWorker->m_bWaitForever = !bElastic;
+            size_t nCount = m_taskQueue.pop_bulk(tasks, m_nPopBatch, static_cast<size_t>(m_nThreads),
+                                                 bElastic ? m_dwKeepAliveMs : INFINITE);
+            v_pWorker->m_bWaitForever = FALSE;
+            if (nCount == 0)
+            {
+                if (retire(v_pWorker))
+                {
+                    return;
+                }
+                continue;
+            }
+
+            for (size_t i = 0; i < nCount; ++i)
+            {
+                if (tasks[i].m_bStop)
+                {
+                    // 停止标志之后的任务（可能包括其他线程的停止标志）按原顺序放回队列头部
+                    for (size_t j = nCount - 1; j > i; --j)
+                    {
+                        m_taskQueue.push_front(tasks[j]);
+                    }
+                    return;
+                }
+
+                task_wrapper task;
+                if (tasks[i].m_bToken)
+                {
+                    // 每个唤醒标志对应通道中的一个任务，可能已被其他线程在任务间隙取走
+                    --m_nTokens;
+                    if (take_lane_task(task, TRUE))
+                    {
+                        execute(task);
+                    }
+                }
+                else
+                {
+                    // 先执行有效优先级更高的通道任务，手中任务的优先级随等待老化，不会一直被推迟
+                    while (take_lane_task(task, FALSE))
+                    {
+                        execute(task);
+                    }
+                    execute(tasks[i]);
+                }
+
+                // 所有线程都在执行耗时任务时没有新的提交，由工作线程在任务间隙检查积压
+                if (m_bElastic)
+                {
+                    check_grow();
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief 窃取模式下的工作线程循环
+     * @details 依次从本地队列底部、共享队列、随机选择的其他线程队列顶部取任务，都取不到时进入空闲等待
+     */
+    void run_work_stealing(exec_task_thread *v_pWorker)
     {
         task_wrapper task;
-        while (!task.m_bStop)
+        task_wrapper *pTask = NULL;
+        while (!m_bAbort)
         {
-            m_taskQueue.pop(task);
-            task();
+            pTask = find_task(v_pWorker, task);
+            if (!pTask)
+            {
+                wait_idle();
+                continue;
+            }
+
+            if (pTask->m_bStop)
+            {
+                break;
+            }
+            execute(*pTask);
+            if (pTask != &task)
+            {
+                object_pool<task_wrapper>::destroy(pTask);
+            }
+        }
+
+        // 收到停止标志后执行完本地队列中剩余的任务，这些任务只有本线程能再添加
+        while (!m_bAbort && v_pWorker->m_deque.pop(pTask))
+        {
+            execute(*pTask);
+            object_pool<task_wrapper>::destroy(pTask);
+        }
+    }
+
+    /**
+     * @brief 窃取模式下取一个任务
+     * @param [out] v_task 存放从优先级通道或共享队列取出的任务
+     * @return task_wrapper* 取到的任务，指向v_task或从本地队列、其他线程队列取出的对象池对象，取不到时为NULL
+     */
+    task_wrapper *find_task(exec_task_thread *v_pWorker, task_wrapper &v_task)
+    {
+        task_wrapper *pTask = NULL;
+        if (take_lane_task(v_task, FALSE))
+        {
+            return &v_task;
+        }
+        if (v_pWorker->m_deque.pop(pTask))
+        {
+            return pTask;
+        }
+        if (m_taskQueue.try_pop(v_task))
+        {
+            return &v_task;
+        }
+
+        // 从随机位置开始轮询其他线程
+        size_t nWorkers = m_vecWorkers.size();
+        size_t nStart = v_pWorker->next_random() % nWorkers;
+        for (size_t i = 0; i < nWorkers; ++i)
+        {
+            exec_task_thread *pVictim = m_vecWorkers[(nStart + i) % nWorkers];
+            if (pVictim != v_pWorker && pVictim->m_deque.steal(pTask))
+            {
+                return pTask;
+            }
+        }
+
+        return take_lane_task(v_task, TRUE) ? &v_task : NULL;
+    }
+
+    /**
+     * @brief 执行任务并统计排队时间，执行后清空任务
+     */
+    void execute(task_wrapper &v_task)
+    {
+        priority_lane &lane = m_lanes[v_task.m_nPriority];
+        DWORD dwNow = tick_count();
+        LONG nWaitMs = static_cast<LONG>(dwNow - v_task.m_dwSubmitTick);
+        if (nWaitMs < 0)
+        {
+            nWaitMs = 0;
+        }
+
+        lane.m_executed.add(1);
+        lane.m_waitMs.add(nWaitMs);
+        for (LONG nMax = lane.m_nMaxWaitMs.load(memory_order_relaxed);
+             nWaitMs > nMax && !lane.m_nMaxWaitMs.compare_exchange_weak(nMax, nWaitMs);)
+        {
+        }
+        if (lane.m_dwLastServed != dwNow)
+        {
+            lane.m_dwLastServed = dwNow; // 每毫秒最多写一次，避免各工作线程频繁写同一缓存行
+        }
+
+        v_task();
+        v_task.m_task.reset(); // 函数对象及其持有的资源在计数之前析构，wait()返回时不会残留在工作线程上
+        m_wgTasks.done();
+    }
+
+    /**
+     * @brief 将优先级限制在[0, PRIORITY_LEVELS)内
+     */
+    static int clamp_priority(int v_nPriority)
+    {
+        if (v_nPriority < 0)
+        {
+            return 0;
+        }
+        return v_nPriority < PRIORITY_LEVELS ? v_nPriority : PRIORITY_LEVELS - 1;
+    }
+
+    /**
+     * @brief 优先级老化后的有效优先级
+     */
+    LONG effective_priority(int v_nPriority, DWORD v_dwNow) const
+    {
+        LONG nWaited = static_cast<LONG>(v_dwNow - m_lanes[v_nPriority].m_dwLastServed);
+        return v_nPriority + (nWaited > 0 ? nWaited / AGING_MS : 0);
+    }
+
+    /**
+     * @brief 从有效优先级最高的非空通道取一个任务
+     * @param [out] v_task 取出的任务
+     * @param [in] v_bAny TRUE 任意非空通道均可，FALSE 只取有效优先级高于默认优先级的通道
+     * @return BOOL 是否取到
+     */
+    BOOL take_lane_task(task_wrapper &v_task, BOOL v_bAny)
+    {
+        if (m_nLaneTasks.load(memory_order_relaxed) <= 0)
+        {
+            return FALSE;
+        }
+
+        DWORD dwNow = tick_count();
+        LONG nBeat = v_bAny ? -1 : effective_priority(DEFAULT_PRIORITY, dwNow);
+
+        // 选中的通道可能被其他线程抢先取空，此时重新选择
+        for (int nTry = 0; nTry < PRIORITY_LEVELS; ++nTry)
+        {
+            int nBest = -1;
+            LONG nBestPriority = nBeat;
+            for (int i = 0; i < PRIORITY_LEVELS; ++i)
+            {
+                if (i != DEFAULT_PRIORITY && m_lanes[i].m_nPending.load(memory_order_relaxed) > 0)
+                {
+                    LONG nPriority = effective_priority(i, dwNow);
+                    if (nPriority > nBestPriority)
+                    {
+                        nBest = i;
+                        nBestPriority = nPriority;
+                    }
+                }
+            }
+            if (nBest < 0)
+            {
+                return FALSE;
+            }
+
+            if (m_lanes[nBest].m_queue.pop(v_task))
+            {
+                --m_lanes[nBest].m_nPending;
+                --m_nLaneTasks;
+                return TRUE;
+            }
+        }
+        return FALSE;
+    }
+
+    /**
+     * @brief 是否有待执行的任务，仅用于空闲等待前的检查
+     */
+    BOOL has_task()
+    {
+        for (typename workers::iterator it = m_vecWorkers.begin(); it != m_vecWorkers.end(); ++it)
+        {
+            if (!(*it)->m_deque.empty())
+            {
+                return TRUE;
+            }
         }
+        return m_nLaneTasks.load() > 0 || !m_taskQueue.empty();
+    }
+
+    /**
+     * @brief 空闲等待，直到有新任务提交
+     * @note 先登记空闲再检查队列，提交方先入队再检查空闲数，两边都有完整屏障，因此不会丢失唤醒
+     */
+    void wait_idle()
+    {
+        unique_lock<mutex> lock(m_mutexIdle);
+        ++m_nIdle;
+        if (!has_task())
+        {
+            m_cvIdle.wait_for(lock, IDLE_WAIT_MS);
+        }
+        --m_nIdle;
+        m_nWakePending = 0;
+    }
+
+    /**
+     * @brief 唤醒空闲线程
+     * @note 同一时间只允许一次唤醒在途，被唤醒的线程离开空闲等待后才允许下一次唤醒，
+     *       避免连续提交时每个任务都去争用空闲锁
+     * @param [in] v_bAll 是否唤醒所有空闲线程，批量提交时使用
+     */
+    void notify_idle(BOOL v_bAll = FALSE)
+    {
+        LONG nExpected = 0;
+        if (m_nIdle > (LONG)0 && m_nWakePending == (LONG)0 && m_nWakePending.compare_exchange_strong(nExpected, 1))
+        {
+            unique_lock<mutex> lock(m_mutexIdle);
+            if (v_bAll)
+            {
+                m_cvIdle.notify_all();
+            }
+            else
+            {
+                m_cvIdle.notify_one();
+            }
+        }
+    }
+
+    /**
+     * @brief 检查任务积压，积压持续GROW_DELAY_MS毫秒时增加线程
+     * @details 积压的任务按每个线程一批计算所需线程数，每次最多翻倍，避免短时间内创建过多线程
+     * @note 每毫秒最多读取一次队列长度，提交任务和工作线程每执行完一个任务时调用
+     */
+    void check_grow()
+    {
+        DWORD dwNow = tick_count();
+        if (dwNow == m_dwLastCheck)
+        {
+            return;
+        }
+        m_dwLastCheck = dwNow;
+
+        size_t nThreads = static_cast<size_t>(m_nThreads);
+        size_t nQueued = m_taskQueue.size();
+        if (nThreads >= m_nMaxThreads || nQueued <= nThreads * m_nPopBatch)
+        {
+            m_nOverloadTick = 0;
+            return;
+        }
+
+        // 0表示未积压，记录积压开始时刻；积压持续足够久时由抢到清零的线程负责增加线程
+        LONG nSince = m_nOverloadTick;
+        if (nSince == 0)
+        {
+            m_nOverloadTick = static_cast<LONG>(dwNow | 1);
+        }
+        else if (dwNow - static_cast<DWORD>(nSince) >= GROW_DELAY_MS &&
+                 m_nOverloadTick.compare_exchange_strong(nSince, 0))
+        {
+            size_t nGrow = (nQueued + m_nPopBatch - 1) / m_nPopBatch - nThreads; // 积压超过阈值，至少为1
+            for (size_t i = 0; i < nGrow && i < nThreads && grow(); ++i)
+            {
+            }
+        }
+    }
+
+    /**
+     * @brief 唤醒开启弹性模式前已在共享队列上无限等待的工作线程，使其按保活时间重新等待
+     * @details 向共享队列放入唤醒标志，直到没有线程还在无限等待；一个线程可能连续取走多个标志，因此逐轮检查
+     */
+    void wake_forever_waiters()
+    {
+        while (TRUE)
+        {
+            size_t nWaiting = 0;
+            {
+                unique_lock<mutex> lock(m_mutexThreads);
+                for (typename workers::iterator it = m_vecWorkers.begin(); it != m_vecWorkers.end(); ++it)
+                {
+                    nWaiting += (*it)->m_bWaitForever ? 1 : 0;
+                }
+            }
+            if (nWaiting == 0)
+            {
+                return;
+            }
+
+            for (size_t i = 0; i < nWaiting; ++i)
+            {
+                ++m_nTokens;
+                if (!m_taskQueue.try_push_back(task_wrapper::token()))
+                {
+                    --m_nTokens;
+                    return; // 队列已满，等待中的线程马上就能取到任务
+                }
+            }
+            this_thread::sleep_for(1);
+        }
+    }
+
+    /**
+     * @brief 增加一个工作线程，并回收已退出的线程
+     * @return BOOL 是否增加，已达到最多线程数或正在停止时返回FALSE
+     */
+    BOOL grow()
+    {
+        unique_lock<mutex> lock(m_mutexThreads);
+        if (m_bStopping || static_cast<size_t>(m_nThreads) >= m_nMaxThreads)
+        {
+            return FALSE;
+        }
+
+        reap();
+
+        exec_task_thread *pWorker = new exec_task_thread(this, m_nNextIndex++);
+        m_listThreads.push_back(thread_ptr(pWorker));
+        m_vecWorkers.push_back(pWorker);
+        ++m_nThreads;
+        pin(pWorker);
+        pWorker->start();
+        return TRUE;
+    }
+
+    /**
+     * @brief 空闲超时的工作线程尝试退出
+     * @return BOOL 是否退出，线程数已达到最少线程数或正在停止时返回FALSE
+     */
+    BOOL retire(exec_task_thread *v_pWorker)
+    {
+        unique_lock<mutex> lock(m_mutexThreads);
+        if (m_bStopping || static_cast<size_t>(m_nThreads) <= m_nMinThreads)
+        {
+            return FALSE;
+        }
+
+        --m_nThreads;
+        v_pWorker->m_bRetired = TRUE;
+        return TRUE;
+    }
+
+    /**
+     * @brief 回收已退出的工作线程，需在持有m_mutexThreads时调用
+     */
+    void reap()
+    {
+        for (typename workers::iterator it = m_vecWorkers.begin(); it != m_vecWorkers.end();)
+        {
+            it = (*it)->m_bRetired ? m_vecWorkers.erase(it) : it + 1;
+        }
+        for (threads::iterator it = m_listThreads.begin(); it != m_listThreads.end();)
+        {
+            if (static_cast<exec_task_thread *>(it->get())->m_bRetired)
+            {
+                (*it)->join();
+                it = m_listThreads.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    /**
+     * @brief 按pin_workers()的设置绑定一个工作线程，未设置时不处理
+     */
+    BOOL pin(exec_task_thread *v_pWorker)
+    {
+        if (m_cpusPinned.empty())
+        {
+            return TRUE;
+        }
+        if (!m_bPinPerCpu)
+        {
+            return v_pWorker->set_affinity(m_cpusPinned);
+        }
+
+        cpu_set cpus;
+        cpus.set(m_cpusPinned.nth(v_pWorker->m_nIndex));
+        return v_pWorker->set_affinity(cpus);
+    }
+
+    /**
+     * @brief 禁止增减线程，返回需要发送的停止标志数
+     */
+    size_t begin_stop()
+    {
+        unique_lock<mutex> lock(m_mutexThreads);
+        m_bStopping = TRUE;
+        return static_cast<size_t>(m_nThreads);
     }
 
     void join()
     {
+        if (m_eMode == WORK_STEALING)
+        {
+            unique_lock<mutex> lock(m_mutexIdle);
+            m_cvIdle.notify_all();
+        }
+
         for (threads::iterator it = m_listThreads.begin(); it != m_listThreads.end(); ++it)
         {
             if (*it)
@@ -141,13 +1067,76 @@ private:
             }
         }
 
+        // 工作线程都已退出，本地队列中未执行的任务由这里释放
+        task_wrapper *pTask = NULL;
+        for (typename workers::iterator it = m_vecWorkers.begin(); it != m_vecWorkers.end(); ++it)
+        {
+            while ((*it)->m_deque.pop(pTask))
+            {
+                object_pool<task_wrapper>::destroy(pTask);
+            }
+        }
+        m_vecWorkers.clear();
         m_listThreads.clear();
         m_taskQueue.clear();
+        m_nThreads = 0;
+
+        task_wrapper task;
+        for (int i = 0; i < PRIORITY_LEVELS; ++i)
+        {
+            while (m_lanes[i].m_queue.pop(task))
+            {
+            }
+            m_lanes[i].m_nPending = 0;
+        }
+        m_nLaneTasks = 0;
+        m_nTokens = 0;
+        m_wgTasks.reset(); // 丢弃的任务不会再执行，唤醒仍在wait()的线程
     }
 
 private:
+    enum
+    {
+        IDLE_WAIT_MS = 100,            // 空闲等待的超时时间，单位毫秒，仅作为兜底
+        DEFAULT_POP_BATCH = 16,        // 工作线程每次从共享队列取出的默认任务数
+        MAX_POP_BATCH = 256,           // 工作线程每次从共享队列取出的最大任务数
+        GROW_DELAY_MS = 10,            // 弹性模式下任务积压持续多久后增加线程，单位毫秒
+        DEFAULT_KEEP_ALIVE_MS = 60000, // 弹性模式下空闲线程的默认保活时间，单位毫秒
+        AGING_MS = 10                  // 优先级老化的时间单位，等待这么久有效优先级加1，单位毫秒
+    };
+
     threads m_listThreads;
+    workers m_vecWorkers;
     task_queue m_taskQueue;
+    schedule_mode m_eMode;
+    size_t m_nPopBatch;   // 工作线程每次从共享队列取出的任务数
+    wait_group m_wgTasks; // 已提交但尚未执行完的任务
+
+    priority_lane m_lanes[PRIORITY_LEVELS]; // 各优先级的任务通道和统计
+    atomic<LONG> m_nLaneTasks;              // 所有通道中的任务数，为0时工作线程不检查通道
+    atomic<LONG> m_nTokens;                 // 共享队列中的唤醒标志数
+
+    volatile BOOL m_bAbort;      // 是否立即停止，不再执行本地队列中剩余的任务
+    atomic<LONG> m_nIdle;        // 空闲等待中的线程数
+    atomic<LONG> m_nWakePending; // 是否有在途的唤醒
+    mutex m_mutexIdle;
+    condition_variable m_cvIdle;
+
+    volatile BOOL m_bElastic;     // 是否开启弹性线程数
+    BOOL m_bStopping;             // 是否正在停止，停止期间不增减线程，受m_mutexThreads保护
+    atomic<LONG> m_nThreads;      // 未退出的工作线程数
+    size_t m_nMinThreads;         // 弹性模式下的最少线程数
+    size_t m_nMaxThreads;         // 弹性模式下的最多线程数
+    DWORD m_dwKeepAliveMs;        // 弹性模式下空闲线程的保活时间，单位毫秒
+    size_t m_nNextIndex;          // 下一个工作线程的序号
+    volatile DWORD m_dwLastCheck; // 上次检查积压的时刻
+    atomic<LONG> m_nOverloadTick; // 积压开始的时刻，0表示未积压
+    mutex m_mutexThreads;         // 保护工作线程集合的增减
+
+    cpu_set m_cpusPinned; // 工作线程绑定的CPU，受m_mutexThreads保护
+    BOOL m_bPinPerCpu;    // 是否每个工作线程绑定一个CPU
 };
 
+typedef basic_thread_pool<> thread_pool;
+
 #endif // THREAD_POOL_HPP
\ No newline at end of file
@@ -0,0 +1,549 @@
+﻿/**
+ * @file timer_wheel.hpp
+ * @brief 分层时间轮与定时器服务，到期的任务提交到线程池执行
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <vector>
+
+#include "condition_variable.hpp"
+#include "thread_pool.hpp"
+
+/**
+ * @brief 时间轮槽位链表的链接，槽位头和定时器节点共用
+ */
+struct timer_link
+{
+    timer_link *m_pPrev;
+    timer_link *m_pNext;
+};
+
+/**
+ * @brief 定时器节点，由timer_wheel分配和回收
+ */
+struct timer_node : public timer_link
+{
+    DWORD m_dwExpire; // 到期的刻度
+    DWORD m_dwPeriod; // 周期，单位刻度，0表示只执行一次
+    DWORD m_dwSeq;    // 节点每次回收时加1，用于识别失效的句柄
+    task_func m_task; // 到期执行的任务
+};
+
+/**
+ * @brief 定时器句柄
+ * @note 定时器执行完（只执行一次的）或被取消后句柄失效，节点被新定时器复用时，用失效的句柄取消不会影响新定时器
+ */
+struct timer_handle
+{
+    timer_handle(timer_node *v_pNode = NULL, DWORD v_dwSeq = 0) : m_pNode(v_pNode), m_dwSeq(v_dwSeq) {}
+    BOOL valid() const { return m_pNode != NULL; }
+
+    timer_node *m_pNode; // 定时器节点
+    DWORD m_dwSeq;       // 创建时节点的序号
+};
+
+/**
+ * @brief 分层时间轮
+ * @details 共LEVELS层，每层SLOTS个槽位，每个槽位是一个双向循环链表。第0层每个槽位对应一个刻度，
+ *          第n层每个槽位对应SLOTS^n个刻度。添加时按距到期的刻度数放入对应层的槽位，取消时直接从链表摘除，
+ *          都是O(1)；第0层每走完一圈，把上一层当前槽位的定时器重新分配到下层（级联），
+ *          每个定时器到期前最多被级联LEVELS-1次
+ * @note 非线程安全，多线程使用时由调用者加锁，见timer_service
+ * @note 节点每次向系统申请CHUNK_SIZE个，回收后放入空闲链表复用，直到时间轮析构才释放，
+ *       占用的内存只取决于同时存在的定时器数的峰值
+ */
+class timer_wheel
+{
+public:
+    enum
+    {
+        LEVELS = 4,             // 层数
+        SLOT_BITS = 8,          // 每层槽位数的位数，4层共覆盖32位刻度
+        SLOTS = 1 << SLOT_BITS, // 每层槽位数
+        SLOT_MASK = SLOTS - 1,  // 槽位下标掩码
+        MAX_TICKS = 0x7FFFFFFF, // 最长的定时刻度数，超过时按此值处理
+        CHUNK_SIZE = 1024       // 每次向系统申请的节点数
+    };
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_dwNow 时间轮的当前刻度
+     */
+    timer_wheel(DWORD v_dwNow = 0) : m_dwNext(v_dwNow + 1), m_nCount(0), m_pFree(NULL)
+    {
+        for (int i = 0; i < LEVELS; ++i)
+        {
+            for (int j = 0; j < SLOTS; ++j)
+            {
+                m_slots[i][j].m_pPrev = &m_slots[i][j];
+                m_slots[i][j].m_pNext = &m_slots[i][j];
+            }
+        }
+    }
+    virtual ~timer_wheel()
+    {
+        for (size_t i = 0; i < m_vecChunks.size(); ++i)
+        {
+            delete[] m_vecChunks[i];
+        }
+    }
+
+public:
+    /**
+     * @brief 添加定时器
+     * @param [in] v_dwTicks 从当前刻度起多少个刻度后到期，0表示下一次推进时到期
+     * @param [in] v_task 到期执行的任务
+     * @param [in] v_dwPeriod 周期，单位刻度，0表示只执行一次；周期定时器按上次的到期刻度累加，不累积误差
+     * @return timer_handle 定时器句柄，用于取消
+     */
+    timer_handle add(DWORD v_dwTicks, const task_func &v_task, DWORD v_dwPeriod = 0)
+    {
+        timer_node *pNode = allocate();
+        pNode->m_dwExpire = now() + (v_dwTicks < MAX_TICKS ? v_dwTicks : static_cast<DWORD>(MAX_TICKS));
+        pNode->m_dwPeriod = v_dwPeriod < MAX_TICKS ? v_dwPeriod : static_cast<DWORD>(MAX_TICKS);
+        pNode->m_task = v_task;
+        link(pNode);
+        ++m_nCount;
+        return timer_handle(pNode, pNode->m_dwSeq);
+    }
+
+    /**
+     * @brief 取消定时器
+     * @return BOOL 是否取消成功，定时器已执行完、已取消或句柄无效时返回FALSE
+     */
+    BOOL cancel(const timer_handle &v_handle)
+    {
+        timer_node *pNode = v_handle.m_pNode;
+        if (!pNode || pNode->m_dwSeq != v_handle.m_dwSeq)
+        {
+            return FALSE;
+        }
+
+        unlink(pNode);
+        release(pNode);
+        --m_nCount;
+        return TRUE;
+    }
+
+    /**
+     * @brief 推进时间轮到刻度v_dwNow，到期的任务按到期顺序追加到v_vecExpired
+     * @param [in] v_dwNow 目标刻度，不晚于当前刻度时不推进
+     * @param [out] v_vecExpired 到期的任务
+     * @return size_t 到期的任务数
+     */
+    size_t advance(DWORD v_dwNow, std::vector<task_func> &v_vecExpired)
+    {
+        if (m_nCount == 0)
+        {
+            // 没有定时器时时间轮没有状态，直接跳到目标刻度
+            if (static_cast<LONG>(v_dwNow - m_dwNext) >= 0)
+            {
+                m_dwNext = v_dwNow + 1;
+            }
+            return 0;
+        }
+
+        size_t nExpired = 0;
+        while (static_cast<LONG>(v_dwNow - m_dwNext) >= 0)
+        {
+            DWORD dwIndex = m_dwNext & SLOT_MASK;
+            for (int nLevel = 1; dwIndex == 0 && nLevel < LEVELS; ++nLevel)
+            {
+                // 下层转完一圈，把本层当前槽位的定时器重新分配到下层，本层也转完一圈时继续级联上一层
+                DWORD dwSlot = (m_dwNext >> (SLOT_BITS * nLevel)) & SLOT_MASK;
+                cascade(m_slots[nLevel][dwSlot]);
+                if (dwSlot != 0)
+                {
+                    break;
+                }
+            }
+            ++m_dwNext;
+
+            timer_link *pLink = detach(m_slots[0][dwIndex]);
+            while (pLink)
+            {
+                timer_node *pNode = static_cast<timer_node *>(pLink);
+                pLink = pLink->m_pNext;
+
+                v_vecExpired.push_back(pNode->m_task);
+                ++nExpired;
+                if (pNode->m_dwPeriod > 0)
+                {
+                    pNode->m_dwExpire += pNode->m_dwPeriod;
+                    link(pNode);
+                }
+                else
+                {
+                    release(pNode);
+                    --m_nCount;
+                }
+            }
+
+            if (m_nCount == 0)
+            {
+                m_dwNext = v_dwNow + 1;
+                break;
+            }
+        }
+        return nExpired;
+    }
+
+    /**
+     * @brief 距下一个需要推进的刻度的刻度数
+     * @details 在第0层查找下一个非空槽位，最多查到第0层转完一圈，那时需要级联，因此最多检查SLOTS个槽位
+     * @return DWORD 刻度数，至少为1；没有定时器时返回INFINITE
+     */
+    DWORD next_ticks() const
+    {
+        if (m_nCount == 0)
+        {
+            return INFINITE;
+        }
+
+        DWORD dwTick = m_dwNext;
+        for (;;)
+        {
+            const timer_link &head = m_slots[0][dwTick & SLOT_MASK];
+            if ((dwTick & SLOT_MASK) == 0 || head.m_pNext != &head)
+            {
+                return dwTick - m_dwNext + 1;
+            }
+            ++dwTick;
+        }
+    }
+
+    /**
+     * @brief 当前刻度，即最近一次推进到的刻度
+     */
+    DWORD now() const { return m_dwNext - 1; }
+
+    /**
+     * @brief 定时器个数
+     */
+    size_t size() const { return m_nCount; }
+    BOOL empty() const { return m_nCount == 0; }
+
+    /**
+     * @brief 已向系统申请的节点数，即同时存在的定时器数的峰值向上取整到CHUNK_SIZE
+     */
+    size_t capacity() const { return m_vecChunks.size() * CHUNK_SIZE; }
+
+private:
+    /**
+     * @brief 按到期刻度把节点放入对应层的槽位，已到期的放入下一个要推进的槽位
+     */
+    void link(timer_node *v_pNode)
+    {
+        DWORD dwExpire = v_pNode->m_dwExpire;
+        DWORD dwDelta = dwExpire - m_dwNext;
+        if (static_cast<LONG>(dwDelta) < 0)
+        {
+            dwExpire = m_dwNext;
+            dwDelta = 0;
+        }
+
+        int nLevel = 0;
+        while (nLevel < LEVELS - 1 && dwDelta >= (static_cast<DWORD>(1) << (SLOT_BITS * (nLevel + 1))))
+        {
+            ++nLevel;
+        }
+
+        timer_link &head = m_slots[nLevel][(dwExpire >> (SLOT_BITS * nLevel)) & SLOT_MASK];
+        v_pNode->m_pPrev = head.m_pPrev;
+        v_pNode->m_pNext = &head;
+        head.m_pPrev->m_pNext = v_pNode;
+        head.m_pPrev = v_pNode;
+    }
+
+    static void unlink(timer_link *v_pLink)
+    {
+        v_pLink->m_pPrev->m_pNext = v_pLink->m_pNext;
+        v_pLink->m_pNext->m_pPrev = v_pLink->m_pPrev;
+    }
+
+    /**
+     * @brief 取出槽位的整个链表，槽位置空
+     * @return timer_link* 第一个节点，链表以NULL结尾
+     */
+    static timer_link *detach(timer_link &v_head)
+    {
+        if (v_head.m_pNext == &v_head)
+        {
+            return NULL;
+        }
+
+        timer_link *pFirst = v_head.m_pNext;
+        v_head.m_pPrev->m_pNext = NULL;
+        v_head.m_pPrev = &v_head;
+        v_head.m_pNext = &v_head;
+        return pFirst;
+    }
+
+    /**
+     * @brief 把槽位中的定时器按剩余刻度重新分配
+     */
+    void cascade(timer_link &v_head)
+    {
+        timer_link *pLink = detach(v_head);
+        while (pLink)
+        {
+            timer_node *pNode = static_cast<timer_node *>(pLink);
+            pLink = pLink->m_pNext;
+            link(pNode);
+        }
+    }
+
+    timer_node *allocate()
+    {
+        if (!m_pFree)
+        {
+            timer_node *pChunk = new timer_node[CHUNK_SIZE];
+            m_vecChunks.push_back(pChunk);
+            for (size_t i = 0; i < CHUNK_SIZE; ++i)
+            {
+                pChunk[i].m_dwSeq = 0;
+                pChunk[i].m_pNext = m_pFree;
+                m_pFree = &pChunk[i];
+            }
+        }
+
+        timer_node *pNode = static_cast<timer_node *>(m_pFree);
+        m_pFree = pNode->m_pNext;
+        return pNode;
+    }
+
+    void release(timer_node *v_pNode)
+    {
+        ++v_pNode->m_dwSeq;
+        v_pNode->m_task = task_func();
+        v_pNode->m_pNext = m_pFree;
+        m_pFree = v_pNode;
+    }
+
+private:
+    timer_wheel(const timer_wheel &);
+    timer_wheel &operator=(const timer_wheel &);
+
+private:
+    timer_link m_slots[LEVELS][SLOTS];     // 各层的槽位
+    DWORD m_dwNext;                        // 下一个要推进的刻度
+    size_t m_nCount;                       // 定时器个数
+    timer_link *m_pFree;                   // 空闲节点链表
+    std::vector<timer_node *> m_vecChunks; // 向系统申请的节点块
+};
+
+/**
+ * @brief 定时器服务
+ * @details 一个后台线程推进时间轮，到期的任务提交到线程池执行，不为每个定时器占用线程；
+ *          后台线程只在下一个非空槽位到期（或第0层转完一圈需要级联）时醒来，没有定时器时一直等待
+ * @note 到期时刻按tick_count()计算，延迟额外加上一个tick_count()的精度，补偿调用时已经过去的不足一个单位的时间，
+ *       保证不早于预定时刻；推迟不超过一个刻度加两个tick_count()的精度，windows下精度约为10~16毫秒
+ * @note 线程池的任务队列有容量限制且已满时，后台线程阻塞在提交上，之后到期的定时器会推迟
+ */
+class timer_service
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_pool 执行到期任务的线程池，需比定时器服务存活得更久
+     * @param [in] v_dwTickMs 时间轮一个刻度的毫秒数
+     */
+    timer_service(thread_pool &v_pool, DWORD v_dwTickMs = 1)
+        : m_pool(v_pool), m_dwTickMs(v_dwTickMs ? v_dwTickMs : 1), m_dwClockMs(clock_resolution()),
+          m_dwLastMs(tick_count()), m_bStop(FALSE), m_bWaitForever(TRUE), m_dwWakeMs(0)
+    {
+        m_thread.m_pService = this;
+        m_thread.start();
+    }
+    virtual ~timer_service() { stop(); }
+
+public:
+    /**
+     * @brief v_dwDelayMs毫秒后执行任务
+     */
+    timer_handle schedule_after(DWORD v_dwDelayMs, const task_func &v_task) { return add(v_dwDelayMs, v_task, 0); }
+
+    /**
+     * @brief 在tick_count()到达v_dwTickCount时执行任务，已过去的时刻立即执行
+     */
+    timer_handle schedule_at(DWORD v_dwTickCount, const task_func &v_task)
+    {
+        LONG nDelay = static_cast<LONG>(v_dwTickCount - tick_count());
+        return add(nDelay > 0 ? static_cast<DWORD>(nDelay) : 0, v_task, 0);
+    }
+
+    /**
+     * @brief 每隔v_dwPeriodMs毫秒执行一次任务，直到被取消
+     * @note 周期按刻度累加，不因任务执行和调度延迟累积误差；上一次执行还未结束时，下一次照常提交
+     * @param [in] v_dwPeriodMs 周期，单位毫秒，不足一个刻度按一个刻度
+     * @param [in] v_task 任务
+     * @param [in] v_dwDelayMs 第一次执行的延迟，INFINITE表示与周期相同
+     */
+    timer_handle schedule_every(DWORD v_dwPeriodMs, const task_func &v_task, DWORD v_dwDelayMs = INFINITE)
+    {
+        DWORD dwPeriod = (v_dwPeriodMs + m_dwTickMs - 1) / m_dwTickMs;
+        return add(v_dwDelayMs == INFINITE ? v_dwPeriodMs : v_dwDelayMs, v_task, dwPeriod ? dwPeriod : 1);
+    }
+
+    /**
+     * @brief 取消定时器，O(1)
+     * @note 已提交到线程池的任务不会被撤回，取消周期定时器后可能还有一次执行正在进行
+     * @return BOOL 是否取消成功，定时器已执行完或已取消时返回FALSE
+     */
+    BOOL cancel(const timer_handle &v_handle)
+    {
+        unique_lock<mutex> lock(m_mutex);
+        return m_wheel.cancel(v_handle);
+    }
+
+    /**
+     * @brief 未到期的定时器个数
+     */
+    size_t size()
+    {
+        unique_lock<mutex> lock(m_mutex);
+        return m_wheel.size();
+    }
+
+    /**
+     * @brief 停止后台线程，未到期的定时器不再执行
+     */
+    void stop()
+    {
+        {
+            unique_lock<mutex> lock(m_mutex);
+            m_bStop = TRUE;
+            m_cv.notify_one();
+        }
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    DWORD tick_ms() const { return m_dwTickMs; }
+
+private:
+    struct service_thread : public thread
+    {
+        service_thread() : thread(TRUE), m_pService(NULL) {}
+        void run() { m_pService->run(); }
+
+        timer_service *m_pService;
+    };
+
+    /**
+     * @brief tick_count()的精度，单位毫秒
+     */
+    static DWORD clock_resolution()
+    {
+#if defined(_WIN32)
+        DWORD dwAdjustment = 0;
+        DWORD dwIncrement = 0; // 时钟中断间隔，单位100纳秒
+        BOOL bDisabled = FALSE;
+        if (::GetSystemTimeAdjustment(&dwAdjustment, &dwIncrement, &bDisabled) && dwIncrement > 0)
+        {
+            return (dwIncrement + 9999) / 10000;
+        }
+        return 16;
+#else
+        return 1;
+#endif
+    }
+
+    /**
+     * @brief 添加定时器，到期时刻早于后台线程的醒来时刻时唤醒后台线程
+     */
+    timer_handle add(DWORD v_dwDelayMs, const task_func &v_task, DWORD v_dwPeriod)
+    {
+        unique_lock<mutex> lock(m_mutex);
+
+        // 时间轮的当前刻度对应m_dwLastMs，后台线程等待期间不推进时间轮，延迟从m_dwLastMs起算，向上取整；
+        // tick_count()读数之后可能已经过去了将近一个精度单位，非0的延迟加上一个单位，不会提前触发
+        DWORD dwNow = tick_count();
+        DWORD dwDelayMs = dwNow - m_dwLastMs + v_dwDelayMs + (v_dwDelayMs ? m_dwClockMs : 0);
+        if (dwDelayMs < v_dwDelayMs)
+        {
+            dwDelayMs = INFINITE; // 溢出
+        }
+        DWORD dwTicks = dwDelayMs / m_dwTickMs + (dwDelayMs % m_dwTickMs ? 1 : 0);
+        timer_handle handle = m_wheel.add(dwTicks, v_task, v_dwPeriod);
+
+        DWORD dwExpireMs = m_dwLastMs + dwTicks * m_dwTickMs;
+        if (m_bWaitForever || static_cast<LONG>(dwExpireMs - m_dwWakeMs) < 0)
+        {
+            m_bWaitForever = FALSE;
+            m_dwWakeMs = dwExpireMs;
+            m_cv.notify_one();
+        }
+        return handle;
+    }
+
+    void run()
+    {
+        std::vector<task_func> vecExpired;
+        unique_lock<mutex> lock(m_mutex);
+        while (!m_bStop)
+        {
+            DWORD dwTicks = (tick_count() - m_dwLastMs) / m_dwTickMs;
+            if (dwTicks > 0)
+            {
+                m_dwLastMs += dwTicks * m_dwTickMs;
+                m_wheel.advance(m_wheel.now() + dwTicks, vecExpired);
+            }
+
+            if (!vecExpired.empty())
+            {
+                // 解锁后提交，线程池队列满时不阻塞定时器的添加和取消
+                lock.unlock();
+                for (size_t i = 0; i < vecExpired.size(); ++i)
+                {
+                    m_pool.submit(vecExpired[i]);
+                }
+                vecExpired.clear();
+                lock.lock();
+                continue;
+            }
+
+            DWORD dwNextTicks = m_wheel.next_ticks();
+            if (dwNextTicks == INFINITE)
+            {
+                m_bWaitForever = TRUE;
+                m_cv.wait(lock);
+                continue;
+            }
+
+            m_bWaitForever = FALSE;
+            m_dwWakeMs = m_dwLastMs + dwNextTicks * m_dwTickMs;
+            LONG nRemain = static_cast<LONG>(m_dwWakeMs - tick_count());
+            if (nRemain > 0)
+            {
+                m_cv.wait_for(lock, static_cast<DWORD>(nRemain));
+            }
+        }
+    }
+
+private:
+    timer_service(const timer_service &);
+    timer_service &operator=(const timer_service &);
+
+private:
+    thread_pool &m_pool;     // 执行到期任务的线程池
+    DWORD m_dwTickMs;        // 一个刻度的毫秒数
+    DWORD m_dwClockMs;       // tick_count()的精度，单位毫秒
+    DWORD m_dwLastMs;        // 时间轮当前刻度对应的tick_count()
+    timer_wheel m_wheel;     // 时间轮，受m_mutex保护
+    BOOL m_bStop;            // 是否停止
+    BOOL m_bWaitForever;     // 后台线程是否在无限等待
+    DWORD m_dwWakeMs;        // 后台线程预定醒来的tick_count()
+    mutex m_mutex;           // 保护时间轮和以上状态
+    condition_variable m_cv; // 唤醒后台线程
+    service_thread m_thread; // 后台线程
+};
+
+#endif // TIMER_WHEEL_HPP
\ No newline at end of file
@@ -0,0 +1,333 @@
+﻿/**
+ * @file topology.hpp
+ * @brief CPU集合与NUMA拓扑，用于线程绑核和按NUMA节点分组
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef TOPOLOGY_HPP
+#define TOPOLOGY_HPP
+
+#include <vector>
+
+#include "platform.hpp"
+
+#if !defined(_WIN32)
+#include <sched.h>
+#include <stdio.h>
+#endif
+
+/**
+ * @brief CPU集合，按逻辑处理器编号记录
+ */
+class cpu_set
+{
+public:
+    cpu_set() {}
+
+public:
+    void set(size_t v_nCpu)
+    {
+        if (v_nCpu / 32 >= m_vecBits.size())
+        {
+            m_vecBits.resize(v_nCpu / 32 + 1, 0);
+        }
+        m_vecBits[v_nCpu / 32] |= 1U << (v_nCpu % 32);
+    }
+    void reset(size_t v_nCpu)
+    {
+        if (v_nCpu / 32 < m_vecBits.size())
+        {
+            m_vecBits[v_nCpu / 32] &= ~(1U << (v_nCpu % 32));
+        }
+    }
+    BOOL test(size_t v_nCpu) const
+    {
+        return v_nCpu / 32 < m_vecBits.size() && (m_vecBits[v_nCpu / 32] & (1U << (v_nCpu % 32))) != 0;
+    }
+    void clear() { m_vecBits.clear(); }
+
+    /**
+     * @brief 集合中的CPU个数
+     */
+    size_t count() const
+    {
+        size_t nCount = 0;
+        for (size_t i = 0; i < m_vecBits.size(); ++i)
+        {
+            for (UINT32 uiBits = m_vecBits[i]; uiBits; uiBits &= uiBits - 1)
+            {
+                ++nCount;
+            }
+        }
+        return nCount;
+    }
+    BOOL empty() const { return count() == 0; }
+
+    /**
+     * @brief 可能包含的最大CPU编号加1，用于遍历
+     */
+    size_t size() const { return m_vecBits.size() * 32; }
+
+    /**
+     * @brief 按编号从小到大的第v_nIndex个CPU
+     * @param [in] v_nIndex 序号，超过集合大小时取模
+     * @return size_t CPU编号，集合为空时返回0
+     */
+    size_t nth(size_t v_nIndex) const
+    {
+        size_t nCount = count();
+        if (nCount == 0)
+        {
+            return 0;
+        }
+
+        v_nIndex %= nCount;
+        for (size_t nCpu = 0; nCpu < size(); ++nCpu)
+        {
+            if (test(nCpu) && v_nIndex-- == 0)
+            {
+                return nCpu;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 交集
+     */
+    cpu_set operator&(const cpu_set &v_other) const
+    {
+        cpu_set result;
+        for (size_t nCpu = 0; nCpu < size(); ++nCpu)
+        {
+            if (test(nCpu) && v_other.test(nCpu))
+            {
+                result.set(nCpu);
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief 解析linux的CPU列表格式，如"0-3,8-11"
+     * @param [in] v_pszList CPU列表
+     * @return cpu_set 解析结果，格式错误的部分被忽略
+     */
+    static cpu_set parse(const char *v_pszList)
+    {
+        cpu_set result;
+        const char *p = v_pszList;
+        while (p && *p)
+        {
+            if (*p < '0' || *p > '9')
+            {
+                ++p;
+                continue;
+            }
+
+            size_t nFirst = parse_number(p);
+            size_t nLast = nFirst;
+            if (*p == '-')
+            {
+                ++p;
+                nLast = parse_number(p);
+            }
+            for (size_t nCpu = nFirst; nCpu <= nLast; ++nCpu)
+            {
+                result.set(nCpu);
+            }
+        }
+        return result;
+    }
+
+private:
+    static size_t parse_number(const char *&v_p)
+    {
+        size_t nValue = 0;
+        while (*v_p >= '0' && *v_p <= '9')
+        {
+            nValue = nValue * 10 + (*v_p++ - '0');
+        }
+        return nValue;
+    }
+
+private:
+    std::vector<UINT32> m_vecBits; // 每位对应一个CPU
+};
+
+/**
+ * @brief NUMA拓扑，构造时读取一次
+ * @details linux下读取/sys/devices/system/node，并与当前进程允许运行的CPU取交集；
+ *          windows下使用GetNumaNodeProcessorMask()，只支持第一个处理器组（64个逻辑处理器）；
+ *          读取失败或非NUMA机器视为一个节点，包含全部CPU
+ * @note 节点按系统编号从小到大重新编号为0~node_count()-1，不含CPU的节点被忽略
+ */
+class numa_topology
+{
+public:
+    numa_topology() { load(); }
+
+public:
+    size_t node_count() const { return m_vecNodes.size(); }
+
+    /**
+     * @brief 节点包含的CPU
+     */
+    const cpu_set &node_cpus(size_t v_nNode) const { return m_vecNodes[v_nNode % m_vecNodes.size()]; }
+
+    /**
+     * @brief 所有节点的CPU
+     */
+    const cpu_set &all_cpus() const { return m_all; }
+
+    /**
+     * @brief CPU所属的节点，未知CPU返回0
+     */
+    size_t node_of_cpu(size_t v_nCpu) const
+    {
+        for (size_t i = 0; i < m_vecNodes.size(); ++i)
+        {
+            if (m_vecNodes[i].test(v_nCpu))
+            {
+                return i;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief 调用线程当前所在的节点，线程未绑核时随时可能迁移，结果只作为参考
+     */
+    size_t current_node() const { return node_of_cpu(current_cpu()); }
+
+    /**
+     * @brief 调用线程当前所在的CPU，无法获取时返回0
+     */
+    static size_t current_cpu()
+    {
+#if defined(_WIN32)
+        // GetCurrentProcessorNumber()从Vista开始提供，动态获取以兼容XP系统
+        typedef DWORD(WINAPI * get_processor_func)();
+        static get_processor_func s_func = reinterpret_cast<get_processor_func>(
+            ::GetProcAddress(::GetModuleHandleA("kernel32.dll"), "GetCurrentProcessorNumber"));
+        return s_func ? s_func() : 0;
+#else
+        int iCpu = ::sched_getcpu();
+        return iCpu < 0 ? 0 : static_cast<size_t>(iCpu);
+#endif
+    }
+
+private:
+    void load()
+    {
+#if defined(_WIN32)
+        ULONG ulHighest = 0;
+        if (::GetNumaHighestNodeNumber(&ulHighest))
+        {
+            for (ULONG i = 0; i <= ulHighest; ++i)
+            {
+                ULONGLONG ullMask = 0;
+                if (!::GetNumaNodeProcessorMask(static_cast<UCHAR>(i), &ullMask))
+                {
+                    continue;
+                }
+
+                cpu_set cpus;
+                for (size_t nCpu = 0; nCpu < 64; ++nCpu)
+                {
+                    if (ullMask & (1ULL << nCpu))
+                    {
+                        cpus.set(nCpu);
+                    }
+                }
+                add_node(cpus);
+            }
+        }
+#else
+        cpu_set allowed;
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (0 == ::sched_getaffinity(0, sizeof(mask), &mask))
+        {
+            for (size_t nCpu = 0; nCpu < CPU_SETSIZE; ++nCpu)
+            {
+                if (CPU_ISSET(nCpu, &mask))
+                {
+                    allowed.set(nCpu);
+                }
+            }
+        }
+
+        cpu_set nodes = read_list("/sys/devices/system/node/online");
+        for (size_t nNode = 0; nNode < nodes.size(); ++nNode)
+        {
+            if (nodes.test(nNode))
+            {
+                char szPath[64];
+                ::snprintf(szPath, sizeof(szPath), "/sys/devices/system/node/node%u/cpulist",
+                           static_cast<unsigned int>(nNode));
+                add_node(allowed.empty() ? read_list(szPath) : read_list(szPath) & allowed);
+            }
+        }
+        if (m_vecNodes.empty())
+        {
+            add_node(allowed);
+        }
+#endif
+
+        if (m_vecNodes.empty())
+        {
+            cpu_set cpus;
+            for (DWORD i = 0; i < processor_count(); ++i)
+            {
+                cpus.set(i);
+            }
+            add_node(cpus);
+        }
+    }
+
+    void add_node(const cpu_set &v_cpus)
+    {
+        if (v_cpus.empty())
+        {
+            return;
+        }
+
+        m_vecNodes.push_back(v_cpus);
+        for (size_t nCpu = 0; nCpu < v_cpus.size(); ++nCpu)
+        {
+            if (v_cpus.test(nCpu))
+            {
+                m_all.set(nCpu);
+            }
+        }
+    }
+
+#if !defined(_WIN32)
+    /**
+     * @brief 读取sysfs中的CPU/节点列表文件，读取失败返回空集合
+     */
+    static cpu_set read_list(const char *v_pszPath)
+    {
+        char szLine[4096] = {0};
+        FILE *pFile = ::fopen(v_pszPath, "r");
+        if (!pFile)
+        {
+            return cpu_set();
+        }
+        if (!::fgets(szLine, sizeof(szLine), pFile))
+        {
+            szLine[0] = '\0';
+        }
+        ::fclose(pFile);
+        return cpu_set::parse(szLine);
+    }
+#endif
+
+private:
+    std::vector<cpu_set> m_vecNodes; // 每个节点的CPU
+    cpu_set m_all;                   // 所有节点的CPU
+};
+
+#endif // TOPOLOGY_HPP
\ No newline at end of file
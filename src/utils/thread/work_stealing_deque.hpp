@@ -0,0 +1,201 @@
+﻿/**
+ * @file work_stealing_deque.hpp
+ * @brief Chase-Lev 工作窃取双端队列
+ * @author zhengw
+ * @date 2026-10-17
+ */
+
+#ifndef WORK_STEALING_DEQUE_HPP
+#define WORK_STEALING_DEQUE_HPP
+
+#include <vector>
+
+#include "atomic.hpp"
+
+/**
+ * @brief 工作窃取双端队列
+ * @details 所属线程在底部push/pop（后进先出，缓存友好），其他线程从顶部steal（先进先出）；
+ *          所属线程的push/pop无锁且通常无原子读改写，只有队列剩最后一个元素时才与窃取者竞争
+ * @note push/pop只能由所属线程调用，steal可由任意线程调用
+ * @note 下标为LONG，只比较差值，溢出回绕后仍然正确
+ * @tparam T 元素类型，需可平凡复制（指针或POD）：steal()在抢占顶部之前复制元素，扩容后旧数组中也留有副本，
+ *           复制时所属线程可能正在覆盖同一槽位，复制和析构带副作用的类型会出错
+ */
+template <typename T> class work_stealing_deque
+{
+    /**
+     * @brief 环形数组，容量为2的幂
+     */
+    struct ring_array
+    {
+        explicit ring_array(size_t v_nCapacity) : m_nMask(v_nCapacity - 1), m_pItems(new T[v_nCapacity]) {}
+        ~ring_array() { delete[] m_pItems; }
+
+        size_t capacity() const { return m_nMask + 1; }
+        T &at(LONG v_nIndex) const { return m_pItems[static_cast<size_t>(v_nIndex) & m_nMask]; }
+
+        size_t m_nMask;
+        T *m_pItems;
+    };
+    typedef std::vector<ring_array*> ring_arrays;
+
+public:
+    /**
+     * @brief 构造函数
+     * @param [in] v_nCapacity 初始容量，会向上取整为2的幂，满时自动扩容
+     */
+    work_stealing_deque(size_t v_nCapacity = 256) : m_nTop(0), m_nBottom(0)
+    {
+        size_t nCapacity = 2;
+        while (nCapacity < v_nCapacity)
+        {
+            nCapacity <<= 1;
+        }
+
+        ring_array *pArray = new ring_array(nCapacity);
+        m_vecArrays.push_back(pArray);
+        m_pArray = pArray;
+    }
+    virtual ~work_stealing_deque()
+    {
+        for (typename ring_arrays::iterator it = m_vecArrays.begin(); it != m_vecArrays.end(); ++it)
+        {
+            delete *it;
+        }
+    }
+
+public:
+    /**
+     * @brief 向底部添加元素，仅所属线程调用
+     * @param [in] v_tItem 元素
+     */
+    void push(const T &v_tItem)
+    {
+        LONG nBottom = m_nBottom;
+        LONG nTop = m_nTop;
+        ring_array *pArray = m_pArray;
+        if (static_cast<size_t>(distance(nTop, nBottom)) >= pArray->capacity())
+        {
+            pArray = grow(pArray, nTop, nBottom);
+        }
+
+        pArray->at(nBottom) = v_tItem;
+        m_nBottom = advance(nBottom, 1); // 原子交换带完整屏障，保证元素先于下标对窃取者可见
+    }
+
+    /**
+     * @brief 从底部取出元素，仅所属线程调用
+     * @param [out] v_tItem 元素
+     * @return BOOL 是否成功取出
+     */
+    BOOL pop(T &v_tItem)
+    {
+        LONG nBottom = advance(m_nBottom, -1);
+        m_nBottom = nBottom; // 完整屏障，先占住底部再读取顶部
+
+        LONG nTop = m_nTop;
+        LONG nSize = distance(nTop, nBottom);
+        if (nSize < 0)
+        {
+            m_nBottom = advance(nBottom, 1); // 已空，恢复底部
+            return FALSE;
+        }
+
+        v_tItem = m_pArray->at(nBottom);
+        if (nSize > 0)
+        {
+            return TRUE;
+        }
+
+        // 只剩最后一个元素，与窃取者竞争顶部
+        BOOL bRet = m_nTop.compare_exchange_strong(nTop, advance(nTop, 1));
+        m_nBottom = advance(nBottom, 1);
+        return bRet;
+    }
+
+    /**
+     * @brief 从顶部窃取元素，任意线程调用
+     * @param [out] v_tItem 元素
+     * @return BOOL 是否成功窃取，队列为空或与其他线程竞争失败时返回FALSE
+     */
+    BOOL steal(T &v_tItem)
+    {
+        LONG nTop = m_nTop;
+        memory_barrier();
+        LONG nBottom = m_nBottom;
+        memory_barrier();
+
+        if (distance(nTop, nBottom) <= 0)
+        {
+            return FALSE;
+        }
+
+        // 先复制元素再抢占顶部，抢占失败则丢弃复制的值；复制可能与所属线程的覆盖并发，因此T须可平凡复制
+        T tItem = m_pArray->at(nTop);
+        if (!m_nTop.compare_exchange_strong(nTop, advance(nTop, 1)))
+        {
+            return FALSE;
+        }
+
+        v_tItem = tItem;
+        return TRUE;
+    }
+
+public:
+    /**
+     * @brief 元素个数，并发修改时只是近似值
+     */
+    size_t size() const
+    {
+        LONG nSize = distance(m_nTop, m_nBottom);
+        return nSize > 0 ? static_cast<size_t>(nSize) : 0;
+    }
+    BOOL empty() const { return size() == 0; }
+
+private:
+    /**
+     * @brief 下标前进v_nStep，按无符号运算，溢出时回绕
+     */
+    static LONG advance(LONG v_nIndex, LONG v_nStep)
+    {
+        return static_cast<LONG>(static_cast<DWORD>(v_nIndex) + static_cast<DWORD>(v_nStep));
+    }
+
+    /**
+     * @brief 两个下标的差值v_nTo - v_nFrom，按无符号运算，溢出回绕后仍然正确
+     */
+    static LONG distance(LONG v_nFrom, LONG v_nTo)
+    {
+        return static_cast<LONG>(static_cast<DWORD>(v_nTo) - static_cast<DWORD>(v_nFrom));
+    }
+
+    /**
+     * @brief 扩容为原来的两倍，旧数组保留到析构，避免正在窃取的线程访问已释放的内存
+     * @note 仅所属线程在push中调用
+     */
+    ring_array *grow(ring_array *v_pOld, LONG v_nTop, LONG v_nBottom)
+    {
+        ring_array *pNew = new ring_array(v_pOld->capacity() * 2);
+        for (LONG i = v_nTop; i != v_nBottom; i = advance(i, 1))
+        {
+            pNew->at(i) = v_pOld->at(i);
+        }
+
+        m_vecArrays.push_back(pNew);
+        memory_barrier();
+        m_pArray = pNew;
+        return pNew;
+    }
+
+private:
+    work_stealing_deque(const work_stealing_deque &);
+    work_stealing_deque &operator=(const work_stealing_deque &);
+
+private:
+    atomic<LONG> m_nTop;           // 顶部下标，窃取者与所属线程竞争
+    atomic<LONG> m_nBottom;        // 底部下标，只有所属线程修改
+    ring_array *volatile m_pArray; // 当前环形数组
+    ring_arrays m_vecArrays;       // 所有分配过的数组，析构时释放
+};
+
+#endif // WORK_STEALING_DEQUE_HPP
\ No newline at end of file
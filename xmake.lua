@@ -8,6 +8,10 @@ add_defines("UNICODE","_UNICODE")
 add_linkdirs("links/sqlite3")
 add_links("sqlite3")
 
+if is_plat("linux") then
+    add_syslinks("pthread")
+end
+
 target("example1")
     set_kind("binary")
     add_files("example/1/*.cpp")
@@ -24,6 +28,133 @@ target("example3")
     add_files("src/**/*.cpp")
     add_files("example/3/*.cpp")
 
+-- futex互斥量/条件变量与pthread的对比测试，仅linux
+if is_plat("linux") then
+target("example4")
+    set_kind("binary")
+    add_files("example/4/*.cpp")
+end
+
+-- 线程池共享队列与工作窃取模式的对比测试
+target("example5")
+    set_kind("binary")
+    add_files("example/5/*.cpp")
+
+-- 无锁环形队列与message_queue的对比测试
+target("example6")
+    set_kind("binary")
+    add_files("example/6/*.cpp")
+
+-- 线程池批量提交/批量取任务测试
+target("example7")
+    set_kind("binary")
+    add_files("example/7/*.cpp")
+
+-- future/async测试
+target("example8")
+    set_kind("binary")
+    add_files("example/8/*.cpp")
+
+-- 弹性线程池测试
+target("example9")
+    set_kind("binary")
+    add_files("example/9/*.cpp")
+
+-- NUMA分组线程池测试
+target("example10")
+    set_kind("binary")
+    add_files("example/10/*.cpp")
+
+-- 原子类型各内存序测试
+target("example11")
+    set_kind("binary")
+    add_files("example/11/*.cpp")
+
+-- 缓存行填充与分片计数器测试
+target("example12")
+    set_kind("binary")
+    add_files("example/12/*.cpp")
+
+-- 各种锁的争用测试
+target("example13")
+    set_kind("binary")
+    add_files("example/13/*.cpp")
+
+-- 共享互斥量读者扩展性测试
+target("example14")
+    set_kind("binary")
+    add_files("example/14/*.cpp")
+
+-- 共享互斥量公平策略、可升级锁和限时加锁测试
+target("example15")
+    set_kind("binary")
+    add_files("example/15/*.cpp")
+
+-- 顺序锁与共享互斥量读性能对比
+target("example16")
+    set_kind("binary")
+    add_files("example/16/*.cpp")
+
+-- 基于纪元的内存回收压力测试
+target("example17")
+    set_kind("binary")
+    add_files("example/17/*.cpp")
+
+-- 风险指针、无锁栈和无锁队列测试
+target("example18")
+    set_kind("binary")
+    add_files("example/18/*.cpp")
+
+-- 条件变量唤醒延迟和上下文切换测试
+target("example19")
+    set_kind("binary")
+    add_files("example/19/*.cpp")
+
+-- 信号量、门闩和屏障测试
+target("example20")
+    set_kind("binary")
+    add_files("example/20/*.cpp")
+
+-- 单生产者单消费者队列测试
+target("example21")
+    set_kind("binary")
+    add_files("example/21/*.cpp")
+
+-- 侵入式多生产者单消费者队列和信箱测试
+target("example22")
+    set_kind("binary")
+    add_files("example/22/*.cpp")
+
+-- 消息队列批量读写测试
+target("example23")
+    set_kind("binary")
+    add_files("example/23/*.cpp")
+
+-- 线程池多级优先级测试
+target("example24")
+    set_kind("binary")
+    add_files("example/24/*.cpp")
+
+-- 分层时间轮定时器测试
+target("example25")
+    set_kind("binary")
+    add_files("example/25/*.cpp")
+
+-- 任务依赖图测试
+target("example26")
+    set_kind("binary")
+    add_files("example/26/*.cpp")
+
+-- 数据并行算法测试
+target("example27")
+    set_kind("binary")
+    add_files("example/27/*.cpp")
+
+-- 小对象优化任务的内存分配测试
+target("example28")
+    set_kind("binary")
+    add_files("example/28/*.cpp")
+
 
 --
 -- If you want to known more usage about xmake, please see https://xmake.io